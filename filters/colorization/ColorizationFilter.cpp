@@ -200,12 +200,37 @@ void ColorizationFilter::ready(PointTableRef table)
 
 bool ColorizationFilter::processOne(PointRef& point)
 {
-    static std::vector<double> data;
+    return colorize(point, *m_raster, m_data);
+}
+
 
+Filter::PointStatePtr ColorizationFilter::makePointState()
+{
+    std::unique_ptr<RasterState> state(new RasterState);
+    state->m_raster.reset(new gdal::Raster(m_rasterFilename));
+    // Errors have already been reported when the filter's raster was
+    // opened in ready().
+    state->m_raster->open();
+    return PointStatePtr(state.release());
+}
+
+
+bool ColorizationFilter::filterPoint(PointRef& point, PointState *state)
+{
+    if (!state)
+        return colorize(point, *m_raster, m_data);
+    RasterState *rs = static_cast<RasterState *>(state);
+    return colorize(point, *rs->m_raster, rs->m_data);
+}
+
+
+bool ColorizationFilter::colorize(PointRef& point, gdal::Raster& raster,
+    std::vector<double>& data)
+{
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
+    if (raster.read(x, y, data) == gdal::GDALError::None)
     { 
         int i(0);
         for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
@@ -221,12 +246,7 @@ bool ColorizationFilter::processOne(PointRef& point)
 
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
-    {
-        point.setPointId(idx);
-        processOne(point);
-    }
+    filterPoints(view);
 }
 
 } // namespace pdal
@@ -87,13 +87,27 @@ private:
     virtual void processOptions(const Options&);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual PointStatePtr makePointState();
+    virtual bool filterPoint(PointRef& point, PointState *state);
+    bool colorize(PointRef& point, gdal::Raster& raster,
+        std::vector<double>& data);
+
+    // Each thread reads from its own raster handle.
+    struct RasterState : public PointState
+    {
+        std::unique_ptr<gdal::Raster> m_raster;
+        std::vector<double> m_data;
+    };
 
     std::string m_rasterFilename;
     std::vector<BandInfo> m_bands;
 
     std::unique_ptr<gdal::Raster> m_raster;
+    std::vector<double> m_data;
 
     ColorizationFilter& operator=(const ColorizationFilter&); // not implemented
     ColorizationFilter(const ColorizationFilter&); // not implemented
@@ -0,0 +1,79 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (hobu@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "CompactFilter.hpp"
+
+namespace pdal
+{
+
+static PluginInfo const s_info = PluginInfo(
+    "filters.compact",
+    "Free storage of points that are no longer in use.",
+    "http://pdal.io/stages/filters.compact.html" );
+
+CREATE_STATIC_PLUGIN(1, 0, CompactFilter, Filter, s_info)
+
+std::string CompactFilter::getName() const { return s_info.name; }
+
+Options CompactFilter::getDefaultOptions()
+{
+    Options options;
+    options.add("threshold", 1.0, "Compact if the fraction of points "
+        "in use is less than this");
+    return options;
+}
+
+
+void CompactFilter::processOptions(const Options& options)
+{
+    m_threshold = options.getValueOrDefault<double>("threshold", 1.0);
+    if (m_threshold < 0 || m_threshold > 1)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": 'threshold' option must be between 0 and 1.";
+        throw pdal_error(oss.str());
+    }
+}
+
+
+// All views that will be run through the filter exist when ready() is
+// called, so this is where the table is compacted.
+void CompactFilter::ready(PointTableRef table)
+{
+    if (table.compact(m_threshold))
+        log()->get(LogLevel::Debug) << getName() <<
+            ": compacted point table.\n";
+}
+
+} // namespace pdal
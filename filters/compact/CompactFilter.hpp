@@ -0,0 +1,76 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (hobu@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <pdal/Filter.hpp>
+
+extern "C" int32_t CompactFilter_ExitFunc();
+extern "C" PF_ExitFunc CompactFilter_InitPlugin();
+
+namespace pdal
+{
+
+// Repacks the points of the point table that are still in use, so that
+// storage for points dropped by earlier filters is freed and later stages
+// see their points contiguously.
+class PDAL_DLL CompactFilter : public Filter
+{
+public:
+    CompactFilter()
+        {}
+
+    static void * create();
+    static int32_t destroy(void *);
+    std::string getName() const;
+    Options getDefaultOptions();
+
+private:
+    double m_threshold;
+
+    virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
+    virtual bool processOne(PointRef& /*point*/)
+        { return true; }
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
+
+    CompactFilter& operator=(const CompactFilter&); // not implemented
+    CompactFilter(const CompactFilter&); // not implemented
+};
+
+} // namespace pdal
@@ -155,6 +155,22 @@ bool CropFilter::processOne(PointRef& point)
 }
 
 
+// Points must pass every polygon and box, as in processOne().  Each test
+// only looks at points that passed the previous tests.
+bool CropFilter::processBatch(PointRange& range, SelectionVector& sel)
+{
+    for (auto& geom : m_geoms)
+        range.retain(sel, [this, &geom](PointRef& point)
+            { return crop(point, geom); });
+
+    for (auto& box : m_bounds)
+        range.retain(sel, [this, &box](PointRef& point)
+            { return crop(point, box); });
+
+    return true;
+}
+
+
 PointViewSet CropFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
@@ -204,13 +220,15 @@ bool CropFilter::crop(PointRef& point, const BOX2D& box)
 
 void CropFilter::crop(const BOX2D& box, PointView& input, PointView& output)
 {
+    std::vector<PointId> ids;
     PointRef point = input.point(0);
     for (PointId idx = 0; idx < input.size(); ++idx)
     {
         point.setPointId(idx);
         if (crop(point, box))
-            output.appendPoint(input, idx);
+            ids.push_back(idx);
     }
+    output.appendPoints(input, ids);
 }
 
 bool CropFilter::crop(PointRef& point, const GeomPkg& g)
@@ -222,6 +240,7 @@ bool CropFilter::crop(PointRef& point, const GeomPkg& g)
 
 void CropFilter::crop(const GeomPkg& g, PointView& input, PointView& output)
 {
+    std::vector<PointId> ids;
     PointRef point = input.point(0);
     for (PointId idx = 0; idx < input.size(); ++idx)
     {
@@ -229,8 +248,9 @@ void CropFilter::crop(const GeomPkg& g, PointView& input, PointView& output)
         bool covers = g.m_geom.covers(point);
         bool keep = (m_cropOutside != covers);
         if (keep)
-            output.appendPoint(input, idx);
+            ids.push_back(idx);
     }
+    output.appendPoints(input, ids);
 }
 
 
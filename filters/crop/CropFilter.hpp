@@ -76,7 +76,13 @@ private:
 
     virtual void processOptions(const Options& options);
     virtual void ready(PointTableRef table);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual bool processBatch(PointRange& range, SelectionVector& sel);
     virtual PointViewSet run(PointViewPtr view);
     bool crop(PointRef& point, const BOX2D& box);
     void crop(const BOX2D& box, PointView& input, PointView& output);
@@ -60,9 +60,7 @@ void DecimationFilter::processOptions(const Options& options)
 PointViewSet DecimationFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
-    PointViewPtr outView = inView->makeNew();
-    decimate(*inView.get(), *outView.get());
-    viewSet.insert(outView);
+    viewSet.insert(decimate(*inView.get()));
     return viewSet;
 }
 
@@ -79,11 +77,19 @@ bool DecimationFilter::processOne(PointRef& point)
 }
 
 
-void DecimationFilter::decimate(PointView& input, PointView& output)
+// Without a step, the output is just a slice of the input.
+PointViewPtr DecimationFilter::decimate(PointView& input)
 {
     PointId last_idx = std::min(m_limit, input.size());
-    for (PointId idx = m_offset; idx < last_idx; idx += m_step)
-        output.appendPoint(input, idx);
+    PointId first_idx = std::min((PointId)m_offset, last_idx);
+    if (m_step == 1)
+        return input.slice(first_idx, last_idx);
+
+    std::vector<PointId> ids;
+    ids.reserve((last_idx - first_idx + m_step - 1) / m_step);
+    for (PointId idx = first_idx; idx < last_idx; idx += m_step)
+        ids.push_back(idx);
+    return input.select(ids);
 }
 
 } // pdal
@@ -62,9 +62,16 @@ private:
     virtual void processOptions(const Options& options);
     void ready(PointTableRef table)
         { m_index = 0; }
+    virtual bool streamable() const
+        { return true; }
     bool processOne(PointRef& point);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
     PointViewSet run(PointViewPtr view);
-    void decimate(PointView& input, PointView& output);
+    virtual bool supportsConcurrentRun() const
+        { return true; }
+    PointViewPtr decimate(PointView& input);
 
     DecimationFilter& operator=(const DecimationFilter&); // not implemented
     DecimationFilter(const DecimationFilter&); // not implemented
@@ -135,12 +135,7 @@ bool FerryFilter::processOne(PointRef& point)
 
 void FerryFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId id = 0; id < view.size(); ++id)
-    {
-        point.setPointId(id);
-        processOne(point);
-    }
+    filterPoints(view);
 }
 
 } // namespace pdal
@@ -56,9 +56,14 @@ private:
     PointViewPtr m_view;
 
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point)
         { return true; }
     virtual PointViewSet run(PointViewPtr in);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
 
     MergeFilter& operator=(const MergeFilter&); // not implemented
     MergeFilter(const MergeFilter&); // not implemented
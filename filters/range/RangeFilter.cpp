@@ -181,6 +181,15 @@ void RangeFilter::prepared(PointTableRef table)
 }
 
 
+bool RangeFilter::usedDims(PointLayoutPtr /*layout*/,
+    Dimension::IdList& dims) const
+{
+    for (auto& r : m_range_list)
+        dims.push_back(r.m_id);
+    return true;
+}
+
+
 // Determine if a point passes a single range.
 bool RangeFilter::dimensionPasses(double v, const Range& r) const
 {
@@ -223,6 +232,32 @@ bool RangeFilter::processOne(PointRef& point)
 }
 
 
+// Same logic as processOne(), but a dimension at a time.  Points that fail
+// the ranges for a dimension are dropped from the selection before the
+// next dimension is checked.
+bool RangeFilter::processBatch(PointRange& range, SelectionVector& sel)
+{
+    auto r = m_range_list.begin();
+    while (r != m_range_list.end() && !sel.empty())
+    {
+        auto dimEnd = r;
+        while (dimEnd != m_range_list.end() && dimEnd->m_id == r->m_id)
+            dimEnd++;
+
+        range.retain(sel, [this, r, dimEnd](PointRef& point)
+        {
+            double v = point.getFieldAs<double>(r->m_id);
+            for (auto ri = r; ri != dimEnd; ++ri)
+                if (dimensionPasses(v, *ri))
+                    return true;
+            return false;
+        });
+        r = dimEnd;
+    }
+    return true;
+}
+
+
 PointViewSet RangeFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
@@ -230,14 +265,7 @@ PointViewSet RangeFilter::run(PointViewPtr inView)
         return viewSet;
 
     PointViewPtr outView = inView->makeNew();
-
-    for (PointId i = 0; i < inView->size(); ++i)
-    {
-        PointRef point = inView->point(i);
-        if (processOne(point))
-            outView->appendPoint(*inView, i);
-    }
-
+    filterPoints(*inView, outView.get());
     viewSet.insert(outView);
     return viewSet;
 }
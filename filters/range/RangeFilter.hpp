@@ -92,8 +92,17 @@ private:
 
     virtual void processOptions(const Options&options);
     virtual void prepared(PointTableRef table);
+    virtual bool usedDims(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual bool processBatch(PointRange& range, SelectionVector& sel);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool filterPoint(PointRef& point, PointState * /*state*/)
+        { return processOne(point); }
+    virtual bool supportsConcurrentRun() const
+        { return true; }
     bool dimensionPasses(double v, const Range& r) const;
 
     RangeFilter& operator=(const RangeFilter&); // not implemented
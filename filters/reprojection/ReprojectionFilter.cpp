@@ -54,6 +54,18 @@ CREATE_STATIC_PLUGIN(1, 0, ReprojectionFilter, Filter, s_info)
 
 std::string ReprojectionFilter::getName() const { return s_info.name; }
 
+// OGR coordinate transformations can't be shared between threads, so each
+// thread filtering a view gets its own.
+struct ReprojectionFilter::TransformState : public Filter::PointState
+{
+    TransformState(TransformPtr transform) : m_transform(transform)
+    {}
+    ~TransformState()
+        { OCTDestroyCoordinateTransformation(m_transform); }
+
+    TransformPtr m_transform;
+};
+
 ReprojectionFilter::ReprojectionFilter() : m_inferInputSRS(true),
     m_in_ref_ptr(NULL), m_out_ref_ptr(NULL), m_transform_ptr(NULL)
 {}
@@ -128,6 +140,16 @@ void ReprojectionFilter::initialize()
 }
 
 
+// Reprojected coordinates usually can't be represented with the scaling
+// of the source data.
+void ReprojectionFilter::addDimensions(PointLayoutPtr layout)
+{
+    layout->registerDim(Dimension::Id::X, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Y, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Z, Dimension::Type::Double);
+}
+
+
 void ReprojectionFilter::ready(PointTableRef table)
 {
     if (!table.supportsView())
@@ -205,13 +227,7 @@ PointViewSet ReprojectionFilter::run(PointViewPtr view)
 
     createTransform(view->spatialReference());
 
-    PointRef point(*view, 0);
-    for (PointId id = 0; id < view->size(); ++id)
-    {
-        point.setPointId(id);
-        if (processOne(point))
-            outView->appendPoint(*view, id);
-    }
+    filterPoints(*view, outView.get());
 
     viewSet.insert(outView);
     view->setSpatialReference(m_outSRS);
@@ -222,12 +238,42 @@ PointViewSet ReprojectionFilter::run(PointViewPtr view)
 
 
 bool ReprojectionFilter::processOne(PointRef& point)
+{
+    return transformPoint(point, m_transform_ptr);
+}
+
+
+Filter::PointStatePtr ReprojectionFilter::makePointState()
+{
+    TransformPtr transform = OCTNewCoordinateTransformation(m_in_ref_ptr,
+        m_out_ref_ptr);
+    if (!transform)
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Could not construct transformation.";
+        throw pdal_error(oss.str());
+    }
+    return PointStatePtr(new TransformState(transform));
+}
+
+
+bool ReprojectionFilter::filterPoint(PointRef& point, PointState *state)
+{
+    if (!state)
+        return transformPoint(point, m_transform_ptr);
+    return transformPoint(point,
+        static_cast<TransformState *>(state)->m_transform);
+}
+
+
+bool ReprojectionFilter::transformPoint(PointRef& point,
+    TransformPtr transform)
 {
     double x(point.getFieldAs<double>(Dimension::Id::X));
     double y(point.getFieldAs<double>(Dimension::Id::Y));
     double z(point.getFieldAs<double>(Dimension::Id::Z));
 
-    if (OCTTransform(m_transform_ptr, 1, &x, &y, &z))
+    if (OCTTransform(transform, 1, &x, &y, &z))
     {
         point.setField(Dimension::Id::X, x);
         point.setField(Dimension::Id::Y, y);
@@ -62,9 +62,23 @@ public:
 private:
     virtual void processOptions(const Options& options);
     virtual void initialize();
+    virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
+
+    typedef void* ReferencePtr;
+    typedef void* TransformPtr;
+    struct TransformState;
+
+    virtual PointStatePtr makePointState();
+    virtual bool filterPoint(PointRef& point, PointState *state);
+    bool transformPoint(PointRef& point, TransformPtr transform);
 
     void updateBounds();
     void createTransform(const SpatialReference& srs);
@@ -74,8 +88,6 @@ private:
     SpatialReference m_outSRS;
     bool m_inferInputSRS;
 
-    typedef void* ReferencePtr;
-    typedef void* TransformPtr;
     ReferencePtr m_in_ref_ptr;
     ReferencePtr m_out_ref_ptr;
     TransformPtr m_transform_ptr;
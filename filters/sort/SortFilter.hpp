@@ -65,6 +65,13 @@ private:
     virtual void ready(PointTableRef table)
         { m_dim = table.layout()->findDim(m_dimName); }
 
+    virtual bool usedDims(PointLayoutPtr layout,
+            Dimension::IdList& dims) const
+    {
+        dims.push_back(layout->findDim(m_dimName));
+        return true;
+    }
+
     virtual void filter(PointView& view)
     {
         if (m_dim == Dimension::Id::Unknown)
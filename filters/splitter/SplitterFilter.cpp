@@ -97,6 +97,7 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
 
     CoordCompare compare;
     std::map<Coord, PointViewPtr, CoordCompare> viewMap(compare);
+    std::map<Coord, std::vector<PointId>, CoordCompare> idMap(compare);
 
     // Use the location of the first point as the origin, unless specified.
     // (!= test == isnan(), which doesn't exist on windows)
@@ -114,17 +115,22 @@ PointViewSet SplitterFilter::run(PointViewPtr inView)
         double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
         int ypos = (y - m_yOrigin) / m_length;
 
+        // Views are created as cells are found so that their IDs are
+        // ordered as before, but points are added all at once below.
         Coord loc(xpos, ypos);
         PointViewPtr& outView = viewMap[loc];
         if (!outView)
             outView = inView->makeNew();
-        outView->appendPoint(*inView.get(), idx);
+        idMap[loc].push_back(idx);
     }
 
     // Pull the buffers out of the map and stick them in the standard
     // output set, setting the bounds as we go.
     for (auto bi = viewMap.begin(); bi != viewMap.end(); ++bi)
+    {
+        bi->second->appendPoints(*inView.get(), idMap[bi->first]);
         viewSet.insert(bi->second);
+    }
     return viewSet;
 }
 
@@ -61,6 +61,9 @@ private:
 
     virtual void processOptions(const Options& options);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
 
     SplitterFilter& operator=(const SplitterFilter&); // not implemented
     SplitterFilter(const SplitterFilter&); // not implemented
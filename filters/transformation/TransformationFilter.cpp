@@ -37,6 +37,7 @@
 #include <pdal/pdal_export.hpp>
 
 #include <sstream>
+#include <vector>
 
 namespace pdal
 {
@@ -90,6 +91,16 @@ void TransformationFilter::processOptions(const Options& options)
 }
 
 
+// Transformed coordinates don't fit the scaling of the input, so make sure
+// they're stored as doubles.
+void TransformationFilter::addDimensions(PointLayoutPtr layout)
+{
+    layout->registerDim(Dimension::Id::X, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Y, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Z, Dimension::Type::Double);
+}
+
+
 bool TransformationFilter::processOne(PointRef& point)
 {
     double x = point.getFieldAs<double>(Dimension::Id::X);
@@ -110,11 +121,40 @@ bool TransformationFilter::processOne(PointRef& point)
 
 void TransformationFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    filterPoints(view);
+}
+
+
+void TransformationFilter::filterRange(PointView& view, PointId begin,
+    PointId end, PointState * /*state*/, char * /*keep*/)
+{
+    const point_count_t chunk(4096);
+    std::vector<double> x(chunk);
+    std::vector<double> y(chunk);
+    std::vector<double> z(chunk);
+    std::vector<double> out(chunk);
+
+    for (PointId idx = begin; idx < end; idx += chunk)
     {
-        point.setPointId(idx);
-        processOne(point);
+        point_count_t cnt = (std::min)(chunk, end - idx);
+        view.getFieldArray(Dimension::Id::X, idx, cnt, x.data());
+        view.getFieldArray(Dimension::Id::Y, idx, cnt, y.data());
+        view.getFieldArray(Dimension::Id::Z, idx, cnt, z.data());
+
+        for (point_count_t i = 0; i < cnt; ++i)
+            out[i] = x[i] * m_matrix[0] + y[i] * m_matrix[1] +
+                z[i] * m_matrix[2] + m_matrix[3];
+        view.setFieldArray(Dimension::Id::X, idx, cnt, out.data());
+
+        for (point_count_t i = 0; i < cnt; ++i)
+            out[i] = x[i] * m_matrix[4] + y[i] * m_matrix[5] +
+                z[i] * m_matrix[6] + m_matrix[7];
+        view.setFieldArray(Dimension::Id::Y, idx, cnt, out.data());
+
+        for (point_count_t i = 0; i < cnt; ++i)
+            out[i] = x[i] * m_matrix[8] + y[i] * m_matrix[9] +
+                z[i] * m_matrix[10] + m_matrix[11];
+        view.setFieldArray(Dimension::Id::Z, idx, cnt, out.data());
     }
 }
 
@@ -68,8 +68,16 @@ private:
     TransformationFilter& operator=(const TransformationFilter&); // not implemented
     TransformationFilter(const TransformationFilter&); // not implemented
     virtual void processOptions(const Options& options);
+    virtual void addDimensions(PointLayoutPtr layout);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
     virtual void filter(PointView& view);
+    virtual void filterRange(PointView& view, PointId begin, PointId end,
+        PointState *state, char *keep);
 
     TransformationMatrix m_matrix;
 };
@@ -0,0 +1,110 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+
+namespace pdal
+{
+
+/// A process-wide pool of memory blocks used for point storage.  Blocks
+/// released by a point table are kept and handed to the next table that
+/// needs a block of the same size, so programs that create and destroy
+/// many tables don't repeatedly allocate and fault in fresh memory.
+///
+/// Blocks held for reuse stay allocated after every table is gone, up to
+/// the pool's capacity (16MB by default).  Programs that create many large
+/// tables can raise it with setCapacity(); programs embedding PDAL that
+/// want the memory back can lower it or call clear().
+class PDAL_DLL BlockPool
+{
+public:
+    /// The pool shared by all point tables.
+    static BlockPool& instance();
+
+    /// Get a block.
+    /// \param size  Size of the block in bytes.
+    /// \param zero  Whether the block must be zero-filled.  Newly allocated
+    ///   blocks are always zero-filled.  Recycled blocks are only cleared
+    ///   if requested.
+    /// \return  Pointer to the block.
+    char *allocate(std::size_t size, bool zero = true);
+
+    /// Return a block to the pool.  If the pool already holds its capacity,
+    /// the block is freed.
+    /// \param block  Block to return.
+    /// \param size  Size of the block, as passed to allocate().
+    void release(char *block, std::size_t size);
+
+    /// Set the maximum number of bytes held in the pool for reuse.  Blocks
+    /// held beyond the new capacity are freed.
+    void setCapacity(std::size_t capacity);
+    std::size_t capacity() const;
+
+    /// Request that new blocks be backed by huge pages where the platform
+    /// supports it.  This reduces TLB misses and page faults when touching
+    /// large tables.
+    void setHugePages(bool hugePages)
+        { m_hugePages = hugePages; }
+    bool hugePages() const
+        { return m_hugePages; }
+
+    /// Free all blocks held for reuse.
+    void clear();
+
+private:
+    BlockPool();
+
+    char *create(std::size_t size);
+    void destroy(char *block, std::size_t size);
+
+    mutable std::mutex m_mutex;
+    std::map<std::size_t, std::vector<char *>> m_free;
+    std::size_t m_held;
+    std::size_t m_capacity;
+    std::atomic<bool> m_hugePages;
+
+    BlockPool(const BlockPool&); // not implemented
+    BlockPool& operator=(const BlockPool&); // not implemented
+};
+
+} // namespace pdal
@@ -48,9 +48,15 @@
 #endif
 
 #include <pdal/Dimension.hpp>
+#include <pdal/StageStats.hpp>
+#include <pdal/util/IStream.hpp>
 #include <pdal/util/OStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <vector>
 
 namespace pdal
@@ -206,6 +212,49 @@ private:
     bool m_done;
 };
 
+/// Write the chunk table that follows LAZ point data at the current
+/// position of the stream and store the table's position in the eight
+/// bytes reserved for it at the start of the point data.
+///
+/// \param stream  Output stream.
+/// \param offsetPos  Position of the space reserved for the table offset.
+/// \param chunkSizes  Compressed size of each chunk, in file order.
+inline void writeLazChunkTable(std::ostream& stream, std::streampos offsetPos,
+    const std::vector<uint32_t>& chunkSizes)
+{
+    typedef laszip::io::__ofstream_wrapper<std::ostream> OutputStream;
+    typedef laszip::encoders::arithmetic<OutputStream> Encoder;
+
+    // Save our current position.  Go to the location where we need
+    // to write the chunk table offset at the beginning of the point data.
+    std::streampos chunkTablePos = stream.tellp();
+    stream.seekp(offsetPos);
+    OLeStream out(&stream);
+    out << (uint64_t)chunkTablePos;
+
+    // Move to the start of the chunk table.
+    stream.seekp(chunkTablePos);
+
+    // Write the chunk table header.
+    out << (uint32_t)0;  // Version (?)
+    out << (uint32_t)chunkSizes.size();
+
+    // Encode and write the chunk table.
+    OutputStream outputStream(stream);
+    Encoder encoder(outputStream);
+    laszip::compressors::integer compressor(32, 2);
+    compressor.init();
+
+    uint32_t predictor = 0;
+    for (uint32_t offset : chunkSizes)
+    {
+        offset = htole32(offset);
+        compressor.compress(encoder, predictor, offset, 1);
+        predictor = offset;
+    }
+    encoder.done();
+}
+
 class LazPerfVlrCompressor
 {
     typedef laszip::io::__ofstream_wrapper<std::ostream> OutputStream;
@@ -257,35 +306,7 @@ public:
         m_encoder.reset();
 
         newChunk();
-
-        // Save our current position.  Go to the location where we need
-        // to write the chunk table offset at the beginning of the point data.
-        std::streampos chunkTablePos = m_stream.tellp();
-        m_stream.seekp(m_chunkInfoPos);
-        OLeStream out(&m_stream);
-        out << (uint64_t)chunkTablePos;
-
-        // Move to the start of the chunk table.
-        m_stream.seekp(chunkTablePos);
-
-        // Write the chunk table header.
-        out << (uint32_t)0;  // Version (?)
-        out << (uint32_t)m_chunkTable.size();
-
-        // Encode and write the chunk table.
-        OutputStream outputStream(m_stream);
-        Encoder encoder(outputStream);
-        laszip::compressors::integer compressor(32, 2);
-        compressor.init();
-
-        uint32_t predictor = 0;
-        for (uint32_t offset : m_chunkTable)
-        {
-            offset = htole32(offset);
-            compressor.compress(encoder, predictor, offset, 1);
-            predictor = offset;
-        }
-        encoder.done();
+        writeLazChunkTable(m_stream, m_chunkInfoPos, m_chunkTable);
     }
 
 private:
@@ -402,10 +423,375 @@ private:
     uint32_t m_chunkPointsRead;
 };
 
+// Position and size of one chunk of compressed points in a LAZ file.
+struct LazChunk
+{
+    std::streamoff offset;
+    uint32_t size;
+    point_count_t count;
+};
+
+/// Read the chunk table of LAZ point data written with fixed-size chunks.
+/// The table holds the compressed size of each chunk, encoded the same way
+/// as it's written by LazPerfVlrCompressor::done().
+///
+/// \param stream  Stream containing the LAZ data.
+/// \param pointOffset  Position of the start of the point data.
+/// \param chunkSize  Number of points in each chunk.
+/// \param numPoints  Number of points in the file.
+/// \return  The chunks in file order, or an empty list if the file has no
+///   usable chunk table.
+inline std::vector<LazChunk> readLazChunkTable(std::istream& stream,
+    std::streamoff pointOffset, uint32_t chunkSize, point_count_t numPoints)
+{
+    typedef laszip::io::__ifstream_wrapper<std::istream> InputStream;
+    typedef laszip::decoders::arithmetic<InputStream> Decoder;
+
+    std::vector<LazChunk> chunks;
+    if (chunkSize == 0 || numPoints == 0)
+        return chunks;
+
+    ILeStream in(&stream);
+    int64_t tableOffset;
+    stream.seekg(pointOffset);
+    in >> tableOffset;
+    // Writers that can't seek back put the offset at the end of the file.
+    if (tableOffset == -1)
+    {
+        stream.seekg(-(std::streamoff)sizeof(int64_t), std::ios::end);
+        in >> tableOffset;
+    }
+    if (!stream || tableOffset <= pointOffset)
+        return chunks;
+
+    uint32_t version;
+    uint32_t numChunks;
+    stream.seekg(tableOffset);
+    in >> version >> numChunks;
+    if (!stream || version != 0 ||
+        numChunks != (numPoints + chunkSize - 1) / chunkSize)
+        return chunks;
+
+    InputStream input(stream);
+    Decoder decoder(input);
+    laszip::decompressors::integer decompressor(32, 2);
+    decompressor.init();
+
+    std::streamoff offset = pointOffset + sizeof(int64_t);
+    point_count_t remaining = numPoints;
+    int32_t predictor = 0;
+    for (uint32_t i = 0; i < numChunks; ++i)
+    {
+        predictor = decompressor.decompress(decoder, predictor, 1);
+        LazChunk chunk;
+        chunk.offset = offset;
+        chunk.size = (uint32_t)predictor;
+        chunk.count = (std::min)((point_count_t)chunkSize, remaining);
+        offset += chunk.size;
+        remaining -= chunk.count;
+        chunks.push_back(chunk);
+    }
+    if (offset > tableOffset)
+        chunks.clear();
+    return chunks;
+}
+
+
+/// Decompresses the chunks of LAZ point data on a pool of threads.
+/// Compressed chunks are read from the stream by the caller's thread, at
+/// most 'window' ahead of the chunk being consumed, and are returned in
+/// file order.  If 'stats' isn't NULL, the CPU time of the workers is
+/// added to it.
+class LazPerfChunkDecompressor
+{
+    typedef laszip::decoders::arithmetic<LazPerfBuf> Decoder;
+    typedef laszip::factory::record_schema Schema;
+
+    struct Slot
+    {
+        LazChunk chunk;
+        std::vector<unsigned char> compressed;
+        std::vector<char> points;
+        bool done;
+        std::exception_ptr error;
+    };
+    typedef std::shared_ptr<Slot> SlotPtr;
+
+public:
+    LazPerfChunkDecompressor(std::istream& stream, const char *vlrData,
+        const std::vector<LazChunk>& chunks, size_t threads, size_t window,
+        StageStats *stats = NULL) :
+        m_stream(stream), m_chunks(chunks), m_nextChunk(0),
+        m_window((std::max)(window, (size_t)1)), m_stats(stats),
+        m_pool(threads)
+    {
+        laszip::io::laz_vlr zipvlr(vlrData);
+        m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
+    }
+
+    ~LazPerfChunkDecompressor()
+        { m_pool.await(); }
+
+    size_t pointSize() const
+        { return (size_t)m_schema.size_in_bytes(); }
+
+    /// Return the decompressed points of the next chunk, or NULL when
+    /// all chunks have been returned.  The data is valid until the next
+    /// call.
+    std::vector<char> *next()
+    {
+        fill();
+        if (m_pending.empty())
+            return NULL;
+
+        m_current = m_pending.front();
+        m_pending.pop_front();
+        // Keep the pool busy while the caller works through this chunk.
+        fill();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_current->done; });
+        if (m_current->error)
+            std::rethrow_exception(m_current->error);
+        return &m_current->points;
+    }
+
+private:
+    void fill()
+    {
+        while (m_pending.size() < m_window && m_nextChunk < m_chunks.size())
+        {
+            SlotPtr slot(new Slot);
+            slot->chunk = m_chunks[m_nextChunk++];
+            slot->done = false;
+            // The decoder may look a few bytes past the end of a chunk.
+            slot->compressed.resize(slot->chunk.size + sizeof(uint32_t));
+            m_stream.seekg(slot->chunk.offset);
+            m_stream.read((char *)slot->compressed.data(), slot->chunk.size);
+            if (m_stream.gcount() != (std::streamsize)slot->chunk.size)
+                throw pdal_error("Unexpected end of file reading "
+                    "compressed points.");
+            m_pending.push_back(slot);
+            m_pool.add([this, slot](){ decompress(slot); });
+        }
+    }
+
+    void decompress(SlotPtr slot)
+    {
+        StageStats::Timer timer(m_stats, false, true);
+        try
+        {
+            LazPerfBuf input(slot->compressed);
+            Decoder decoder(input);
+            auto decompressor =
+                laszip::factory::build_decompressor(decoder, m_schema);
+
+            size_t size = pointSize();
+            slot->points.resize(slot->chunk.count * size);
+            char *pos = slot->points.data();
+            for (point_count_t i = 0; i < slot->chunk.count; ++i)
+            {
+                decompressor->decompress(pos);
+                pos += size;
+            }
+        }
+        catch (...)
+        {
+            slot->error = std::current_exception();
+        }
+        std::vector<unsigned char>().swap(slot->compressed);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        slot->done = true;
+        m_cv.notify_all();
+    }
+
+    std::istream& m_stream;
+    Schema m_schema;
+    std::vector<LazChunk> m_chunks;
+    size_t m_nextChunk;
+    size_t m_window;
+    std::deque<SlotPtr> m_pending;
+    SlotPtr m_current;
+    StageStats *m_stats;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    // Last, so that the workers are stopped before anything they use
+    // is destroyed.
+    ThreadPool m_pool;
+};
+
+/// Compresses LAZ point data in fixed-size chunks on a pool of threads.
+/// Chunks are written to the stream in order by the caller's thread, with
+/// at most 'window' chunks being compressed at once, followed by a chunk
+/// table.  The output is the same as that of LazPerfVlrCompressor.  If
+/// 'stats' isn't NULL, the CPU time of the workers is added to it.
+class LazPerfChunkCompressor
+{
+    typedef laszip::encoders::arithmetic<LazPerfBuf> Encoder;
+    typedef laszip::factory::record_schema Schema;
+
+    struct Slot
+    {
+        std::vector<char> points;
+        point_count_t count;
+        std::vector<unsigned char> compressed;
+        bool done;
+        std::exception_ptr error;
+    };
+    typedef std::shared_ptr<Slot> SlotPtr;
+
+public:
+    LazPerfChunkCompressor(std::ostream& stream, const Schema& schema,
+        uint32_t chunksize, size_t threads, size_t window,
+        StageStats *stats = NULL) :
+        m_stream(stream), m_schema(schema),
+        m_chunksize((std::max)(chunksize, (uint32_t)1)), m_started(false),
+        m_chunkInfoPos(0), m_window((std::max)(window, (size_t)1)),
+        m_stats(stats), m_pool(threads)
+    {}
+
+    ~LazPerfChunkCompressor()
+        { m_pool.await(); }
+
+    size_t pointSize() const
+        { return (size_t)m_schema.size_in_bytes(); }
+
+    /// Queue points for compression.
+    /// \param inbuf  Buffer of packed points.
+    /// \param count  Number of points in the buffer.
+    void compress(const char *inbuf, point_count_t count)
+    {
+        start();
+        size_t size = pointSize();
+        while (count)
+        {
+            if (!m_current)
+            {
+                m_current.reset(new Slot);
+                m_current->points.reserve(m_chunksize * size);
+                m_current->count = 0;
+                m_current->done = false;
+            }
+            point_count_t n = (std::min)(count,
+                (point_count_t)(m_chunksize - m_current->count));
+            m_current->points.insert(m_current->points.end(), inbuf,
+                inbuf + n * size);
+            m_current->count += n;
+            inbuf += n * size;
+            count -= n;
+            if (m_current->count == m_chunksize)
+                submit();
+        }
+    }
+
+    /// Compress any partial chunk, write all remaining chunks and the
+    /// chunk table.
+    void done()
+    {
+        start();
+        if (m_current && m_current->count)
+            submit();
+        write(0);
+        writeLazChunkTable(m_stream, m_chunkInfoPos, m_chunkTable);
+    }
+
+private:
+    // Reserve space for the chunk table offset before the first chunk.
+    void start()
+    {
+        if (m_started)
+            return;
+        m_started = true;
+        m_chunkInfoPos = m_stream.tellp();
+        OLeStream out(&m_stream);
+        out << (uint64_t)0;
+    }
+
+    void submit()
+    {
+        SlotPtr slot(m_current);
+        m_current.reset();
+        m_pending.push_back(slot);
+        m_pool.add([this, slot](){ compressChunk(slot); });
+        write(m_window);
+    }
+
+    // Write finished chunks in order, waiting until no more than
+    // 'maxPending' chunks remain unwritten.
+    void write(size_t maxPending)
+    {
+        while (m_pending.size())
+        {
+            SlotPtr slot = m_pending.front();
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_pending.size() > maxPending)
+                    m_cv.wait(lock, [&slot](){ return slot->done; });
+                else if (!slot->done)
+                    break;
+            }
+            m_pending.pop_front();
+            if (slot->error)
+                std::rethrow_exception(slot->error);
+            m_stream.write((const char *)slot->compressed.data(),
+                slot->compressed.size());
+            m_chunkTable.push_back((uint32_t)slot->compressed.size());
+        }
+    }
+
+    void compressChunk(SlotPtr slot)
+    {
+        StageStats::Timer timer(m_stats, false, true);
+        try
+        {
+            LazPerfBuf output(slot->compressed);
+            Encoder encoder(output);
+            auto compressor =
+                laszip::factory::build_compressor(encoder, m_schema);
+
+            size_t size = pointSize();
+            const char *pos = slot->points.data();
+            for (point_count_t i = 0; i < slot->count; ++i)
+            {
+                compressor->compress(pos);
+                pos += size;
+            }
+            encoder.done();
+        }
+        catch (...)
+        {
+            slot->error = std::current_exception();
+        }
+        std::vector<char>().swap(slot->points);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        slot->done = true;
+        m_cv.notify_all();
+    }
+
+    std::ostream& m_stream;
+    Schema m_schema;
+    uint32_t m_chunksize;
+    bool m_started;
+    std::streampos m_chunkInfoPos;
+    size_t m_window;
+    SlotPtr m_current;
+    std::deque<SlotPtr> m_pending;
+    std::vector<uint32_t> m_chunkTable;
+    StageStats *m_stats;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    // Destroyed first, so no worker outlives what it uses.
+    ThreadPool m_pool;
+};
+
 #else
 
 typedef char LazPerfVlrCompressor;
+typedef char LazPerfChunkCompressor;
 typedef char LazPerfVlrDecompressor;
+typedef char LazPerfChunkDecompressor;
 
 #endif  // PDAL_HAVE_LAZPERF
 
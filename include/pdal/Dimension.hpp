@@ -850,7 +850,8 @@ inline Type::Enum type(std::string s)
 class Detail
 {
 public:
-    Detail() : m_id(Id::Unknown), m_offset(-1), m_type(Type::None)
+    Detail() : m_id(Id::Unknown), m_offset(-1), m_type(Type::None),
+        m_scaled(false)
     {}
     //NOTE - This is strange, but for some reason things run faster with
     // this NOOP virtual dtor.  Perhaps it has something to do with
@@ -866,6 +867,18 @@ public:
         { m_type = type; }
     void setId(Id::Enum id)
         { m_id = id; }
+    // A scaled dimension is stored as a 32-bit integer that's converted
+    // with the scale and offset of the transform when accessed.
+    void setXForm(const XForm& xform)
+    {
+        m_xform = xform;
+        m_scaled = true;
+    }
+    void clearXForm()
+    {
+        m_xform = XForm();
+        m_scaled = false;
+    }
     Id::Enum id() const
         { return m_id; }
     int offset() const
@@ -876,11 +889,17 @@ public:
         { return Dimension::size(m_type); }
     BaseType::Enum base() const
         { return Dimension::base(m_type); }
+    bool scaled() const
+        { return m_scaled; }
+    const XForm& xform() const
+        { return m_xform; }
 
 private:
     Id::Enum m_id;
     int m_offset;
     Type::Enum m_type;
+    bool m_scaled;
+    XForm m_xform;
 };
 typedef std::vector<Detail> DetailList;
 
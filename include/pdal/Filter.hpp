@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <pdal/Stage.hpp>
 
 namespace pdal
@@ -50,6 +52,28 @@ public:
     Filter()
         {}
 
+protected:
+    /// Per-thread state used by filterPoint()/filterRange().  Filters
+    /// derive from this to hold objects that can't be shared between
+    /// threads, such as coordinate transformations or raster handles.
+    struct PointState
+    {
+        virtual ~PointState()
+        {}
+    };
+    typedef std::unique_ptr<PointState> PointStatePtr;
+
+    /// Call filterRange() on the points of a view.  If the stage's
+    /// 'threads' option allows and the view is large enough, the view is
+    /// split into ranges that are filtered concurrently, each with its own
+    /// PointState.  When the view isn't split, no state is made and
+    /// filterPoint() is passed NULL.  Filters that call this must only
+    /// modify the point being filtered and the state passed.
+    /// \param view  View to filter.
+    /// \param keep  If not NULL, points for which filterPoint() returns
+    ///   true are appended to this view, in their original order.
+    void filterPoints(PointView& view, PointView *keep = NULL);
+
 private:
     virtual PointViewSet run(PointViewPtr view)
     {
@@ -60,6 +84,16 @@ private:
     }
     virtual void filter(PointView& /*view*/)
     {}
+    virtual PointStatePtr makePointState()
+        { return PointStatePtr(); }
+    virtual bool filterPoint(PointRef& /*point*/, PointState * /*state*/)
+    {
+        std::ostringstream oss;
+        oss << "Point filtering not supported for stage " << getName() << ".";
+        throw pdal_error(oss.str());
+    }
+    virtual void filterRange(PointView& view, PointId begin, PointId end,
+        PointState *state, char *keep);
 
     Filter& operator=(const Filter&); // not implemented
     Filter(const Filter&); // not implemented
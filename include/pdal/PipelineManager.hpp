@@ -48,16 +48,23 @@ class Options;
 class PDAL_DLL PipelineManager
 {
 public:
-    PipelineManager() : m_tablePtr(new PointTable()), m_table(*m_tablePtr),
-            m_progressFd(-1)
+    PipelineManager() : m_tablePtr(new PointTable()),
+            m_table(m_tablePtr.get()), m_progressFd(-1), m_memoryBudget(0),
+            m_streamed(false),
+            m_streamChunk(10000), m_streamDepth(1)
         {}
     PipelineManager(int progressFd) : m_tablePtr(new PointTable()),
-            m_table(*m_tablePtr), m_progressFd(progressFd)
+            m_table(m_tablePtr.get()), m_progressFd(progressFd),
+            m_memoryBudget(0), m_streamed(false),
+            m_streamChunk(10000), m_streamDepth(1)
         {}
-    PipelineManager(PointTableRef table) : m_table(table), m_progressFd(-1)
+    PipelineManager(PointTableRef table) : m_table(&table), m_progressFd(-1),
+            m_memoryBudget(0), m_streamed(false),
+            m_streamChunk(10000), m_streamDepth(1)
         {}
-    PipelineManager(PointTableRef table, int progressFd) : m_table(table),
-            m_progressFd(progressFd)
+    PipelineManager(PointTableRef table, int progressFd) : m_table(&table),
+            m_progressFd(progressFd), m_memoryBudget(0), m_streamed(false),
+            m_streamChunk(10000), m_streamDepth(1)
         {}
 
     bool readPipeline(std::istream& input);
@@ -76,29 +83,93 @@ public:
     Stage* getStage() const
         { return m_stages.empty() ? NULL : m_stages.back().get(); }
 
+    /// Limit the amount of point data that execute() holds in memory.
+    /// If the pipeline ends in a writer and every stage supports
+    /// streaming, points are streamed through the pipeline a chunk at a
+    /// time.  Otherwise, if the manager created its own point table, the
+    /// table is replaced with one that writes point data beyond the budget
+    /// to a scratch file.  Tables passed to the manager are left alone.
+    /// \param bytes  Approximate number of bytes of point data to keep in
+    ///   memory.  0 means no limit.
+    /// \param scratchDir  Directory in which to create the scratch file.
+    ///   If empty, the directory named by TMPDIR, or /tmp, is used.
+    void setMemoryBudget(uint64_t bytes,
+            const std::string& scratchDir = std::string())
+    {
+        m_memoryBudget = bytes;
+        m_scratchDir = scratchDir;
+    }
+    uint64_t memoryBudget() const
+        { return m_memoryBudget; }
+    const std::string& scratchDir() const
+        { return m_scratchDir; }
+
+    /// Store points in a table owned by the caller rather than in one the
+    /// manager creates.  Must be called before prepare() or execute().
+    /// As with a table passed to the constructor, point data isn't moved
+    /// to a scratch file when the memory budget is exceeded.
+    /// \param table  Table in which to store points.
+    void setPointTable(PointTableRef table)
+    {
+        m_tablePtr.reset();
+        m_table = &table;
+    }
+
+    /// Set the shape of the point table used when execute() streams.
+    /// \param chunkSize  Number of points passed through a stage at a
+    ///   time.  0 leaves the current value.  [Default: 10000]
+    /// \param depth  Number of chunks in flight.  With more than one,
+    ///   each stage runs on its own thread, working on a separate chunk,
+    ///   so only ask for that if every stage of the pipeline can be run
+    ///   concurrently with the others.  0 leaves the current value.
+    ///   [Default: 1]
+    void setStreamChunks(point_count_t chunkSize, point_count_t depth)
+    {
+        if (chunkSize)
+            m_streamChunk = chunkSize;
+        if (depth)
+            m_streamDepth = depth;
+    }
+    point_count_t streamChunkSize() const
+        { return m_streamChunk; }
+    point_count_t streamDepth() const
+        { return m_streamDepth; }
+
     void prepare() const;
     point_count_t execute();
 
+    // Whether the last call to execute() streamed the points.  If so,
+    // no point views are available.
+    bool streamed() const
+        { return m_streamed; }
+
     // Get the resulting point views.
     const PointViewSet& views() const
         { return m_viewSet; }
 
     // Get the point table data.
     PointTableRef pointTable() const
-        { return m_table; }
+        { return *m_table; }
 
     MetadataNode getMetadata() const;
 
 private:
     StageFactory m_factory;
-    std::unique_ptr<PointTable> m_tablePtr;
-    PointTableRef m_table;
+    std::unique_ptr<BasePointTable> m_tablePtr;
+    BasePointTable *m_table;
 
     PointViewSet m_viewSet;
 
     typedef std::vector<std::unique_ptr<Stage> > StagePtrList;
     StagePtrList m_stages;
     int m_progressFd;
+    uint64_t m_memoryBudget;
+    std::string m_scratchDir;
+    bool m_streamed;
+    point_count_t m_streamChunk;
+    point_count_t m_streamDepth;
+
+    bool streamable() const;
 
     PipelineManager& operator=(const PipelineManager&); // not implemented
     PipelineManager(const PipelineManager&); // not implemented
@@ -51,6 +51,14 @@ private:
         const void *val) = 0;
     virtual void getFieldInternal(Dimension::Id::Enum dim, PointId idx,
         void *val) const = 0;
+    // Return a pointer to the point-interleaved storage for a point, laid
+    // out as described by the layout, or NULL if there is no such storage.
+    virtual char *getPointData(PointId /*idx*/)
+        { return NULL; }
+    // As getPointData(), but for writing.  A container may add the point
+    // if 'idx' is just past its end.
+    virtual char *getWritablePointData(PointId idx)
+        { return getPointData(idx); }
 public:
     virtual PointLayoutPtr layout() const = 0;
 };
@@ -63,6 +63,13 @@ public:
     // is already larger, this does nothing.
     void registerDim(Dimension::Id::Enum id, Dimension::Type::Enum type);
 
+    // Register a dimension to be stored as a 32-bit integer with the
+    // given scale and offset.  Values are converted when they're set and
+    // fetched, and the dimension reports itself as a double.  If the
+    // dimension is registered in any other way, or with a different
+    // scaling, it's stored as a double instead.
+    void registerScaledDim(Dimension::Id::Enum id, const XForm& xform);
+
     // The type and size are REQUESTS, not absolutes.  If someone else
     // has already registered with the same name, you get the existing
     // dimension size/type.
@@ -74,6 +81,10 @@ public:
             const std::string name,
             Dimension::Type::Enum type);
 
+    // Remove a dimension from the layout and close up the space it used.
+    // Removing a dimension that isn't in the layout does nothing.
+    void removeDim(Dimension::Id::Enum id);
+
     DimTypeList dimTypes() const;
     DimType findDimType(const std::string& name) const;
     Dimension::Id::Enum findDim(const std::string& name) const;
@@ -86,19 +97,28 @@ public:
     // @return reference to vector of currently used dimensions
     const Dimension::IdList& dims() const;
 
-    // @return the current type for a given id
+    // @return the current type for a given id.  Scaled dimensions are
+    //         reported as doubles.
     Dimension::Type::Enum dimType(Dimension::Id::Enum id) const;
 
     // @return the current size in bytes of the dimension
-    //         with the given id.
+    //         with the given id, as reported by dimType().
     size_t dimSize(Dimension::Id::Enum id) const;
     size_t dimOffset(Dimension::Id::Enum id) const;
+
+    // @return the size in bytes of a point as stored in a table.
     size_t pointSize() const;
 
+    // @return the size in bytes of a point packed using dimTypes().  This
+    //         is larger than pointSize() when dimensions are scaled.
+    size_t packedPointSize() const;
+
     const Dimension::Detail *dimDetail(Dimension::Id::Enum id) const;
 
 private:
     virtual bool update(Dimension::Detail dd, const std::string& name);
+    void assignOffsets(Dimension::DetailList& detail);
+    void unscale(Dimension::Detail& dd);
 
     Dimension::Type::Enum resolveType(
             Dimension::Type::Enum t1,
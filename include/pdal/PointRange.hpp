@@ -0,0 +1,103 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <pdal/PointContainer.hpp>
+#include <pdal/PointRef.hpp>
+
+namespace pdal
+{
+
+/// IDs of the points of a PointRange that are still being processed, in
+/// increasing order.  Stages remove the IDs of points that they filter out.
+typedef std::vector<PointId> SelectionVector;
+
+/// A contiguous range of points in a point container that is processed
+/// as a unit when streaming.
+class PDAL_DLL PointRange
+{
+public:
+    PointRange(PointContainer& container, PointId begin, point_count_t size) :
+        m_container(container), m_begin(begin), m_size(size)
+    {}
+
+    PointContainer& container() const
+        { return m_container; }
+    PointLayoutPtr layout() const
+        { return m_container.layout(); }
+    PointId begin() const
+        { return m_begin; }
+    PointId end() const
+        { return m_begin + m_size; }
+    point_count_t size() const
+        { return m_size; }
+    PointRef point(PointId idx) const
+        { return PointRef(m_container, idx); }
+
+    /// Fill a selection vector with the IDs of all points in the range.
+    void selectAll(SelectionVector& sel) const
+    {
+        sel.resize(m_size);
+        for (point_count_t i = 0; i < m_size; ++i)
+            sel[i] = m_begin + i;
+    }
+
+    /// Remove the IDs of points for which 'keep' returns false from a
+    /// selection vector.
+    /// \param sel  Selection vector to update.
+    /// \param keep  Function called with a PointRef for each selected point.
+    template<typename KEEP>
+    void retain(SelectionVector& sel, KEEP keep) const
+    {
+        PointRef point(m_container, 0);
+        size_t out = 0;
+        for (size_t i = 0; i < sel.size(); ++i)
+        {
+            point.setPointId(sel[i]);
+            if (keep(point))
+                sel[out++] = sel[i];
+        }
+        sel.resize(out);
+    }
+
+private:
+    PointContainer& m_container;
+    PointId m_begin;
+    point_count_t m_size;
+};
+
+} // namespace pdal
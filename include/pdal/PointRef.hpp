@@ -38,14 +38,26 @@
 #include <pdal/PointLayout.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <type_traits>
+
 namespace pdal
 {
 
+template<typename T>
+class DimAccessor;
+template<typename T, typename T_STORE>
+class TypedDimAccessor;
+
 class PDAL_DLL PointRef
 {
+    template<typename T>
+    friend class DimAccessor;
+    template<typename T, typename T_STORE>
+    friend class TypedDimAccessor;
 public:
     PointRef(PointContainer& container, PointId idx) :
-        m_container(container), m_layout(*container.layout()), m_idx(idx)
+        m_container(container), m_layout(*container.layout()), m_idx(idx),
+        m_data(NULL), m_dataValid(false), m_dataWritable(false)
     {}
 
     bool hasDim(Dimension::Id::Enum dim) const
@@ -57,7 +69,8 @@ public:
         T val(0);
         bool success = true;
         Everything e;
-        Dimension::Type::Enum type = m_layout.dimDetail(dim)->type();
+        const Dimension::Detail *dd = m_layout.dimDetail(dim);
+        Dimension::Type::Enum type = dd->type();
 
         m_container.getFieldInternal(dim, m_idx, &e);
         switch (type)
@@ -81,7 +94,11 @@ public:
             success = Utils::numericCast(e.s16, val);
             break;
         case Dimension::Type::Signed32:
-            success = Utils::numericCast(e.s32, val);
+            if (dd->scaled())
+                success = Utils::numericCast(
+                    dd->xform().fromScaled(e.s32), val);
+            else
+                success = Utils::numericCast(e.s32, val);
             break;
         case Dimension::Type::Signed64:
             success = Utils::numericCast(e.s64, val);
@@ -111,7 +128,8 @@ public:
     template<typename T>
     void setField(Dimension::Id::Enum dim, T val)
     {
-        Dimension::Type::Enum type = m_layout.dimDetail(dim)->type();
+        const Dimension::Detail *dd = m_layout.dimDetail(dim);
+        Dimension::Type::Enum type = dd->type();
         Everything e;
         bool success = false;
 
@@ -136,7 +154,11 @@ public:
             success = Utils::numericCast(val, e.s16);
             break;
         case Dimension::Type::Signed32:
-            success = Utils::numericCast(val, e.s32);
+            if (dd->scaled())
+                success = Utils::numericCast(
+                    dd->xform().toScaled((double)val), e.s32);
+            else
+                success = Utils::numericCast(val, e.s32);
             break;
         case Dimension::Type::Signed64:
             success = Utils::numericCast(val, e.s64);
@@ -155,7 +177,11 @@ public:
     }
 
     void setPointId(PointId idx)
-        { m_idx = idx; }
+    {
+        m_idx = idx;
+        m_dataValid = false;
+        m_dataWritable = false;
+    }
     inline void getField(char *val, Dimension::Id::Enum d,
         Dimension::Type::Enum type) const;
     inline void setField(Dimension::Id::Enum dim,
@@ -193,6 +219,306 @@ private:
     PointContainer& m_container;
     PointLayout& m_layout;
     PointId m_idx;
+    // Cached pointer to the point's storage, if the container provides it.
+    mutable char *m_data;
+    mutable bool m_dataValid;
+    bool m_dataWritable;
+
+    char *pointData() const
+    {
+        if (!m_dataValid)
+        {
+            m_data = m_container.getPointData(m_idx);
+            m_dataValid = true;
+        }
+        return m_data;
+    }
+
+    // Unlike pointData(), this lets the container add the point if it's
+    // just past the end.
+    char *writablePointData()
+    {
+        if (!m_dataWritable)
+        {
+            m_data = m_container.getWritablePointData(m_idx);
+            m_dataValid = true;
+            m_dataWritable = true;
+        }
+        return m_data;
+    }
+
+    template<typename T>
+    T getRawField(Dimension::Id::Enum dim, int offset) const
+    {
+        T val;
+        const char *pos = pointData();
+        if (pos)
+            memcpy(&val, pos + offset, sizeof(T));
+        else
+            m_container.getFieldInternal(dim, m_idx, &val);
+        return val;
+    }
+
+    template<typename T>
+    void setRawField(Dimension::Id::Enum dim, int offset, T val)
+    {
+        char *pos = writablePointData();
+        if (pos)
+            memcpy(pos + offset, &val, sizeof(T));
+        else
+            m_container.setFieldInternal(dim, m_idx, &val);
+    }
+};
+
+
+/// Provides fast access to a single dimension of points through a PointRef.
+/// The storage offset, type and conversion for the dimension are resolved
+/// when the accessor is bound rather than on each access.  Binding must
+/// happen after the point layout is finalized -- typically in a stage's
+/// ready() function.  Accessing a dimension that isn't in the layout
+/// yields 0 and sets are ignored.
+///
+/// Each access switches on the bound storage type, with every case
+/// inlined.  When the storage type is known where the accessor is used,
+/// TypedDimAccessor avoids even that.
+template<typename T>
+class DimAccessor
+{
+public:
+    DimAccessor() : m_id(Dimension::Id::Unknown),
+        m_type(Dimension::Type::None), m_offset(0), m_scaled(false)
+    {}
+
+    DimAccessor(PointLayoutPtr layout, Dimension::Id::Enum id)
+        { bind(layout, id); }
+
+    void bind(PointLayoutPtr layout, Dimension::Id::Enum id)
+    {
+        const Dimension::Detail *dd = layout->dimDetail(id);
+
+        m_id = id;
+        m_type = dd->type();
+        m_offset = dd->offset();
+        m_scaled = dd->scaled();
+        m_xform = dd->xform();
+    }
+
+    T get(const PointRef& point) const
+    {
+        switch (m_type)
+        {
+        case Dimension::Type::Unsigned8:
+            return getAs<uint8_t>(point);
+        case Dimension::Type::Unsigned16:
+            return getAs<uint16_t>(point);
+        case Dimension::Type::Unsigned32:
+            return getAs<uint32_t>(point);
+        case Dimension::Type::Unsigned64:
+            return getAs<uint64_t>(point);
+        case Dimension::Type::Signed8:
+            return getAs<int8_t>(point);
+        case Dimension::Type::Signed16:
+            return getAs<int16_t>(point);
+        case Dimension::Type::Signed32:
+            return m_scaled ? getScaledAs(point) : getAs<int32_t>(point);
+        case Dimension::Type::Signed64:
+            return getAs<int64_t>(point);
+        case Dimension::Type::Float:
+            return getAs<float>(point);
+        case Dimension::Type::Double:
+            return getAs<double>(point);
+        case Dimension::Type::None:
+            break;
+        }
+        return T(0);
+    }
+
+    void set(PointRef& point, T val) const
+    {
+        switch (m_type)
+        {
+        case Dimension::Type::Unsigned8:
+            setAs<uint8_t>(point, val);
+            break;
+        case Dimension::Type::Unsigned16:
+            setAs<uint16_t>(point, val);
+            break;
+        case Dimension::Type::Unsigned32:
+            setAs<uint32_t>(point, val);
+            break;
+        case Dimension::Type::Unsigned64:
+            setAs<uint64_t>(point, val);
+            break;
+        case Dimension::Type::Signed8:
+            setAs<int8_t>(point, val);
+            break;
+        case Dimension::Type::Signed16:
+            setAs<int16_t>(point, val);
+            break;
+        case Dimension::Type::Signed32:
+            if (m_scaled)
+                setScaledAs(point, val);
+            else
+                setAs<int32_t>(point, val);
+            break;
+        case Dimension::Type::Signed64:
+            setAs<int64_t>(point, val);
+            break;
+        case Dimension::Type::Float:
+            setAs<float>(point, val);
+            break;
+        case Dimension::Type::Double:
+            setAs<double>(point, val);
+            break;
+        case Dimension::Type::None:
+            break;
+        }
+    }
+
+    /// Storage type of the bound dimension, for callers that want to pick
+    /// a TypedDimAccessor outside a loop.
+    Dimension::Type::Enum type() const
+        { return m_type; }
+
+    /// Whether the dimension is stored as a scaled integer with the
+    /// given scale and offset.  If so, the stored integer can be accessed
+    /// directly with getScaled() and setScaled().
+    bool scaledAs(const XForm& xform) const
+        { return m_scaled && m_xform == xform; }
+
+    int32_t getScaled(const PointRef& point) const
+        { return point.getRawField<int32_t>(m_id, m_offset); }
+
+    void setScaled(PointRef& point, int32_t val) const
+        { point.setRawField(m_id, m_offset, val); }
+
+private:
+    Dimension::Id::Enum m_id;
+    Dimension::Type::Enum m_type;
+    int m_offset;
+    bool m_scaled;
+    XForm m_xform;
+
+    template<typename T_STORE>
+    T getAs(const PointRef& point) const
+    {
+        T_STORE s = point.getRawField<T_STORE>(m_id, m_offset);
+        T val(0);
+        if (!Utils::numericCast(s, val))
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch data and convert as requested: ";
+            oss << Dimension::name(m_id) << ":" <<
+                Dimension::interpretationName(m_type) <<
+                "(" << (double)s << ") -> " << Utils::typeidName<T>();
+            throw pdal_error(oss.str());
+        }
+        return val;
+    }
+
+    // As with PointRef::setField(), values that can't be converted
+    // are ignored.
+    template<typename T_STORE>
+    void setAs(PointRef& point, T val) const
+    {
+        T_STORE s;
+        if (Utils::numericCast(val, s))
+            point.setRawField(m_id, m_offset, s);
+    }
+
+    T getScaledAs(const PointRef& point) const
+    {
+        double d = m_xform.fromScaled(getScaled(point));
+        T val(0);
+        if (!Utils::numericCast(d, val))
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch data and convert as requested: ";
+            oss << Dimension::name(m_id) << ":" <<
+                Dimension::interpretationName(Dimension::Type::Double) <<
+                "(" << d << ") -> " << Utils::typeidName<T>();
+            throw pdal_error(oss.str());
+        }
+        return val;
+    }
+
+    void setScaledAs(PointRef& point, T val) const
+    {
+        int32_t s;
+        if (Utils::numericCast(m_xform.toScaled((double)val), s))
+            setScaled(point, s);
+    }
+};
+
+
+/// Like DimAccessor, but with the storage type fixed at compile time, so
+/// that an access is a load or store at the dimension's offset plus a
+/// checked conversion.  Binding throws pdal_error if the dimension isn't stored
+/// as T_STORE.  Scaled dimensions are accessed as their stored integers.
+template<typename T, typename T_STORE>
+class TypedDimAccessor
+{
+public:
+    TypedDimAccessor() : m_id(Dimension::Id::Unknown), m_offset(0)
+    {}
+
+    TypedDimAccessor(PointLayoutPtr layout, Dimension::Id::Enum id)
+        { bind(layout, id); }
+
+    void bind(PointLayoutPtr layout, Dimension::Id::Enum id)
+    {
+        const Dimension::Detail *dd = layout->dimDetail(id);
+        if (dd->type() != storeType())
+        {
+            std::ostringstream oss;
+            oss << "Dimension '" << Dimension::name(id) << "' isn't stored "
+                "as " << Dimension::interpretationName(storeType()) << ".";
+            throw pdal_error(oss.str());
+        }
+        m_id = id;
+        m_offset = dd->offset();
+    }
+
+    /// Get the value of the dimension as T.  Throws pdal_error if the
+    /// value can't be converted, as PointRef::getFieldAs() does.
+    T get(const PointRef& point) const
+    {
+        T_STORE s = point.getRawField<T_STORE>(m_id, m_offset);
+        T val(0);
+        if (!Utils::numericCast(s, val))
+        {
+            std::ostringstream oss;
+            oss << "Unable to fetch data and convert as requested: ";
+            oss << Dimension::name(m_id) << ":" <<
+                Dimension::interpretationName(storeType()) <<
+                "(" << (double)s << ") -> " << Utils::typeidName<T>();
+            throw pdal_error(oss.str());
+        }
+        return val;
+    }
+
+    /// Set the value of the dimension.  As with PointRef::setField(),
+    /// values that can't be converted are ignored.
+    void set(PointRef& point, T val) const
+    {
+        T_STORE s;
+        if (Utils::numericCast(val, s))
+            point.setRawField(m_id, m_offset, s);
+    }
+
+private:
+    Dimension::Id::Enum m_id;
+    int m_offset;
+
+    static Dimension::Type::Enum storeType()
+    {
+        using namespace Dimension;
+
+        int base = std::is_floating_point<T_STORE>::value ?
+            BaseType::Floating : std::is_signed<T_STORE>::value ?
+            BaseType::Signed : BaseType::Unsigned;
+        return Type::Enum(base | sizeof(T_STORE));
+    }
 };
 
 inline void PointRef::getField(char *val, Dimension::Id::Enum d,
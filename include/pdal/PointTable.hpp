@@ -34,7 +34,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "pdal/SpatialReference.hpp"
@@ -46,13 +51,44 @@
 namespace pdal
 {
 
+class PointView;
+
+// Views register themselves so that their table can find them when it's
+// compacted.  Views may outlive their table, so they share ownership of
+// the registry.
+class PointViewRegistry
+{
+public:
+    void add(PointView *view)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_views.insert(view);
+    }
+    void remove(PointView *view)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_views.erase(view);
+    }
+    std::vector<PointView *> views()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return std::vector<PointView *>(m_views.begin(), m_views.end());
+    }
+
+private:
+    std::mutex m_lock;
+    std::set<PointView *> m_views;
+};
+typedef std::shared_ptr<PointViewRegistry> PointViewRegistryPtr;
+
 class PDAL_DLL BasePointTable : public PointContainer
 {
     friend class PointView;
 
 protected:
     BasePointTable(PointLayout& layout) : m_metadata(new Metadata()),
-        m_layoutRef(layout)
+        m_layoutRef(layout), m_pointsInitialized(false),
+        m_viewRegistry(new PointViewRegistry), m_peakMemory(0)
     {}
 
 public:
@@ -92,6 +128,32 @@ public:
     virtual bool supportsView() const
         { return false; }
 
+    /// Indicate whether the stage adding points to the table sets the
+    /// value of every dimension of each point it adds.  If so, the table
+    /// needn't zero the storage of new points.
+    void setPointsInitialized(bool initialized)
+        { m_pointsInitialized = initialized; }
+
+    /// Repack the points referenced by the table's views into new storage
+    /// and free the storage of points that no view references.  Views
+    /// that exist when this is called are updated to refer to the new
+    /// storage.  Pointers to point data and PointRefs are invalidated.
+    /// \param threshold  Only compact if the fraction of the table's
+    ///   points referenced by views is less than this.
+    /// \return  Whether the table was compacted.  Tables that don't
+    ///   support compaction return false.
+    virtual bool compact(double /*threshold*/)
+        { return false; }
+
+    /// Approximate number of bytes of memory used to hold point data.
+    virtual uint64_t memoryUsed() const
+        { return 0; }
+
+    /// Largest number of bytes of memory used to hold point data since the
+    /// table was created, including memory that has since been freed.
+    uint64_t peakMemoryUsed() const
+        { return (std::max)(m_peakMemory, memoryUsed()); }
+
     MetadataNode privateMetadata(const std::string& name);
 
 private:
@@ -101,10 +163,33 @@ private:
 protected:
     virtual char *getPoint(PointId idx) = 0;
 
+    /// Get direct access to the storage for a dimension of a point.
+    /// \param d  Detail of the dimension to access.
+    /// \param idx  Table index of the point.
+    /// \param[out] stride  Distance in bytes between the values of the
+    ///   dimension for consecutive points.
+    /// \param[out] run  Number of points, starting with \a idx, whose values
+    ///   are reachable from the returned pointer by stepping by \a stride.
+    /// \return  Pointer to the dimension's data for the point or NULL if
+    ///   the table doesn't support direct access.
+    virtual char *getDimensionRun(const Dimension::Detail * /*d*/,
+        PointId /*idx*/, size_t& /*stride*/, point_count_t& /*run*/)
+    { return NULL; }
+
+    /// Record the memory in use after allocating storage, for
+    /// peakMemoryUsed().
+    void updatePeakMemory(uint64_t bytes)
+        { m_peakMemory = (std::max)(m_peakMemory, bytes); }
+
 protected:
     MetadataPtr m_metadata;
     std::set<SpatialReference> m_spatialRefs;
     PointLayout& m_layoutRef;
+    bool m_pointsInitialized;
+    PointViewRegistryPtr m_viewRegistry;
+
+private:
+    uint64_t m_peakMemory;
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -125,6 +210,10 @@ private:
         const void *value);
     virtual void getFieldInternal(Dimension::Id::Enum id, PointId idx,
         void *value) const;
+    // Tables that override the field access functions above should
+    // override this to return NULL.
+    virtual char *getPointData(PointId idx)
+        { return getPoint(idx); }
 
     // The number of points in each memory block.
     char *getDimension(const Dimension::Detail *d, PointId idx)
@@ -138,7 +227,8 @@ private:
 };
 
 // This provides a context for processing a set of points and allows the library
-// to be used to process multiple point sets simultaneously.
+// to be used to process multiple point sets simultaneously.  Point storage
+// is drawn from and returned to the BlockPool.
 class PDAL_DLL PointTable : public SimplePointTable
 {
 private:
@@ -146,29 +236,215 @@ private:
     std::vector<char *> m_blocks;
     point_count_t m_numPts;
     static const point_count_t m_blockPtCnt = 65536;
+    // Whether the last block was zeroed when allocated.
+    bool m_blockZeroed;
 
 public:
-    PointTable() : SimplePointTable(m_layout), m_numPts(0)
+    PointTable() : SimplePointTable(m_layout), m_numPts(0),
+        m_blockZeroed(true)
         {}
     virtual ~PointTable();
     virtual bool supportsView() const
         { return true; }
+    virtual bool compact(double threshold);
+    virtual uint64_t memoryUsed() const
+        { return (uint64_t)m_blocks.size() * pointsToBytes(m_blockPtCnt); }
+
+protected:
+    virtual char *getPoint(PointId idx);
+    virtual char *getDimensionRun(const Dimension::Detail *d, PointId idx,
+        size_t& stride, point_count_t& run);
+
+private:
+    // Point data operations.
+    virtual PointId addPoint();
+
+    PointLayout m_layout;
+};
+
+/// A ColumnPointTable stores point data column-wise.  Like PointTable, points
+/// are allocated in blocks of 65536, but within a block the values of each
+/// dimension are stored contiguously rather than interleaved by point.
+/// Operations that touch only a few dimensions of many points (X/Y/Z
+/// filtering, for instance) then only bring the data for those dimensions
+/// into cache.  Since a point's values aren't contiguous, getPoint() returns
+/// a copy of the point laid out as in PointTable.  The copy is overwritten
+/// by the next call and changes made to it aren't stored in the table.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+private:
+    // Point storage.
+    std::vector<char *> m_blocks;
+    point_count_t m_numPts;
+    static const point_count_t m_blockPtCnt = 65536;
+
+public:
+    ColumnPointTable() : BasePointTable(m_layout), m_numPts(0)
+        {}
+    virtual ~ColumnPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    virtual uint64_t memoryUsed() const
+    {
+        return (uint64_t)m_blocks.size() * m_layoutRef.pointSize() *
+            m_blockPtCnt;
+    }
+
+protected:
+    virtual char *getPoint(PointId idx);
+    virtual char *getDimensionRun(const Dimension::Detail *d, PointId idx,
+        size_t& stride, point_count_t& run);
+
+private:
+    // Point data operations.
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id::Enum id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id::Enum id, PointId idx,
+        void *value) const;
+
+    // A dimension's column in a block starts at the dimension's row offset
+    // times the number of points in a block.
+    char *getDimension(const Dimension::Detail *d, PointId idx) const
+    {
+        char *buf = m_blocks[idx / m_blockPtCnt];
+        return buf + (d->offset() * m_blockPtCnt) +
+            (d->size() * (idx % m_blockPtCnt));
+    }
+
+    // Row into which getPoint() gathers a point.
+    std::vector<char> m_row;
+    PointLayout m_layout;
+};
+
+/// A MappedPointTable stores points like PointTable, but its blocks are
+/// memory-mapped from a scratch file rather than allocated on the heap.
+/// Point data can then exceed physical memory, with the operating system
+/// paging blocks to and from the file as needed.  The scratch file is
+/// removed when the table is destroyed.
+class PDAL_DLL MappedPointTable : public SimplePointTable
+{
+public:
+    /// Create a table.
+    /// \param dir  Directory in which to create the scratch file.  If empty,
+    ///   the directory named by TMPDIR, or /tmp, is used.
+    /// \param maxResident  Approximate number of bytes of point data to keep
+    ///   in memory.  When a new block is allocated, blocks allocated before
+    ///   the most recent ones that fit in this size are written to the
+    ///   scratch file and released from memory, including the page cache
+    ///   where the platform allows.  The limit covers points as they're
+    ///   added: blocks that are accessed again later are paged back in and
+    ///   aren't released again.  If 0, paging is left entirely to the
+    ///   operating system.
+    MappedPointTable(const std::string& dir = std::string(),
+        uint64_t maxResident = 0);
+    virtual ~MappedPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    virtual uint64_t memoryUsed() const;
 
 protected:
     virtual char *getPoint(PointId idx);
+    virtual char *getDimensionRun(const Dimension::Detail *d, PointId idx,
+        size_t& stride, point_count_t& run);
 
 private:
     // Point data operations.
     virtual PointId addPoint();
+    void release(size_t blockNum);
 
+    std::vector<char *> m_blocks;
+    point_count_t m_numPts;
+    static const point_count_t m_blockPtCnt = 65536;
+    uint64_t m_maxResident;
+    int m_fd;
     PointLayout m_layout;
 };
 
+#ifdef PDAL_HAVE_LAZPERF
+/// A CompressedPointTable stores points in blocks of 65536 like PointTable,
+/// but only a fixed number of recently used blocks are kept uncompressed.
+/// Other blocks are held in memory compressed with the laz-perf field
+/// compressors and are decompressed when next accessed, evicting the
+/// least recently used block.  This trades CPU time for a smaller memory
+/// footprint when a whole dataset must be held in memory.  Only available
+/// when PDAL is built with laz-perf.
+///
+/// Since blocks move in and out of memory, a pointer returned by getPoint()
+/// (and so by PointView::getPoint()) is only valid until a point in
+/// another block is accessed.
+class PDAL_DLL CompressedPointTable : public SimplePointTable
+{
+public:
+    /// Create a table.
+    /// \param maxResident  Number of blocks to keep uncompressed (minimum 1).
+    CompressedPointTable(point_count_t maxResident = 4);
+    virtual ~CompressedPointTable();
+    virtual bool supportsView() const
+        { return true; }
+    virtual uint64_t memoryUsed() const;
+
+    /// Number of bytes currently used to hold compressed blocks.
+    uint64_t compressedSize() const;
+    /// Number of blocks currently held uncompressed.
+    point_count_t residentBlocks() const;
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    struct Block
+    {
+        Block() : m_data(NULL), m_dirty(false)
+            {}
+
+        char *m_data;
+        std::vector<char> m_compressed;
+        bool m_dirty;
+    };
+
+    // Point data operations.
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id::Enum id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id::Enum id, PointId idx,
+        void *value) const;
+    virtual char *getPointData(PointId /*idx*/)
+        { return NULL; }
+
+    void setDimTypes();
+    uint64_t memoryUsedLocked() const;
+    char *residentBlock(PointId idx);
+    void evict(size_t blockNum);
+    void compress(Block& block);
+    void decompress(Block& block);
+
+    std::vector<Block> m_blocks;
+    // Indexes of uncompressed blocks, most recently used first.
+    std::list<size_t> m_lru;
+    point_count_t m_numPts;
+    point_count_t m_maxResident;
+    static const point_count_t m_blockPtCnt = 65536;
+    // Storage types of the dimensions, in the order they're laid out.
+    DimTypeList m_dimTypes;
+    mutable std::mutex m_lock;
+    PointLayout m_layout;
+};
+#endif  // PDAL_HAVE_LAZPERF
+
 /// A StreamPointTable must provide storage for point data up to its capacity.
 /// It must implement getPoint() which returns a pointer to a buffer of
 /// sufficient size to contain a point's data.  The minimum size required
 /// is constant and can be determined by calling pointsToBytes(1) in the
 /// finalize() method.
+///
+/// If pipelineDepth() is greater than one, the capacity is divided into
+/// that many chunks and the stages of a streamed pipeline run on separate
+/// threads, each working on a different chunk.  In that case reset() isn't
+/// called.  Instead, resetChunk() is called for each chunk once every stage
+/// has processed it, so tables that consume points in reset() must
+/// override resetChunk() as well before returning a depth greater than
+/// one.
 class PDAL_DLL StreamPointTable : public SimplePointTable
 {
 protected:
@@ -188,14 +464,28 @@ public:
     /// the point data will be potentially overwritten.
     virtual void reset()
     {}
+    /// Called when pipelined streaming has finished with the points of a
+    /// chunk, which will be overwritten once the chunk is refilled.
+    /// \param first  Table index of the first point of the chunk.
+    /// \param count  Number of points in the chunk.
+    virtual void resetChunk(PointId /*first*/, point_count_t /*count*/)
+    {}
     virtual point_count_t capacity() const = 0;
+    /// Number of chunks into which the capacity is divided when streaming.
+    virtual point_count_t pipelineDepth() const
+        { return 1; }
 };
 
 class PDAL_DLL FixedPointTable : public StreamPointTable
 {
 public:
-    FixedPointTable(point_count_t capacity) : StreamPointTable(m_layout),
-        m_capacity(capacity)
+    /// Create a table.
+    /// \param chunkSize  Number of points processed by a stage at a time.
+    /// \param depth  Number of chunks of points.  If greater than one,
+    ///   stages run concurrently on separate chunks.
+    FixedPointTable(point_count_t chunkSize, point_count_t depth = 1) :
+        StreamPointTable(m_layout), m_capacity(chunkSize * depth),
+        m_depth(depth)
     {}
 
     virtual void finalize()
@@ -209,6 +499,10 @@ public:
 
     point_count_t capacity() const
         { return m_capacity; }
+    point_count_t pipelineDepth() const
+        { return m_depth; }
+    virtual uint64_t memoryUsed() const
+        { return m_buf.size(); }
 protected:
     virtual char *getPoint(PointId idx)
         { return m_buf.data() + pointsToBytes(idx); }
@@ -216,6 +510,7 @@ protected:
 private:
     std::vector<char> m_buf;
     point_count_t m_capacity;
+    point_count_t m_depth;
     PointLayout m_layout;
 };
 
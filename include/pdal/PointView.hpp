@@ -40,12 +40,12 @@
 #include <pdal/PointLayout.hpp>
 #include <pdal/PointRef.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/PointViewIndex.hpp>
 
 #include <memory>
 #include <queue>
 #include <set>
 #include <vector>
-#include <deque>
 
 #ifdef PDAL_COMPILER_MSVC
 #  pragma warning(disable: 4244)  // conversion from 'type1' to 'type2', possible loss of data
@@ -70,23 +70,27 @@ class PDAL_DLL PointView : public PointContainer
     friend class plang::BufferedInvocation;
     friend class PointIdxRef;
     friend struct PointViewLess;
+    friend class PointTable;
+    friend class Stage;
 public:
     PointView(PointTableRef pointTable) : m_pointTable(pointTable),
-        m_size(0), m_id(0)
-    {
-        static int lastId = 0;
-        m_id = ++lastId;
-    }
+        m_size(0), m_id(nextId()), m_registry(pointTable.m_viewRegistry)
+    { m_registry->add(this); }
 
     PointView(PointTableRef pointTable, const SpatialReference& srs) :
-        m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs)
-    {
-        static int lastId = 0;
-        m_id = ++lastId;
-    }
+        m_pointTable(pointTable), m_size(0), m_id(nextId()),
+        m_spatialReference(srs), m_registry(pointTable.m_viewRegistry)
+    { m_registry->add(this); }
+
+    PointView(const PointView& other) : PointContainer(other),
+        m_pointTable(other.m_pointTable), m_index(other.m_index),
+        m_size(other.m_size), m_id(other.m_id), m_temps(other.m_temps),
+        m_spatialReference(other.m_spatialReference),
+        m_registry(other.m_registry)
+    { m_registry->add(this); }
 
     virtual ~PointView()
-    {}
+    { m_registry->remove(this); }
 
     PointViewIter begin();
     PointViewIter end();
@@ -104,13 +108,30 @@ public:
     void append(const PointView& buf)
     {
         // We use size() instead of the index end because temp points
-        // might have been placed at the end of the buffer.
-        auto thisEnd = m_index.begin() + size();
-        auto bufEnd = buf.m_index.begin() + buf.size();
-        m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
+        // might have been placed at the end of the buffer.  They're
+        // discarded.
+        m_index.truncate(size());
+        m_index.append(buf.m_index, buf.size());
         m_size += buf.size();
         clearTemps();
     }
+    /// Append the points of another view at the positions in \a ids.
+    /// \param buf  View containing the points to append.
+    /// \param ids  Positions in \a buf of the points to append.
+    void appendPoints(const PointView& buf, const std::vector<PointId>& ids)
+    {
+        m_index.truncate(size());
+        m_index.append(buf.m_index, ids);
+        m_size += ids.size();
+        clearTemps();
+    }
+
+    /// Make a view of the points at positions [begin, end) of this view.
+    /// The new view shares this view's index rather than copying it.
+    PointViewPtr slice(PointId begin, PointId end) const;
+
+    /// Make a view of the points at the positions in \a ids.
+    PointViewPtr select(const std::vector<PointId>& ids) const;
 
     /// Return a new point view with the same point table as this
     /// point buffer.
@@ -134,6 +155,29 @@ public:
     inline void setField(Dimension::Id::Enum dim, Dimension::Type::Enum type,
         PointId idx, const void *val);
 
+    /// Fetch the values of a dimension for a range of points, converting
+    /// them to the requested type.  The dimension's type and storage
+    /// location are resolved once for the range rather than once per point.
+    /// \param[in] dim  Dimension to fetch.
+    /// \param[in] first  Index of the first point to fetch.
+    /// \param[in] count  Number of points to fetch.
+    /// \param[out] out  Buffer to receive \a count values.
+    template<typename T>
+    void getFieldArray(Dimension::Id::Enum dim, PointId first,
+        point_count_t count, T *out) const;
+
+    /// Set the values of a dimension for a range of points, converting
+    /// them to the dimension's type.  Points past the end of the view
+    /// are added as with setField().  If a value can't be converted,
+    /// pdal_error is thrown and the points that were added are removed.
+    /// \param[in] dim  Dimension to set.
+    /// \param[in] first  Index of the first point to set.
+    /// \param[in] count  Number of points to set.
+    /// \param[in] in  Buffer containing \a count values.
+    template<typename T>
+    void setFieldArray(Dimension::Id::Enum dim, PointId first,
+        point_count_t count, const T *in);
+
     template <typename T>
     bool compare(Dimension::Id::Enum dim, PointId id1, PointId id2)
     {
@@ -159,6 +203,11 @@ public:
                 return compare<int16_t>(dim, id1, id2);
                 break;
             case Dimension::Type::Signed32:
+                // Scaled values are ordered by value, which is the reverse
+                // of the stored order when the scale is negative.
+                if (dd->scaled())
+                    return getFieldAs<double>(dim, id1) <
+                        getFieldAs<double>(dim, id2);
                 return compare<int32_t>(dim, id1, id2);
                 break;
             case Dimension::Type::Signed64:
@@ -183,9 +232,21 @@ public:
         }
     }
 
+    /// Copy the value of a dimension into a buffer.  The value is
+    /// written as layout()->dimType(dim), so scaled dimensions are
+    /// written as unscaled doubles rather than their stored integers.
+    /// \param[in] dim  Dimension to fetch.
+    /// \param[in] idx  Index of the point.
+    /// \param[out] buf  Buffer of at least layout()->dimSize(dim) bytes.
     void getRawField(Dimension::Id::Enum dim, PointId idx, void *buf) const
     {
-        getFieldInternal(dim, idx, buf);
+        if (layout()->dimDetail(dim)->scaled())
+        {
+            double d = getFieldAs<double>(dim, idx);
+            memcpy(buf, &d, sizeof(d));
+        }
+        else
+            getFieldInternal(dim, idx, buf);
     }
 
     /*! @return a cumulated bounds of all points in the PointView.
@@ -255,6 +316,10 @@ public:
 
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
+    /// Tables that don't store points contiguously may return a copy of
+    /// the point (see ColumnPointTable), and tables that move points in
+    /// and out of memory may invalidate the pointer when other points are
+    /// accessed (see CompressedPointTable).
     char *getPoint(PointId id)
         { return m_pointTable.getPoint(m_index[id]); }
 
@@ -269,7 +334,7 @@ public:
 
 protected:
     PointTableRef m_pointTable;
-    std::deque<PointId> m_index;
+    PointViewIndex m_index;
     // The index might be larger than the size to support temporary point
     // references.
     point_count_t m_size;
@@ -278,6 +343,14 @@ protected:
     SpatialReference m_spatialReference;
 
 private:
+    PointViewRegistryPtr m_registry;
+
+    // View IDs are handed out from a single counter so that views created
+    // on different threads still get unique, increasing IDs.
+    static int nextId();
+    void renumber()
+        { m_id = nextId(); }
+
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id::Enum dim, PointId idx, T_IN in);
 
@@ -286,9 +359,17 @@ private:
     virtual void getFieldInternal(Dimension::Id::Enum dim, PointId idx,
         void *buf) const
     { m_pointTable.getFieldInternal(dim, m_index[idx], buf); }
+    virtual char *getPointData(PointId idx);
+    virtual char *getWritablePointData(PointId idx);
 
     template<class T>
     T getFieldInternal(Dimension::Id::Enum dim, PointId pointIndex) const;
+    template<typename T_IN, typename T_OUT>
+    void getFieldArrayAs(const Dimension::Detail *dd, PointId first,
+        point_count_t count, T_OUT *out) const;
+    template<typename T_IN, typename T_OUT>
+    void setFieldArrayAs(const Dimension::Detail *dd, PointId first,
+        point_count_t count, const T_IN *in);
     inline PointId getTemp(PointId id);
     void freeTemp(PointId id)
         { m_temps.push(id); }
@@ -420,6 +501,8 @@ inline T PointView::getFieldAs(Dimension::Id::Enum dim,
         break;
     case Dimension::Type::Signed32:
         val = getFieldInternal<int32_t>(dim, pointIndex);
+        if (dd->scaled())
+            val = dd->xform().fromScaled(val);
         break;
     case Dimension::Type::Signed64:
         val = static_cast<double>(getFieldInternal<int64_t>(dim, pointIndex));
@@ -489,7 +572,11 @@ void PointView::setField(Dimension::Id::Enum dim, PointId idx, T val)
         ok = convertAndSet<T, int16_t>(dim, idx, val);
         break;
     case Dimension::Type::Signed32:
-        ok = convertAndSet<T, int32_t>(dim, idx, val);
+        if (dd->scaled())
+            ok = convertAndSet<double, int32_t>(dim, idx,
+                dd->xform().toScaled((double)val));
+        else
+            ok = convertAndSet<T, int32_t>(dim, idx, val);
         break;
     case Dimension::Type::Signed64:
         ok = convertAndSet<T, int64_t>(dim, idx, val);
@@ -521,6 +608,245 @@ void PointView::setField(Dimension::Id::Enum dim, PointId idx, T val)
     }
 }
 
+template<typename T_IN, typename T_OUT>
+void PointView::getFieldArrayAs(const Dimension::Detail *dd, PointId first,
+    point_count_t count, T_OUT *out) const
+{
+    const bool scaled = dd->scaled();
+    const XForm& xform = dd->xform();
+    auto convert = [scaled, &xform](T_IN v, T_OUT& out)
+    {
+        return scaled ?
+            Utils::numericCast(xform.fromScaled((double)v), out) :
+            Utils::numericCast(v, out);
+    };
+
+    const PointId end = first + count;
+    PointId idx = first;
+    while (idx < end)
+    {
+        PointId rawId = m_index[idx];
+        size_t stride;
+        point_count_t run;
+        const char *pos =
+            m_pointTable.getDimensionRun(dd, rawId, stride, run);
+
+        // If the table doesn't provide direct access, fetch the point
+        // through the container interface.
+        T_IN in;
+        if (!pos)
+        {
+            m_pointTable.getFieldInternal(dd->id(), rawId, &in);
+            if (!convert(in, *out))
+                break;
+            out++;
+            idx++;
+            continue;
+        }
+
+        // Find the number of points that are adjacent in storage.
+        run = (std::min)(run, (point_count_t)(end - idx));
+        point_count_t n = m_index.run(idx, run);
+        point_count_t i = 0;
+        for (; i < n; ++i)
+        {
+            memcpy(&in, pos, sizeof(T_IN));
+            if (!convert(in, *out))
+                break;
+            out++;
+            pos += stride;
+        }
+        idx += i;
+        if (i != n)
+            break;
+    }
+    if (idx != end)
+    {
+        std::ostringstream oss;
+        oss << "Unable to fetch data and convert as requested: ";
+        oss << Dimension::name(dd->id()) << ":" <<
+            Dimension::interpretationName(dd->type()) <<
+            "(" << (double)getFieldInternal<T_IN>(dd->id(), idx) << ") -> " <<
+            Utils::typeidName<T_OUT>();
+        throw pdal_error(oss.str());
+    }
+}
+
+
+template<typename T>
+void PointView::getFieldArray(Dimension::Id::Enum dim, PointId first,
+    point_count_t count, T *out) const
+{
+    assert(first + count <= m_size);
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+
+    switch (dd->type())
+    {
+    case Dimension::Type::Float:
+        getFieldArrayAs<float>(dd, first, count, out);
+        break;
+    case Dimension::Type::Double:
+        getFieldArrayAs<double>(dd, first, count, out);
+        break;
+    case Dimension::Type::Signed8:
+        getFieldArrayAs<int8_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Signed16:
+        getFieldArrayAs<int16_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Signed32:
+        getFieldArrayAs<int32_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Signed64:
+        getFieldArrayAs<int64_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Unsigned8:
+        getFieldArrayAs<uint8_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Unsigned16:
+        getFieldArrayAs<uint16_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Unsigned32:
+        getFieldArrayAs<uint32_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::Unsigned64:
+        getFieldArrayAs<uint64_t>(dd, first, count, out);
+        break;
+    case Dimension::Type::None:
+    default:
+        std::fill(out, out + count, T(0));
+        break;
+    }
+}
+
+
+template<typename T_IN, typename T_OUT>
+void PointView::setFieldArrayAs(const Dimension::Detail *dd, PointId first,
+    point_count_t count, const T_IN *in)
+{
+    // Scaled values are converted to their stored form along with the
+    // rest of the run rather than through setField().
+    const bool scaled = dd->scaled();
+    const XForm& xform = dd->xform();
+    auto convert = [scaled, &xform](T_IN v, T_OUT& out)
+    {
+        return scaled ?
+            Utils::numericCast(xform.toScaled((double)v), out) :
+            Utils::numericCast(v, out);
+    };
+
+    const PointId end = first + count;
+    PointId idx = first;
+    while (idx < end)
+    {
+        PointId rawId = m_index[idx];
+        size_t stride;
+        point_count_t run;
+        char *pos = m_pointTable.getDimensionRun(dd, rawId, stride, run);
+
+        T_OUT out;
+        if (!pos)
+        {
+            if (!convert(*in, out))
+                break;
+            m_pointTable.setFieldInternal(dd->id(), rawId, &out);
+            in++;
+            idx++;
+            continue;
+        }
+
+        run = (std::min)(run, (point_count_t)(end - idx));
+        point_count_t n = m_index.run(idx, run);
+        point_count_t i = 0;
+        for (; i < n; ++i)
+        {
+            if (!convert(*in, out))
+                break;
+            memcpy(pos, &out, sizeof(T_OUT));
+            in++;
+            pos += stride;
+        }
+        idx += i;
+        if (i != n)
+            break;
+    }
+    if (idx != end)
+    {
+        std::ostringstream oss;
+        oss << "Unable to set data and convert as requested: ";
+        oss << Dimension::name(dd->id()) << ":" <<
+            Utils::typeidName<T_IN>() << "(" << (double)*in << ") -> " <<
+            Dimension::interpretationName(dd->type());
+        throw pdal_error(oss.str());
+    }
+}
+
+
+template<typename T>
+void PointView::setFieldArray(Dimension::Id::Enum dim, PointId first,
+    point_count_t count, const T *in)
+{
+    if (first > size())
+        throw pdal_error("Point index must increment.");
+
+    // Add storage for any points past the end of the view.
+    const point_count_t oldSize = size();
+    while (size() < first + count)
+    {
+        m_index.push_back(m_pointTable.addPoint());
+        m_size++;
+        assert(m_temps.empty());
+    }
+
+    const Dimension::Detail *dd = layout()->dimDetail(dim);
+    try
+    {
+        switch (dd->type())
+        {
+        case Dimension::Type::Float:
+            setFieldArrayAs<T, float>(dd, first, count, in);
+            break;
+        case Dimension::Type::Double:
+            setFieldArrayAs<T, double>(dd, first, count, in);
+            break;
+        case Dimension::Type::Signed8:
+            setFieldArrayAs<T, int8_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Signed16:
+            setFieldArrayAs<T, int16_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Signed32:
+            setFieldArrayAs<T, int32_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Signed64:
+            setFieldArrayAs<T, int64_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Unsigned8:
+            setFieldArrayAs<T, uint8_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Unsigned16:
+            setFieldArrayAs<T, uint16_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Unsigned32:
+            setFieldArrayAs<T, uint32_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::Unsigned64:
+            setFieldArrayAs<T, uint64_t>(dd, first, count, in);
+            break;
+        case Dimension::Type::None:
+            break;
+        }
+    }
+    catch (pdal_error&)
+    {
+        // Drop the points that were added so that a failed conversion
+        // doesn't leave the view with partly set points.
+        m_index.truncate(oldSize);
+        m_size = oldSize;
+        throw;
+    }
+}
+
 /**
 void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
     const void *value)
@@ -565,7 +891,7 @@ inline PointId PointView::getTemp(PointId id)
     {
         newid = m_temps.front();
         m_temps.pop();
-        m_index[newid] = m_index[id];
+        m_index.set(newid, m_index[id]);
     }
     else
     {
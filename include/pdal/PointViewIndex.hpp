@@ -0,0 +1,212 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+/// Maps the point IDs of a view to the IDs of the points in its table.
+/// Views whose points were added in table order, such as those created
+/// by readers, are stored as a range of table IDs and take no memory per
+/// point.  The first change that breaks the range (reordering points or
+/// adding a point out of sequence) switches to an explicit list of IDs.
+///
+/// An explicit list may be shared by slices of several views.  It's
+/// copied when an index sharing it is changed.
+class PointViewIndex
+{
+public:
+    PointViewIndex() : m_first(0), m_count(0), m_data(NULL)
+    {}
+
+    point_count_t size() const
+        { return m_count; }
+
+    PointId operator[](PointId idx) const
+        { return m_data ? m_data[idx] : m_first + idx; }
+
+    /// Whether the index is stored as an explicit list of table IDs.
+    bool isExplicit() const
+        { return m_data != NULL; }
+
+    /// Make an index of the entries in the range [begin, end).  The new
+    /// index shares this index's storage.
+    PointViewIndex slice(PointId begin, PointId end) const
+    {
+        PointViewIndex index(*this);
+        index.m_first = m_first + begin;
+        index.m_count = end - begin;
+        if (m_data)
+            index.m_data = m_data + begin;
+        return index;
+    }
+
+    void push_back(PointId rawId)
+    {
+        if (!m_data)
+        {
+            if (m_count == 0)
+                m_first = rawId;
+            if (rawId == m_first + m_count)
+            {
+                m_count++;
+                return;
+            }
+        }
+        own();
+        m_ids->push_back(rawId);
+        m_data = m_ids->data();
+        m_count++;
+    }
+
+    void set(PointId idx, PointId rawId)
+    {
+        if (!m_data && rawId == m_first + idx)
+            return;
+        own();
+        (*m_ids)[idx] = rawId;
+    }
+
+    /// Remove all entries past \a size.
+    void truncate(point_count_t size)
+    {
+        if (m_data && size != m_count)
+        {
+            own();
+            m_ids->resize(size);
+        }
+        m_count = size;
+    }
+
+    /// Append the first \a count entries of another index.
+    void append(const PointViewIndex& src, point_count_t count)
+    {
+        if (!m_data && !src.m_data)
+        {
+            if (m_count == 0)
+                m_first = src.m_first;
+            if (src.m_first == m_first + m_count || count == 0)
+            {
+                m_count += count;
+                return;
+            }
+        }
+        // Copy the source first in case it shares our storage.
+        std::vector<PointId> ids(count);
+        for (PointId i = 0; i < count; ++i)
+            ids[i] = src[i];
+        appendRaw(ids);
+    }
+
+    /// Append the entries of another index at the positions in \a ids.
+    void append(const PointViewIndex& src, const std::vector<PointId>& ids)
+    {
+        // Stay a range for as long as the new entries continue it.
+        auto ii = ids.begin();
+        if (!m_data)
+            for (; ii != ids.end(); ++ii)
+            {
+                PointId rawId = src[*ii];
+                if (m_count == 0)
+                    m_first = rawId;
+                else if (rawId != m_first + m_count)
+                    break;
+                m_count++;
+            }
+        if (ii == ids.end())
+            return;
+
+        std::vector<PointId> rawIds(ids.end() - ii);
+        for (PointId& rawId : rawIds)
+            rawId = src[*ii++];
+        appendRaw(rawIds);
+    }
+
+    /// Number of entries, starting at \a idx and up to \a max, that map
+    /// to consecutive table IDs.
+    point_count_t run(PointId idx, point_count_t max) const
+    {
+        if (!m_data)
+            return max;
+
+        point_count_t n = 1;
+        PointId rawId = m_data[idx];
+        while (n < max && m_data[idx + n] == rawId + n)
+            n++;
+        return n;
+    }
+
+private:
+    // For an explicit index, the entries are m_count IDs starting at
+    // m_data, which points into m_ids.  m_first is then the offset of
+    // m_data in m_ids.
+    PointId m_first;
+    point_count_t m_count;
+    std::shared_ptr<std::vector<PointId>> m_ids;
+    PointId *m_data;
+
+    void appendRaw(const std::vector<PointId>& rawIds)
+    {
+        own();
+        m_ids->reserve(m_count + rawIds.size());
+        m_ids->insert(m_ids->end(), rawIds.begin(), rawIds.end());
+        m_data = m_ids->data();
+        m_count += rawIds.size();
+    }
+
+    // Make sure the entries are the whole of an unshared list.
+    void own()
+    {
+        if (m_data && m_ids.use_count() == 1 && m_first == 0 &&
+            m_count == m_ids->size())
+            return;
+
+        std::shared_ptr<std::vector<PointId>> ids(
+            new std::vector<PointId>(m_count));
+        for (PointId i = 0; i < m_count; ++i)
+            (*ids)[i] = (*this)[i];
+        m_ids = ids;
+        m_data = m_ids->data();
+        m_first = 0;
+    }
+};
+
+} // namespace pdal
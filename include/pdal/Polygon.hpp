@@ -96,6 +96,7 @@ public:
     double area() const;
 
     bool covers(PointRef& ref) const;
+    bool covers(double x, double y, double z = 0.0) const;
     bool equal(const Polygon& p) const;
 
     bool valid() const;
@@ -69,6 +69,10 @@ private:
         return viewSet;
     }
     virtual void readerProcessOptions(const Options& options);
+    // A read callback may look at any dimension.
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return !m_cb; }
     virtual point_count_t read(PointViewPtr /*view*/, point_count_t /*num*/)
         { return 0; }
 };
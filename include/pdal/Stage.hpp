@@ -45,10 +45,12 @@
 #include <pdal/Options.hpp>
 #include <pdal/PipelineWriter.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/PointRange.hpp>
 #include <pdal/PointRef.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/QuickInfo.hpp>
 #include <pdal/SpatialReference.hpp>
+#include <pdal/StageStats.hpp>
 #include <pdal/UserCallback.hpp>
 
 #include <boost/property_tree/ptree.hpp>
@@ -83,7 +85,12 @@ public:
     }
     void prepare(PointTableRef table);
     PointViewSet execute(PointTableRef table);
-    void execute(StreamPointTable& table);
+    /// Stream points through the pipeline ending at this stage.
+    /// \return  Number of points that reached this stage.
+    point_count_t execute(StreamPointTable& table);
+    /// Whether this stage and all the stages that feed it support
+    /// streaming.
+    bool pipelineStreamable() const;
 
     void setSpatialReference(SpatialReference const&);
     const SpatialReference& getSpatialReference() const;
@@ -127,6 +134,12 @@ public:
     void setUserCallback(UserCallback* userCallback)
         { m_callback.reset(userCallback); }
 
+    /// Performance statistics of the stage, or NULL if the 'stats' option
+    /// wasn't set.  Statistics are also written to the stage's metadata
+    /// when it finishes executing.
+    const StageStats *stats() const
+        { return m_stats.get(); }
+
 protected:
     std::unique_ptr<UserCallback> m_callback;
     Options m_options;
@@ -135,17 +148,60 @@ protected:
 
     void setSpatialReference(MetadataNode& m, SpatialReference const&);
 
+    /// Return true if run() may be called concurrently for different
+    /// views from multiple threads.  Stages that return true must not
+    /// modify stage state in run() and may only read from their input view
+    /// and create new views from it.
+    virtual bool supportsConcurrentRun() const
+        { return false; }
+
+    /// Number of threads that may be used to process a single view: the
+    /// value of the 'threads' option, or 1 if views are already being run
+    /// concurrently.
+    uint32_t viewThreads() const
+    {
+        if (m_concurrentRun)
+            return 1;
+        m_threadsUsed = true;
+        return m_threads;
+    }
+
+    /// Count bytes read from or written to a stage's data source or
+    /// destination when statistics are being collected.
+    void addBytesRead(uint64_t bytes)
+    {
+        if (m_stats)
+            m_stats->addBytesRead(bytes);
+    }
+    void addBytesWritten(uint64_t bytes)
+    {
+        if (m_stats)
+            m_stats->addBytesWritten(bytes);
+    }
+
+    /// Statistics to which threads that a stage starts itself should add
+    /// their CPU time, or NULL if statistics aren't being collected.  The
+    /// time of the thread running the stage is already counted.
+    StageStats *workerStats()
+        { return m_stats.get(); }
+
 private:
     bool m_debug;
     uint32_t m_verbose;
+    uint32_t m_threads;
+    // Whether the stage consulted the 'threads' option while it ran.
+    mutable bool m_threadsUsed;
+    bool m_concurrentRun;
     std::vector<Stage *> m_inputs;
     LogPtr m_log;
     SpatialReference m_spatialReference;
+    std::unique_ptr<StageStats> m_stats;
 
     Stage& operator=(const Stage&); // not implemented
     Stage(const Stage&); // not implemented
     void Construct();
     void l_processOptions(const Options& options);
+    void logUnusedThreads() const;
     virtual void processOptions(const Options& /*options*/)
         {}
     virtual void readerProcessOptions(const Options& /*options*/)
@@ -161,24 +217,50 @@ private:
         {}
     virtual void addDimensions(PointLayoutPtr /*layout*/)
         {}
+    /// Dimensions whose values a reader sets for every point it adds.  If
+    /// these cover the table's layout, point storage isn't zeroed before
+    /// the reader fills it.
+    virtual Dimension::IdList initializedDims() const
+        { return Dimension::IdList(); }
+    bool initializesPoints(PointLayoutPtr layout) const;
+    /// Add the dimensions whose values the stage reads from points to
+    /// \a dims.  X, Y and Z are always considered used.  Return false if
+    /// the stage may read any dimension, which is the default.
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return false; }
+    void l_prepare(PointTableRef table);
+    void pruneDims(PointLayoutPtr layout);
     virtual void prepared(PointTableRef /*table*/)
         {}
     virtual void ready(PointTableRef /*table*/)
         {}
     virtual void done(PointTableRef /*table*/)
         {}
+    /// Return true if the stage implements processOne() or processBatch()
+    /// and so may be run in a streamed pipeline.
+    virtual bool streamable() const
+        { return false; }
     virtual bool processOne(PointRef& /*point*/)
     {
         std::ostringstream oss;
         oss << "Point streaming not supported for stage " << getName() << ".";
         throw pdal_error(oss.str());
     }
+    /// Process the selected points of a range when streaming.  Readers
+    /// fill the selected points in order, shrink the selection to the
+    /// points actually read and return false once there are no more points.
+    /// Other stages remove the points that they filter out from the
+    /// selection.  The default calls processOne() for each point.
+    virtual bool processBatch(PointRange& range, SelectionVector& sel);
+    bool l_processBatch(PointRange& range, SelectionVector& sel);
     virtual PointViewSet run(PointViewPtr /*view*/)
     {
         std::cerr << "Can't run stage = " << getName() << "!\n";
         return PointViewSet();
     }
-    void execute(StreamPointTable& table, std::list<Stage *>& stages);
+    point_count_t executePipelined(StreamPointTable& table,
+        std::list<Stage *>& stages);
     const Options& getOptions() const
         { return m_options; }
 };
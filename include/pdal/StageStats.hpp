@@ -0,0 +1,121 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/Metadata.hpp>
+
+namespace pdal
+{
+
+/// Performance statistics for a stage, collected when the stage's 'stats'
+/// option is set.  Times cover only the work of the stage itself, not of
+/// the stages that feed it.  CPU time includes that of worker threads the
+/// stage starts.  Statistics may be added from several threads.
+class PDAL_DLL StageStats
+{
+public:
+    StageStats() : m_wallTime(0), m_cpuTime(0), m_pointsIn(0),
+        m_pointsOut(0), m_bytesRead(0), m_bytesWritten(0), m_peakMemory(0)
+    {}
+
+    /// Adds the wall and/or CPU time from its construction to its
+    /// destruction to a StageStats.  Does nothing if the StageStats is
+    /// NULL, so timers can be left in place when statistics aren't wanted.
+    /// CPU time is that of the calling thread.
+    class Timer
+    {
+    public:
+        Timer(StageStats *stats, bool wall = true, bool cpu = true);
+        ~Timer();
+
+    private:
+        StageStats *m_stats;
+        bool m_wall;
+        bool m_cpu;
+        std::chrono::steady_clock::time_point m_wallStart;
+        double m_cpuStart;
+    };
+
+    void addPoints(uint64_t in, uint64_t out);
+    void addBytesRead(uint64_t bytes);
+    void addBytesWritten(uint64_t bytes);
+    /// Record the peak memory used by the point table.  The largest value
+    /// recorded is kept.
+    void updateMemory(uint64_t bytes);
+
+    double wallTime() const
+        { return m_wallTime; }
+    double cpuTime() const
+        { return m_cpuTime; }
+    uint64_t pointsIn() const
+        { return m_pointsIn; }
+    uint64_t pointsOut() const
+        { return m_pointsOut; }
+    uint64_t bytesRead() const
+        { return m_bytesRead; }
+    uint64_t bytesWritten() const
+        { return m_bytesWritten; }
+    /// Largest amount of memory used by the point table to hold point
+    /// data up to the time the stage finished.
+    uint64_t peakMemory() const
+        { return m_peakMemory; }
+
+    /// Write the statistics to a "stats" child of a node, replacing any
+    /// that were written before.
+    void toMetadata(MetadataNode node) const;
+
+    /// CPU time used by the calling thread, in seconds.
+    static double threadCpuTime();
+
+private:
+    void addTime(double wall, double cpu);
+
+    mutable std::mutex m_mutex;
+    double m_wallTime;
+    double m_cpuTime;
+    uint64_t m_pointsIn;
+    uint64_t m_pointsOut;
+    uint64_t m_bytesRead;
+    uint64_t m_bytesWritten;
+    uint64_t m_peakMemory;
+};
+
+} // namespace pdal
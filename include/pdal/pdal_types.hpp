@@ -84,6 +84,19 @@ public:
         return m_autoScale || m_autoOffset || m_scale != 1.0 || m_offset != 0.0;
     }
 
+    bool operator==(const XForm& other) const
+        { return m_scale == other.m_scale && m_offset == other.m_offset; }
+    bool operator!=(const XForm& other) const
+        { return !(*this == other); }
+
+    // Convert a value to its scaled representation.
+    double toScaled(double val) const
+        { return (val - m_offset) / m_scale; }
+
+    // Convert a scaled representation to its value.
+    double fromScaled(double val) const
+        { return val * m_scale + m_offset; }
+
     void setOffset(const std::string& sval)
     {
         if (sval == "auto")
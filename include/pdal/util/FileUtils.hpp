@@ -116,6 +116,38 @@ namespace FileUtils
     /// Return the filename stripped of the extension.  . and .. are returned
     /// unchanged.
     PDAL_DLL std::string stem(const std::string& path);
+
+    /// A read-only memory mapping of a file, created with mapFile().
+    struct MapContext
+    {
+        MapContext() : m_fd(-1), m_addr(NULL), m_size(0)
+        {}
+
+        /// Start of the mapped file, or NULL if the mapping failed.
+        const char *addr() const
+            { return (const char *)m_addr; }
+        uintmax_t size() const
+            { return m_size; }
+        /// Reason the mapping failed.
+        std::string what() const
+            { return m_error; }
+
+        int m_fd;
+        void *m_addr;
+        uintmax_t m_size;
+        std::string m_error;
+    };
+
+    /// Map a file into memory for reading.  Check addr() of the result
+    /// to see if the mapping succeeded.
+    /// \param filename  Name of the file to map.
+    /// \param sequential  Whether the file will be read from front to back,
+    ///   in which case the system is advised to read ahead.
+    PDAL_DLL MapContext mapFile(const std::string& filename,
+        bool sequential = false);
+
+    /// Release a mapping made with mapFile().  Returns an empty context.
+    PDAL_DLL MapContext unmapFile(MapContext ctx);
 }
 
 } // namespace pdal
@@ -0,0 +1,151 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace pdal
+{
+
+/// A fixed-size pool of worker threads that execute queued tasks.
+/// The first exception thrown by a task is captured and rethrown from
+/// await().
+class ThreadPool
+{
+public:
+    /// Create a pool.
+    /// \param numThreads  Number of worker threads.  If 0, use the number
+    ///   of hardware threads.
+    ThreadPool(size_t numThreads) : m_outstanding(0), m_stop(false)
+    {
+        if (numThreads == 0)
+            numThreads = (std::max)(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < numThreads; ++i)
+            m_threads.emplace_back([this](){ work(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_produceCv.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+    }
+
+    size_t numThreads() const
+        { return m_threads.size(); }
+
+    /// Queue a task for execution.
+    void add(const std::function<void()>& task)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_tasks.push(task);
+            m_outstanding++;
+        }
+        m_produceCv.notify_one();
+    }
+
+    /// Wait for all queued tasks to complete.  Rethrows the first exception
+    /// thrown by a task, if any.
+    void await()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_consumeCv.wait(lock, [this](){ return m_outstanding == 0; });
+        if (m_error)
+        {
+            std::exception_ptr err = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(err);
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    size_t m_outstanding;
+    bool m_stop;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_produceCv;
+    std::condition_variable m_consumeCv;
+
+    void work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_produceCv.wait(lock,
+                    [this](){ return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+            }
+
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!m_error)
+                    m_error = std::current_exception();
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (--m_outstanding == 0)
+                m_consumeCv.notify_all();
+        }
+    }
+
+    ThreadPool(const ThreadPool&); // not implemented
+    ThreadPool& operator=(const ThreadPool&); // not implemented
+};
+
+} // namespace pdal
@@ -118,6 +118,9 @@ void FauxReader::processOptions(const Options& options)
     m_stdev_z = options.getValueOrDefault<double>("stdev_z",1.0);
     m_mode = string2mode(options.getValueOrThrow<std::string>("mode"));
     m_numReturns = options.getValueOrDefault("number_of_returns", 0);
+    m_fixedSeed = options.hasOption("seed");
+    if (m_fixedSeed)
+        m_startSeed = options.getValueOrThrow<uint32_t>("seed");
     if (m_numReturns > 10)
     {
         std::ostringstream oss;
@@ -171,11 +174,23 @@ Dimension::IdList FauxReader::getDefaultDimensions()
     return ids;
 }
 
+// Every point gets a value for each dimension that's registered.
+Dimension::IdList FauxReader::initializedDims() const
+{
+    Dimension::IdList ids = getDefaultDimensions();
+    if (m_numReturns > 0)
+    {
+        ids.push_back(Dimension::Id::ReturnNumber);
+        ids.push_back(Dimension::Id::NumberOfReturns);
+    }
+    return ids;
+}
+
 void FauxReader::ready(PointTableRef /*table*/)
 {
     m_returnNum = 1;
     m_time = 0;
-    m_seed = (uint32_t)std::time(NULL);
+    m_seed = m_fixedSeed ? m_startSeed : (uint32_t)std::time(NULL);
     m_index = 0;
 }
 
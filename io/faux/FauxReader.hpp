@@ -114,10 +114,15 @@ private:
     int m_returnNum;
     point_count_t m_index;
     uint32_t m_seed;
+    bool m_fixedSeed;
+    uint32_t m_startSeed;
 
     virtual void processOptions(const Options& options);
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual Dimension::IdList initializedDims() const;
     virtual void ready(PointTableRef table);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual bool eof()
@@ -0,0 +1,694 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "LasBatch.hpp"
+#include "LasHeader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <pdal/util/portable_endian.hpp>
+#include <pdal/util/Utils.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PDAL_LAS_SSE2
+#include <emmintrin.h>
+#endif
+
+// The AVX2 functions are compiled for AVX2 with a target attribute, so the
+// rest of PDAL needs no special flags.  They're only called after checking
+// that the processor supports AVX2.
+#if defined(PDAL_LAS_SSE2) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define PDAL_LAS_AVX2
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace pdal
+{
+namespace LasBatch
+{
+
+namespace
+{
+
+// A bit field in one of the flag bytes of a record.  Decoding extracts
+// (byte >> shift) & mask.  Encoding ORs (value & encodeMask) << shift into
+// the byte.  The encode masks reproduce what the LAS writer has always
+// done with values that don't fit their field.
+struct BitField
+{
+    int shift;
+    uint8_t mask;
+    uint8_t encodeMask;
+};
+
+const BitField returnNum10 = { 0, 0x07, 0xFF };
+const BitField numReturns10 = { 3, 0x07, 0x1F };
+const BitField scanDirFlag10 = { 6, 0x01, 0x03 };
+const BitField flight10 = { 7, 0x01, 0x01 };
+
+const BitField returnNum14 = { 0, 0x0F, 0xFF };
+const BitField numReturns14 = { 4, 0x0F, 0x0F };
+const BitField classFlags14 = { 0, 0x0F, 0x0F };
+const BitField scanChannel14 = { 4, 0x03, 0x03 };
+const BitField scanDirFlag14 = { 6, 0x01, 0x01 };
+const BitField flight14 = { 7, 0x01, 0x01 };
+
+inline uint8_t fromLe(uint8_t v)
+    { return v; }
+inline int8_t fromLe(int8_t v)
+    { return v; }
+inline uint16_t fromLe(uint16_t v)
+    { return le16toh(v); }
+inline int16_t fromLe(int16_t v)
+    { return (int16_t)le16toh((uint16_t)v); }
+inline int32_t fromLe(int32_t v)
+    { return (int32_t)le32toh((uint32_t)v); }
+inline double fromLe(double v)
+{
+    uint64_t i;
+    memcpy(&i, &v, sizeof(i));
+    i = le64toh(i);
+    memcpy(&v, &i, sizeof(v));
+    return v;
+}
+
+inline uint8_t toLe(uint8_t v)
+    { return v; }
+inline uint16_t toLe(uint16_t v)
+    { return htole16(v); }
+inline int16_t toLe(int16_t v)
+    { return (int16_t)htole16((uint16_t)v); }
+inline int32_t toLe(int32_t v)
+    { return (int32_t)htole32((uint32_t)v); }
+inline double toLe(double v)
+{
+    uint64_t i;
+    memcpy(&i, &v, sizeof(i));
+    i = htole64(i);
+    memcpy(&v, &i, sizeof(v));
+    return v;
+}
+
+// Copy a field of each record into an array.
+template<typename T_FILE, typename T>
+void gather(const char *buf, size_t stride, size_t offset,
+    point_count_t count, T *out)
+{
+    buf += offset;
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        T_FILE v;
+        memcpy(&v, buf, sizeof(v));
+        out[i] = (T)fromLe(v);
+        buf += stride;
+    }
+}
+
+// Copy an array into a field of each record.
+template<typename T>
+void scatter(const T *in, point_count_t count, size_t offset, size_t stride,
+    char *buf)
+{
+    buf += offset;
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        T v = toLe(in[i]);
+        memcpy(buf, &v, sizeof(v));
+        buf += stride;
+    }
+}
+
+// Scalar kernels.  These also finish the points left over by the vector
+// kernels.
+
+void fromScaledScalar(const XForm& xform, const int32_t *in,
+    point_count_t count, double *out)
+{
+    for (point_count_t i = 0; i < count; ++i)
+        out[i] = in[i] * xform.m_scale + xform.m_offset;
+}
+
+bool toScaledScalar(const XForm& xform, const double *in,
+    point_count_t count, int32_t *out)
+{
+    for (point_count_t i = 0; i < count; ++i)
+        if (!Utils::numericCast(xform.toScaled(in[i]), out[i]))
+            return false;
+    return true;
+}
+
+void splitScalar(const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    for (point_count_t i = 0; i < count; ++i)
+        out[i] = (in[i] >> f.shift) & f.mask;
+}
+
+void packScalar(const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    for (point_count_t i = 0; i < count; ++i)
+        out[i] |= (uint8_t)((in[i] & f.encodeMask) << f.shift);
+}
+
+// Bounds that a value may have before truncation and still convert to
+// an int32.
+const double minScaled = -2147483649.0;
+const double maxScaled = 2147483648.0;
+
+#ifdef PDAL_LAS_SSE2
+
+void fromScaledSse2(const XForm& xform, const int32_t *in,
+    point_count_t count, double *out)
+{
+    const __m128d scale = _mm_set1_pd(xform.m_scale);
+    const __m128d offset = _mm_set1_pd(xform.m_offset);
+
+    point_count_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i v = _mm_loadl_epi64((const __m128i *)(in + i));
+        __m128d d = _mm_cvtepi32_pd(v);
+        d = _mm_add_pd(_mm_mul_pd(d, scale), offset);
+        _mm_storeu_pd(out + i, d);
+    }
+    fromScaledScalar(xform, in + i, count - i, out + i);
+}
+
+// Rounding is half away from zero, like Utils::sround(): add or subtract
+// one half and truncate.
+bool toScaledSse2(const XForm& xform, const double *in,
+    point_count_t count, int32_t *out)
+{
+    const __m128d scale = _mm_set1_pd(xform.m_scale);
+    const __m128d offset = _mm_set1_pd(xform.m_offset);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d negHalf = _mm_set1_pd(-0.5);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d lo = _mm_set1_pd(minScaled);
+    const __m128d hi = _mm_set1_pd(maxScaled);
+    __m128d ok = _mm_cmpeq_pd(zero, zero);
+
+    point_count_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128d d = _mm_loadu_pd(in + i);
+        d = _mm_div_pd(_mm_sub_pd(d, offset), scale);
+        __m128d pos = _mm_cmpgt_pd(d, zero);
+        d = _mm_add_pd(d,
+            _mm_or_pd(_mm_and_pd(pos, half), _mm_andnot_pd(pos, negHalf)));
+        ok = _mm_and_pd(ok,
+            _mm_and_pd(_mm_cmpgt_pd(d, lo), _mm_cmplt_pd(d, hi)));
+        _mm_storel_epi64((__m128i *)(out + i), _mm_cvttpd_epi32(d));
+    }
+    if (_mm_movemask_pd(ok) != 3)
+        return false;
+    return toScaledScalar(xform, in + i, count - i, out + i);
+}
+
+// There are no byte shifts, so shift 16-bit lanes and mask off the bits
+// that crossed from the neighboring byte.
+void splitSse2(const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    const __m128i shift = _mm_cvtsi32_si128(f.shift);
+    const __m128i mask = _mm_set1_epi8((char)f.mask);
+
+    point_count_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        v = _mm_and_si128(_mm_srl_epi16(v, shift), mask);
+        _mm_storeu_si128((__m128i *)(out + i), v);
+    }
+    splitScalar(in + i, count - i, f, out + i);
+}
+
+void packSse2(const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    const __m128i shift = _mm_cvtsi32_si128(f.shift);
+    const __m128i mask = _mm_set1_epi8((char)(uint8_t)(f.encodeMask << f.shift));
+
+    point_count_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i o = _mm_loadu_si128((const __m128i *)(out + i));
+        v = _mm_and_si128(_mm_sll_epi16(v, shift), mask);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_or_si128(o, v));
+    }
+    packScalar(in + i, count - i, f, out + i);
+}
+
+#endif // PDAL_LAS_SSE2
+
+#ifdef PDAL_LAS_AVX2
+
+AVX2_TARGET
+void fromScaledAvx2(const XForm& xform, const int32_t *in,
+    point_count_t count, double *out)
+{
+    const __m256d scale = _mm256_set1_pd(xform.m_scale);
+    const __m256d offset = _mm256_set1_pd(xform.m_offset);
+
+    point_count_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m256d d = _mm256_cvtepi32_pd(v);
+        // Multiply and add separately.  A fused multiply-add rounds
+        // differently from the scalar code.
+        d = _mm256_add_pd(_mm256_mul_pd(d, scale), offset);
+        _mm256_storeu_pd(out + i, d);
+    }
+    fromScaledScalar(xform, in + i, count - i, out + i);
+}
+
+AVX2_TARGET
+bool toScaledAvx2(const XForm& xform, const double *in,
+    point_count_t count, int32_t *out)
+{
+    const __m256d scale = _mm256_set1_pd(xform.m_scale);
+    const __m256d offset = _mm256_set1_pd(xform.m_offset);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d negHalf = _mm256_set1_pd(-0.5);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d lo = _mm256_set1_pd(minScaled);
+    const __m256d hi = _mm256_set1_pd(maxScaled);
+    __m256d ok = _mm256_cmp_pd(zero, zero, _CMP_EQ_OQ);
+
+    point_count_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d d = _mm256_loadu_pd(in + i);
+        d = _mm256_div_pd(_mm256_sub_pd(d, offset), scale);
+        __m256d pos = _mm256_cmp_pd(d, zero, _CMP_GT_OQ);
+        d = _mm256_add_pd(d, _mm256_blendv_pd(negHalf, half, pos));
+        ok = _mm256_and_pd(ok,
+            _mm256_and_pd(_mm256_cmp_pd(d, lo, _CMP_GT_OQ),
+                _mm256_cmp_pd(d, hi, _CMP_LT_OQ)));
+        _mm_storeu_si128((__m128i *)(out + i), _mm256_cvttpd_epi32(d));
+    }
+    if (_mm256_movemask_pd(ok) != 0xF)
+        return false;
+    return toScaledScalar(xform, in + i, count - i, out + i);
+}
+
+AVX2_TARGET
+void splitAvx2(const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    const __m128i shift = _mm_cvtsi32_si128(f.shift);
+    const __m256i mask = _mm256_set1_epi8((char)f.mask);
+
+    point_count_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+        v = _mm256_and_si256(_mm256_srl_epi16(v, shift), mask);
+        _mm256_storeu_si256((__m256i *)(out + i), v);
+    }
+    splitScalar(in + i, count - i, f, out + i);
+}
+
+AVX2_TARGET
+void packAvx2(const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    const __m128i shift = _mm_cvtsi32_si128(f.shift);
+    const __m256i mask =
+        _mm256_set1_epi8((char)(uint8_t)(f.encodeMask << f.shift));
+
+    point_count_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i o = _mm256_loadu_si256((const __m256i *)(out + i));
+        v = _mm256_and_si256(_mm256_sll_epi16(v, shift), mask);
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_or_si256(o, v));
+    }
+    packScalar(in + i, count - i, f, out + i);
+}
+
+#endif // PDAL_LAS_AVX2
+
+void split(Isa isa, const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    switch (isa)
+    {
+#ifdef PDAL_LAS_AVX2
+    case Isa::Avx2:
+        splitAvx2(in, count, f, out);
+        break;
+#endif
+#ifdef PDAL_LAS_SSE2
+    case Isa::Sse2:
+        splitSse2(in, count, f, out);
+        break;
+#endif
+    default:
+        splitScalar(in, count, f, out);
+        break;
+    }
+}
+
+void pack(Isa isa, const uint8_t *in, point_count_t count, BitField f,
+    uint8_t *out)
+{
+    switch (isa)
+    {
+#ifdef PDAL_LAS_AVX2
+    case Isa::Avx2:
+        packAvx2(in, count, f, out);
+        break;
+#endif
+#ifdef PDAL_LAS_SSE2
+    case Isa::Sse2:
+        packSse2(in, count, f, out);
+        break;
+#endif
+    default:
+        packScalar(in, count, f, out);
+        break;
+    }
+}
+
+Isa detectIsa()
+{
+#ifdef PDAL_LAS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::Avx2;
+#endif
+#ifdef PDAL_LAS_SSE2
+    return Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+} // unnamed namespace
+
+
+Isa bestIsa()
+{
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+
+std::vector<Isa> supportedIsas()
+{
+    std::vector<Isa> isas { Isa::Scalar };
+    Isa best = bestIsa();
+    if (best == Isa::Sse2 || best == Isa::Avx2)
+        isas.push_back(Isa::Sse2);
+    if (best == Isa::Avx2)
+        isas.push_back(Isa::Avx2);
+    return isas;
+}
+
+
+std::string isaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Avx2:
+        return "avx2";
+    case Isa::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+
+Format::Format(const LasHeader& header) : m_pointLen(header.pointLen()),
+    m_v14(header.has14Format()), m_hasTime(header.hasTime()),
+    m_hasColor(header.hasColor()), m_hasInfrared(header.hasInfrared()),
+    m_x(header.scaleX(), header.offsetX()),
+    m_y(header.scaleY(), header.offsetY()),
+    m_z(header.scaleZ(), header.offsetZ())
+{}
+
+
+size_t Format::extraOffset() const
+{
+    if (m_hasInfrared)
+        return infraredOffset() + 2;
+    if (m_hasColor)
+        return colorOffset() + 6;
+    if (m_hasTime)
+        return timeOffset() + 8;
+    return 20;
+}
+
+
+void Columns::resize(const Format& format, point_count_t count)
+{
+    xi.resize(count);
+    yi.resize(count);
+    zi.resize(count);
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    intensity.resize(count);
+    returnNum.resize(count);
+    numReturns.resize(count);
+    scanDirFlag.resize(count);
+    flight.resize(count);
+    classification.resize(count);
+    userData.resize(count);
+    scanAngle.resize(count);
+    pointSourceId.resize(count);
+    if (format.m_v14)
+    {
+        classFlags.resize(count);
+        scanChannel.resize(count);
+    }
+    if (format.m_hasTime)
+        gpsTime.resize(count);
+    if (format.m_hasColor)
+    {
+        red.resize(count);
+        green.resize(count);
+        blue.resize(count);
+    }
+    if (format.m_hasInfrared)
+        infrared.resize(count);
+}
+
+
+void fromScaled(const XForm& xform, const int32_t *in, point_count_t count,
+    double *out, Isa isa)
+{
+    switch (isa)
+    {
+#ifdef PDAL_LAS_AVX2
+    case Isa::Avx2:
+        fromScaledAvx2(xform, in, count, out);
+        break;
+#endif
+#ifdef PDAL_LAS_SSE2
+    case Isa::Sse2:
+        fromScaledSse2(xform, in, count, out);
+        break;
+#endif
+    default:
+        fromScaledScalar(xform, in, count, out);
+        break;
+    }
+}
+
+
+bool toScaled(const XForm& xform, const double *in, point_count_t count,
+    int32_t *out, Isa isa)
+{
+    switch (isa)
+    {
+#ifdef PDAL_LAS_AVX2
+    case Isa::Avx2:
+        return toScaledAvx2(xform, in, count, out);
+#endif
+#ifdef PDAL_LAS_SSE2
+    case Isa::Sse2:
+        return toScaledSse2(xform, in, count, out);
+#endif
+    default:
+        return toScaledScalar(xform, in, count, out);
+    }
+}
+
+
+void decode(const Format& format, const char *buf, point_count_t count,
+    Columns& cols, bool scaleXyz, Isa isa)
+{
+    const size_t stride = format.m_pointLen;
+
+    cols.resize(format, count);
+    gather<int32_t>(buf, stride, 0, count, cols.xi.data());
+    gather<int32_t>(buf, stride, 4, count, cols.yi.data());
+    gather<int32_t>(buf, stride, 8, count, cols.zi.data());
+    if (scaleXyz)
+    {
+        fromScaled(format.m_x, cols.xi.data(), count, cols.x.data(), isa);
+        fromScaled(format.m_y, cols.yi.data(), count, cols.y.data(), isa);
+        fromScaled(format.m_z, cols.zi.data(), count, cols.z.data(), isa);
+    }
+    gather<uint16_t>(buf, stride, 12, count, cols.intensity.data());
+
+    // The flag bytes are gathered into a scratch array and split from there.
+    std::vector<uint8_t> bits(count);
+    if (format.m_v14)
+    {
+        gather<uint8_t>(buf, stride, 14, count, bits.data());
+        split(isa, bits.data(), count, returnNum14, cols.returnNum.data());
+        split(isa, bits.data(), count, numReturns14, cols.numReturns.data());
+        gather<uint8_t>(buf, stride, 15, count, bits.data());
+        split(isa, bits.data(), count, classFlags14, cols.classFlags.data());
+        split(isa, bits.data(), count, scanChannel14,
+            cols.scanChannel.data());
+        split(isa, bits.data(), count, scanDirFlag14,
+            cols.scanDirFlag.data());
+        split(isa, bits.data(), count, flight14, cols.flight.data());
+        gather<uint8_t>(buf, stride, 16, count, cols.classification.data());
+        gather<uint8_t>(buf, stride, 17, count, cols.userData.data());
+        gather<int16_t>(buf, stride, 18, count, cols.scanAngle.data());
+        for (double& a : cols.scanAngle)
+            a *= .006;
+        gather<uint16_t>(buf, stride, 20, count, cols.pointSourceId.data());
+    }
+    else
+    {
+        gather<uint8_t>(buf, stride, 14, count, bits.data());
+        split(isa, bits.data(), count, returnNum10, cols.returnNum.data());
+        split(isa, bits.data(), count, numReturns10, cols.numReturns.data());
+        split(isa, bits.data(), count, scanDirFlag10,
+            cols.scanDirFlag.data());
+        split(isa, bits.data(), count, flight10, cols.flight.data());
+        gather<uint8_t>(buf, stride, 15, count, cols.classification.data());
+        gather<int8_t>(buf, stride, 16, count, cols.scanAngle.data());
+        gather<uint8_t>(buf, stride, 17, count, cols.userData.data());
+        gather<uint16_t>(buf, stride, 18, count, cols.pointSourceId.data());
+    }
+    if (format.m_hasTime)
+        gather<double>(buf, stride, format.timeOffset(), count,
+            cols.gpsTime.data());
+    if (format.m_hasColor)
+    {
+        size_t offset = format.colorOffset();
+        gather<uint16_t>(buf, stride, offset, count, cols.red.data());
+        gather<uint16_t>(buf, stride, offset + 2, count, cols.green.data());
+        gather<uint16_t>(buf, stride, offset + 4, count, cols.blue.data());
+    }
+    if (format.m_hasInfrared)
+        gather<uint16_t>(buf, stride, format.infraredOffset(), count,
+            cols.infrared.data());
+}
+
+
+void encode(const Format& format, const Columns& cols, point_count_t count,
+    char *buf, Isa isa)
+{
+    const size_t stride = format.m_pointLen;
+
+    scatter(cols.xi.data(), count, 0, stride, buf);
+    scatter(cols.yi.data(), count, 4, stride, buf);
+    scatter(cols.zi.data(), count, 8, stride, buf);
+    scatter(cols.intensity.data(), count, 12, stride, buf);
+
+    std::vector<uint8_t> bits(count);
+    if (format.m_v14)
+    {
+        pack(isa, cols.returnNum.data(), count, returnNum14, bits.data());
+        pack(isa, cols.numReturns.data(), count, numReturns14, bits.data());
+        scatter(bits.data(), count, 14, stride, buf);
+
+        std::fill(bits.begin(), bits.end(), 0);
+        pack(isa, cols.classFlags.data(), count, classFlags14, bits.data());
+        pack(isa, cols.scanChannel.data(), count, scanChannel14,
+            bits.data());
+        pack(isa, cols.scanDirFlag.data(), count, scanDirFlag14,
+            bits.data());
+        pack(isa, cols.flight.data(), count, flight14, bits.data());
+        scatter(bits.data(), count, 15, stride, buf);
+
+        scatter(cols.classification.data(), count, 16, stride, buf);
+        scatter(cols.userData.data(), count, 17, stride, buf);
+        // The angle is stored in units of .006 degrees, truncated.
+        std::vector<int16_t> angle(count);
+        for (point_count_t i = 0; i < count; ++i)
+            angle[i] = (int16_t)(cols.scanAngle[i] / .006);
+        scatter(angle.data(), count, 18, stride, buf);
+        scatter(cols.pointSourceId.data(), count, 20, stride, buf);
+    }
+    else
+    {
+        pack(isa, cols.returnNum.data(), count, returnNum10, bits.data());
+        pack(isa, cols.numReturns.data(), count, numReturns10, bits.data());
+        pack(isa, cols.scanDirFlag.data(), count, scanDirFlag10,
+            bits.data());
+        pack(isa, cols.flight.data(), count, flight10, bits.data());
+        scatter(bits.data(), count, 14, stride, buf);
+
+        scatter(cols.classification.data(), count, 15, stride, buf);
+        std::vector<uint8_t> angle(count);
+        for (point_count_t i = 0; i < count; ++i)
+            angle[i] = (uint8_t)(int8_t)cols.scanAngle[i];
+        scatter(angle.data(), count, 16, stride, buf);
+        scatter(cols.userData.data(), count, 17, stride, buf);
+        scatter(cols.pointSourceId.data(), count, 18, stride, buf);
+    }
+    if (format.m_hasTime)
+        scatter(cols.gpsTime.data(), count, format.timeOffset(), stride, buf);
+    if (format.m_hasColor)
+    {
+        size_t offset = format.colorOffset();
+        scatter(cols.red.data(), count, offset, stride, buf);
+        scatter(cols.green.data(), count, offset + 2, stride, buf);
+        scatter(cols.blue.data(), count, offset + 4, stride, buf);
+    }
+    if (format.m_hasInfrared)
+        scatter(cols.infrared.data(), count, format.infraredOffset(), stride,
+            buf);
+}
+
+} // namespace LasBatch
+} // namespace pdal
@@ -0,0 +1,153 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/pdal_types.hpp>
+
+namespace pdal
+{
+
+class LasHeader;
+
+// Decoding and encoding of the standard fields of many LAS point records
+// at once.  Records are split into one array per field so that scaling of
+// X, Y and Z and unpacking of the flag bytes can be done with vector
+// instructions.  The instruction set is chosen when the program runs.
+namespace LasBatch
+{
+
+enum class Isa
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+/// Return the fastest instruction set supported by both the build and the
+/// processor we're running on.
+PDAL_DLL Isa bestIsa();
+
+/// Return all the instruction sets that can be used on this machine,
+/// starting with Isa::Scalar.
+PDAL_DLL std::vector<Isa> supportedIsas();
+
+PDAL_DLL std::string isaName(Isa isa);
+
+/// Layout of the standard part of a LAS point record.
+struct PDAL_DLL Format
+{
+    Format() : m_pointLen(20), m_v14(false), m_hasTime(false),
+        m_hasColor(false), m_hasInfrared(false)
+    {}
+    Format(const LasHeader& header);
+
+    size_t m_pointLen;
+    bool m_v14;
+    bool m_hasTime;
+    bool m_hasColor;
+    bool m_hasInfrared;
+    XForm m_x;
+    XForm m_y;
+    XForm m_z;
+
+    size_t timeOffset() const
+        { return m_v14 ? 22 : 20; }
+    size_t colorOffset() const
+        { return m_v14 ? 30 : (m_hasTime ? 28 : 20); }
+    size_t infraredOffset() const
+        { return colorOffset() + 6; }
+    /// Offset of the extra bytes that follow the standard fields.
+    size_t extraOffset() const;
+};
+
+/// The standard fields of a batch of points.  Only the arrays that apply
+/// to the point format are filled.
+struct PDAL_DLL Columns
+{
+    void resize(const Format& format, point_count_t count);
+
+    std::vector<int32_t> xi;
+    std::vector<int32_t> yi;
+    std::vector<int32_t> zi;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<uint16_t> intensity;
+    std::vector<uint8_t> returnNum;
+    std::vector<uint8_t> numReturns;
+    std::vector<uint8_t> classFlags;
+    std::vector<uint8_t> scanChannel;
+    std::vector<uint8_t> scanDirFlag;
+    std::vector<uint8_t> flight;
+    std::vector<uint8_t> classification;
+    std::vector<uint8_t> userData;
+    /// Scan angle rank for formats 0-5, scan angle in degrees for 6-10.
+    std::vector<double> scanAngle;
+    std::vector<uint16_t> pointSourceId;
+    std::vector<double> gpsTime;
+    std::vector<uint16_t> red;
+    std::vector<uint16_t> green;
+    std::vector<uint16_t> blue;
+    std::vector<uint16_t> infrared;
+};
+
+/// Decode \a count records of \a format from \a buf into \a cols.
+/// \param scaleXyz  Whether to fill x, y and z as well as the raw integers.
+PDAL_DLL void decode(const Format& format, const char *buf,
+    point_count_t count, Columns& cols, bool scaleXyz, Isa isa = bestIsa());
+
+/// Encode \a count points from \a cols into the records at \a buf.  X, Y
+/// and Z are taken from the raw integers.  Extra bytes aren't touched.
+PDAL_DLL void encode(const Format& format, const Columns& cols,
+    point_count_t count, char *buf, Isa isa = bestIsa());
+
+/// Convert values to their scaled integers, rounding as
+/// Utils::numericCast() does.
+/// \return  Whether all the values could be represented as int32.
+PDAL_DLL bool toScaled(const XForm& xform, const double *in,
+    point_count_t count, int32_t *out, Isa isa = bestIsa());
+
+/// Convert scaled integers to their values.
+PDAL_DLL void fromScaled(const XForm& xform, const int32_t *in,
+    point_count_t count, double *out, Isa isa = bestIsa());
+
+} // namespace LasBatch
+
+} // namespace pdal
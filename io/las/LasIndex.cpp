@@ -0,0 +1,383 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "LasIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include <pdal/util/Extractor.hpp>
+#include <pdal/util/Inserter.hpp>
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const uint32_t IndexVersion = 1;
+const int MaxLevel = 16;
+const uint32_t ChunkBoundsVersion = 1;
+// A count and six doubles.
+const size_t ChunkRecordSize = sizeof(uint32_t) + 6 * sizeof(double);
+
+// Sort runs by their first point and combine those that overlap or touch.
+void merge(LasIndex::IntervalList& list)
+{
+    std::sort(list.begin(), list.end(),
+        [](const LasIndex::Interval& a, const LasIndex::Interval& b)
+        { return a.m_begin < b.m_begin; });
+
+    LasIndex::IntervalList out;
+    for (auto& i : list)
+    {
+        if (out.size() && i.m_begin <= out.back().m_end)
+            out.back().m_end = std::max(out.back().m_end, i.m_end);
+        else
+            out.push_back(i);
+    }
+    list.swap(out);
+}
+
+void throwInvalid(const std::string& filename, const std::string& why)
+{
+    std::ostringstream oss;
+    oss << "Invalid LAS index file '" << filename << "': " << why << ".";
+    throw pdal_error(oss.str());
+}
+
+} // unnamed namespace
+
+LasIndex::LasIndex(const BOX2D& bounds, point_count_t numPoints, int level) :
+    m_bounds(bounds), m_numPoints(numPoints), m_fileSize(0), m_level(level),
+    m_lastId(0), m_lastCell(NULL)
+{
+    // Each level quadruples the number of cells.
+    if (m_level < 0)
+    {
+        double cells = numPoints / 1000.0;
+        m_level = cells > 1 ? (int)std::lround(std::log2(cells) / 2) : 0;
+        m_level = std::min(m_level, 10);
+    }
+    m_level = std::min(m_level, MaxLevel);
+}
+
+
+uint32_t LasIndex::column(double x) const
+{
+    double width = m_bounds.maxx - m_bounds.minx;
+    if (!(x > m_bounds.minx) || !(width > 0))
+        return 0;
+    double c = (x - m_bounds.minx) / width * dim();
+    return c >= dim() ? dim() - 1 : (uint32_t)c;
+}
+
+
+uint32_t LasIndex::row(double y) const
+{
+    double height = m_bounds.maxy - m_bounds.miny;
+    if (!(y > m_bounds.miny) || !(height > 0))
+        return 0;
+    double r = (y - m_bounds.miny) / height * dim();
+    return r >= dim() ? dim() - 1 : (uint32_t)r;
+}
+
+
+// Points outside the bounds are put in the nearest cell, so they're still
+// found by a query that reaches the edge of the grid.
+void LasIndex::add(point_count_t index, double x, double y)
+{
+    uint32_t id = row(y) * dim() + column(x);
+
+    if (!m_lastCell || id != m_lastId)
+    {
+        m_lastCell = &m_cells[id];
+        m_lastId = id;
+    }
+    IntervalList& cell = *m_lastCell;
+    if (cell.size() && cell.back().m_end == index)
+        cell.back().m_end++;
+    else
+        cell.push_back(Interval(index, index + 1));
+}
+
+
+void LasIndex::finish(point_count_t gap)
+{
+    for (auto& c : m_cells)
+    {
+        IntervalList& list = c.second;
+        IntervalList out;
+        for (auto& i : list)
+        {
+            if (out.size() && i.m_begin - out.back().m_end <= gap)
+                out.back().m_end = i.m_end;
+            else
+                out.push_back(i);
+        }
+        list.swap(out);
+    }
+    m_lastCell = NULL;
+}
+
+
+size_t LasIndex::numIntervals() const
+{
+    size_t count = 0;
+    for (auto& c : m_cells)
+        count += c.second.size();
+    return count;
+}
+
+
+LasIndex::IntervalList LasIndex::query(const BOX2D& box) const
+{
+    IntervalList list;
+    if (box.empty())
+        return list;
+
+    uint32_t c0 = column(box.minx);
+    uint32_t c1 = column(box.maxx);
+    uint32_t r0 = row(box.miny);
+    uint32_t r1 = row(box.maxy);
+
+    // A large box covers more cells than are occupied, so walk the
+    // occupied ones instead.
+    uint64_t span = (uint64_t)(c1 - c0 + 1) * (r1 - r0 + 1);
+    if (span > m_cells.size())
+    {
+        for (auto& c : m_cells)
+        {
+            uint32_t col = c.first % dim();
+            uint32_t r = c.first / dim();
+            if (col >= c0 && col <= c1 && r >= r0 && r <= r1)
+                list.insert(list.end(), c.second.begin(), c.second.end());
+        }
+    }
+    else
+    {
+        for (uint32_t r = r0; r <= r1; ++r)
+            for (uint32_t col = c0; col <= c1; ++col)
+            {
+                auto it = m_cells.find(r * dim() + col);
+                if (it != m_cells.end())
+                    list.insert(list.end(), it->second.begin(),
+                        it->second.end());
+            }
+    }
+    merge(list);
+    return list;
+}
+
+
+void LasIndex::write(const std::string& filename) const
+{
+    OLeStream out(filename);
+    if (!out)
+        throw pdal_error("Unable to open LAS index file '" + filename +
+            "' for writing.");
+
+    out.put("PDIX");
+    out << IndexVersion;
+    out << m_bounds.minx << m_bounds.miny << m_bounds.maxx << m_bounds.maxy;
+    out << (uint64_t)m_numPoints << m_fileSize << (uint32_t)m_level <<
+        (uint32_t)m_cells.size();
+    for (auto& c : m_cells)
+    {
+        out << c.first << (uint64_t)c.second.size();
+        for (auto& i : c.second)
+            out << (uint64_t)i.m_begin << (uint64_t)i.m_end;
+    }
+    out.flush();
+    if (!out)
+        throw pdal_error("Error writing LAS index file '" + filename + "'.");
+}
+
+
+void LasIndex::read(const std::string& filename)
+{
+    ILeStream in(filename);
+    if (!in)
+        throw pdal_error("Unable to open LAS index file '" + filename + "'.");
+
+    std::string magic;
+    uint32_t version;
+    in.get(magic, 4);
+    in >> version;
+    if (!in || magic != "PDIX")
+        throwInvalid(filename, "not an index file");
+    if (version != IndexVersion)
+        throwInvalid(filename, "unsupported version");
+
+    uint64_t numPoints;
+    uint32_t level;
+    uint32_t numCells;
+    in >> m_bounds.minx >> m_bounds.miny >> m_bounds.maxx >> m_bounds.maxy;
+    in >> numPoints >> m_fileSize >> level >> numCells;
+    if (!in || level > (uint32_t)MaxLevel ||
+        numPoints > std::numeric_limits<point_count_t>::max())
+        throwInvalid(filename, "bad header");
+    m_numPoints = (point_count_t)numPoints;
+    m_level = (int)level;
+
+    m_cells.clear();
+    m_lastCell = NULL;
+    for (uint32_t c = 0; c < numCells; ++c)
+    {
+        uint32_t id;
+        uint64_t count;
+        in >> id >> count;
+        if (!in || id >= (uint64_t)dim() * dim() || count > m_numPoints)
+            throwInvalid(filename, "bad cell");
+
+        IntervalList& list = m_cells[id];
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            uint64_t begin;
+            uint64_t end;
+            in >> begin >> end;
+            if (!in || begin >= end || end > m_numPoints)
+                throwInvalid(filename, "bad interval");
+            list.push_back(
+                Interval((point_count_t)begin, (point_count_t)end));
+        }
+    }
+}
+
+
+std::string LasIndex::mismatch(uint64_t fileSize, const BOX2D& bounds,
+    point_count_t numPoints) const
+{
+    if (numPoints != m_numPoints)
+        return "number of points";
+    if (fileSize != m_fileSize)
+        return "file size";
+    if (!(bounds == m_bounds))
+        return "bounds";
+    return std::string();
+}
+
+
+void LasChunkBounds::add(point_count_t count, const BOX3D& bounds)
+{
+    Chunk c;
+    c.m_count = count;
+    c.m_bounds = bounds;
+    m_chunks.push_back(c);
+}
+
+
+point_count_t LasChunkBounds::numPoints() const
+{
+    point_count_t count = 0;
+    for (auto& c : m_chunks)
+        count += c.m_count;
+    return count;
+}
+
+
+LasIndex::IntervalList LasChunkBounds::query(const BOX2D& box) const
+{
+    LasIndex::IntervalList list;
+    if (box.empty())
+        return list;
+
+    point_count_t begin = 0;
+    for (auto& c : m_chunks)
+    {
+        point_count_t end = begin + c.m_count;
+        const BOX3D& b = c.m_bounds;
+        bool overlaps = b.minx <= box.maxx && box.minx <= b.maxx &&
+            b.miny <= box.maxy && box.miny <= b.maxy;
+        if (overlaps && c.m_count)
+        {
+            if (list.size() && list.back().m_end == begin)
+                list.back().m_end = end;
+            else
+                list.push_back(LasIndex::Interval(begin, end));
+        }
+        begin = end;
+    }
+    return list;
+}
+
+
+std::vector<uint8_t> LasChunkBounds::data() const
+{
+    std::vector<uint8_t> buf(2 * sizeof(uint32_t) +
+        m_chunks.size() * ChunkRecordSize);
+    LeInserter out(buf.data(), buf.size());
+
+    out << ChunkBoundsVersion << (uint32_t)m_chunks.size();
+    for (auto& c : m_chunks)
+    {
+        const BOX3D& b = c.m_bounds;
+        out << (uint32_t)c.m_count << b.minx << b.miny << b.minz <<
+            b.maxx << b.maxy << b.maxz;
+    }
+    return buf;
+}
+
+
+void LasChunkBounds::setData(const char *buf, size_t size)
+{
+    m_chunks.clear();
+    if (size < 2 * sizeof(uint32_t))
+        throw pdal_error("Invalid chunk bounds VLR.");
+
+    LeExtractor in(buf, size);
+    uint32_t version;
+    uint32_t numChunks;
+    in >> version >> numChunks;
+    if (version != ChunkBoundsVersion)
+        throw pdal_error("Unsupported chunk bounds VLR version.");
+    if (size != 2 * sizeof(uint32_t) + numChunks * ChunkRecordSize)
+        throw pdal_error("Invalid chunk bounds VLR.");
+
+    for (uint32_t i = 0; i < numChunks; ++i)
+    {
+        uint32_t count;
+        BOX3D b;
+        in >> count >> b.minx >> b.miny >> b.minz >> b.maxx >> b.maxy >>
+            b.maxz;
+        add(count, b);
+    }
+}
+
+} // namespace pdal
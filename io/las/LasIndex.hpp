@@ -0,0 +1,178 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/pdal_types.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+// Spatial index of the points of a LAS file, kept in a file alongside it.
+// The XY extent of the file is divided into a grid of 2^level by 2^level
+// cells (the leaves of a quadtree) and each cell holds the runs of
+// consecutive point indices that fall in it.  A query returns the runs of
+// points that may lie within a box, so a reader can skip the rest of the
+// file.  Points in the returned runs still need to be checked.
+class PDAL_DLL LasIndex
+{
+public:
+    /// Run of points [m_begin, m_end).
+    struct Interval
+    {
+        Interval() : m_begin(0), m_end(0)
+        {}
+        Interval(point_count_t begin, point_count_t end) :
+            m_begin(begin), m_end(end)
+        {}
+
+        point_count_t m_begin;
+        point_count_t m_end;
+    };
+    typedef std::vector<Interval> IntervalList;
+
+    LasIndex() : m_numPoints(0), m_fileSize(0), m_level(0), m_lastId(0),
+        m_lastCell(NULL)
+    {}
+
+    /// Create an empty index.
+    /// \param bounds  XY extent of the points.
+    /// \param numPoints  Number of points in the file.
+    /// \param level  Depth of the quadtree.  If negative, a depth is chosen
+    ///   that puts about a thousand points in each cell.
+    LasIndex(const BOX2D& bounds, point_count_t numPoints, int level = -1);
+
+    /// Name of the index file used for a LAS file when none is given.
+    static std::string defaultFilename(const std::string& lasFilename)
+        { return lasFilename + ".pdx"; }
+
+    /// Add a point to the index.  Points must be added in file order.
+    void add(point_count_t index, double x, double y);
+
+    /// Merge runs in each cell that are separated by fewer than 'gap'
+    /// points.  Reading a few extra points is cheaper than a seek.
+    void finish(point_count_t gap = 64);
+
+    /// Return the sorted, non-overlapping runs of points whose cells
+    /// intersect 'box'.
+    IntervalList query(const BOX2D& box) const;
+
+    void write(const std::string& filename) const;
+    void read(const std::string& filename);
+
+    /// Set the size of the indexed LAS file.  It's stored with the index
+    /// so that an index left from an earlier version of the file can be
+    /// detected.
+    void setFileSize(uint64_t size)
+        { m_fileSize = size; }
+
+    /// Check that the index was made for a file with the given size,
+    /// extent and number of points.
+    /// \return  A description of the first difference, or an empty string
+    ///   if there is none.
+    std::string mismatch(uint64_t fileSize, const BOX2D& bounds,
+        point_count_t numPoints) const;
+
+    const BOX2D& bounds() const
+        { return m_bounds; }
+    point_count_t numPoints() const
+        { return m_numPoints; }
+    uint64_t fileSize() const
+        { return m_fileSize; }
+    int level() const
+        { return m_level; }
+    size_t numCells() const
+        { return m_cells.size(); }
+    size_t numIntervals() const;
+
+private:
+    uint32_t dim() const
+        { return 1u << m_level; }
+    uint32_t column(double x) const;
+    uint32_t row(double y) const;
+
+    BOX2D m_bounds;
+    point_count_t m_numPoints;
+    uint64_t m_fileSize;
+    int m_level;
+    std::map<uint32_t, IntervalList> m_cells;
+    // Consecutive points usually land in the same cell, so the last one
+    // used is kept to save a lookup.
+    uint32_t m_lastId;
+    IntervalList *m_lastCell;
+};
+
+// Bounds of each run of points in a LAS file, written by writers.las in an
+// extended VLR when points are put in space-filling-curve order.  The runs
+// follow one another from the first point, so the first point of a run is
+// the sum of the counts of those before it.
+class PDAL_DLL LasChunkBounds
+{
+public:
+    struct Chunk
+    {
+        point_count_t m_count;
+        BOX3D m_bounds;
+    };
+
+    /// Add the next run of points.
+    void add(point_count_t count, const BOX3D& bounds);
+
+    /// Return the runs of points whose bounds meet 'box', with neighbouring
+    /// runs combined.
+    LasIndex::IntervalList query(const BOX2D& box) const;
+
+    /// Number of points in all runs.
+    point_count_t numPoints() const;
+    const std::vector<Chunk>& chunks() const
+        { return m_chunks; }
+
+    /// Contents of the VLR.
+    std::vector<uint8_t> data() const;
+    /// Set from the contents of a VLR.  Throws pdal_error if the data
+    /// isn't valid.
+    void setData(const char *buf, size_t size);
+
+private:
+    std::vector<Chunk> m_chunks;
+};
+
+} // namespace pdal
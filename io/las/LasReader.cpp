@@ -44,6 +44,7 @@
 #include <pdal/util/Extractor.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/IStream.hpp>
+#include <pdal/util/portable_endian.hpp>
 
 #include "GeotiffSupport.hpp"
 #include "LasHeader.hpp"
@@ -63,6 +64,34 @@ public:
         {}
 };
 
+#ifdef PDAL_HAVE_LAZPERF
+// Pick out the chunks holding points in any of the ranges, which are in
+// order, and note the index of the first point of each.
+std::vector<LazChunk> selectChunks(const std::vector<LazChunk>& chunks,
+    const std::deque<LasIndex::Interval>& ranges,
+    std::deque<point_count_t>& starts)
+{
+    std::vector<LazChunk> selected;
+    auto ri = ranges.begin();
+    point_count_t chunkStart = 0;
+    for (const LazChunk& chunk : chunks)
+    {
+        point_count_t chunkEnd = chunkStart + chunk.count;
+        while (ri != ranges.end() && ri->m_end <= chunkStart)
+            ++ri;
+        if (ri == ranges.end())
+            break;
+        if (ri->m_begin < chunkEnd)
+        {
+            selected.push_back(chunk);
+            starts.push_back(chunkStart);
+        }
+        chunkStart = chunkEnd;
+    }
+    return selected;
+}
+#endif
+
 } // unnamed namespace
 
 void LasReader::processOptions(const Options& options)
@@ -70,6 +99,61 @@ void LasReader::processOptions(const Options& options)
     StringList extraDims = options.getValueOrDefault<StringList>("extra_dims");
     m_extraDims = LasUtils::parse(extraDims);
 
+    m_scaledXyz = options.getValueOrDefault("scaled_xyz", false);
+    m_start = options.getValueOrDefault<point_count_t>("start", 0);
+
+    m_query = false;
+    m_queryZ = false;
+    m_queryBox.clear();
+    m_queryPolygon.reset();
+    if (options.hasOption("bounds"))
+    {
+        try
+        {
+            m_queryBox = options.getValueOrThrow<BOX2D>("bounds");
+        }
+        catch (Option::cant_convert&)
+        {
+            try
+            {
+                BOX3D box = options.getValueOrThrow<BOX3D>("bounds");
+                m_queryBox = box.to2d();
+                m_queryZ = true;
+                m_queryMinZ = box.minz;
+                m_queryMaxZ = box.maxz;
+            }
+            catch (Option::cant_convert&)
+            {
+                std::ostringstream oss;
+                oss << getName() << ": Invalid bounds provided as option.  "
+                    "Format: '([xmin,xmax],[ymin,ymax])'.";
+                throw pdal_error(oss.str());
+            }
+        }
+        m_query = true;
+    }
+    if (options.hasOption("polygon"))
+    {
+        try
+        {
+            m_queryPolygon.reset(new Polygon(
+                options.getValueOrThrow<Polygon>("polygon")));
+        }
+        catch (Option::cant_convert&)
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Invalid polygon specification as option.  "
+                "Must be valid GeoJSON/WKT.";
+            throw pdal_error(oss.str());
+        }
+        // Throws if invalid.
+        m_queryPolygon->valid();
+        if (!m_query)
+            m_queryBox = m_queryPolygon->bounds().to2d();
+        m_query = true;
+    }
+    m_indexFilename = options.getValueOrDefault<std::string>("index", "");
+
     m_compression = options.getValueOrDefault<std::string>("compression",
         "LASZIP");
     std::string compression = Utils::toupper(m_compression);
@@ -180,8 +264,42 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
 
 void LasReader::ready(PointTableRef table)
 {
+    using namespace Dimension;
+
+    PointLayoutPtr layout = table.layout();
+    m_acc.x.bind(layout, Id::X);
+    m_acc.y.bind(layout, Id::Y);
+    m_acc.z.bind(layout, Id::Z);
+    m_acc.intensity.bind(layout, Id::Intensity);
+    m_acc.returnNum.bind(layout, Id::ReturnNumber);
+    m_acc.numReturns.bind(layout, Id::NumberOfReturns);
+    m_acc.classFlags.bind(layout, Id::ClassFlags);
+    m_acc.scanChannel.bind(layout, Id::ScanChannel);
+    m_acc.scanDirFlag.bind(layout, Id::ScanDirectionFlag);
+    m_acc.flight.bind(layout, Id::EdgeOfFlightLine);
+    m_acc.classification.bind(layout, Id::Classification);
+    m_acc.scanAngle.bind(layout, Id::ScanAngleRank);
+    m_acc.userData.bind(layout, Id::UserData);
+    m_acc.pointSourceId.bind(layout, Id::PointSourceId);
+    m_acc.gpsTime.bind(layout, Id::GpsTime);
+    m_acc.red.bind(layout, Id::Red);
+    m_acc.green.bind(layout, Id::Green);
+    m_acc.blue.bind(layout, Id::Blue);
+    m_acc.infrared.bind(layout, Id::Infrared);
+
+    const LasHeader& h = m_lasHeader;
+    m_rawXyz = m_acc.x.scaledAs(XForm(h.scaleX(), h.offsetX())) &&
+        m_acc.y.scaledAs(XForm(h.scaleY(), h.offsetY())) &&
+        m_acc.z.scaledAs(XForm(h.scaleZ(), h.offsetZ()));
+    m_batchFormat = LasBatch::Format(h);
+
+    // The input is opened at the first point of the first range, but no
+    // range is taken until reading starts.
+    selectRanges();
+    m_index = m_ranges.size() ? m_ranges.front().m_begin : 0;
+    m_end = m_index;
+
     m_istream = createStream();
-    m_index = 0;
     if (m_lasHeader.compressed())
     {
 #ifdef PDAL_HAVE_LASZIP
@@ -208,6 +326,13 @@ void LasReader::ready(PointTableRef table)
                     oss << "Failed to open LASzip stream: " << std::string(err);
                     throw pdal_error(oss.str());
                 }
+                if (m_index && !m_unzipper->seek(m_index))
+                {
+                    std::ostringstream oss;
+                    oss << "Unable to seek to point " << m_index <<
+                        " of LASzip stream.";
+                    throw pdal_error(oss.str());
+                }
             }
         }
 #endif
@@ -217,9 +342,41 @@ void LasReader::ready(PointTableRef table)
         {
             VariableLengthRecord *vlr = findVlr(LASZIP_USER_ID,
                 LASZIP_RECORD_ID);
-            m_decompressor.reset(new LazPerfVlrDecompressor(*m_istream,
-                vlr->data(), m_lasHeader.pointOffset()));
-            m_decompressorBuf.resize(m_decompressor->pointSize());
+            m_chunkDecompressor.reset();
+            m_chunkPoints = NULL;
+            m_chunkStarts.clear();
+            // The chunk table is also the only way to skip points without
+            // decompressing them, so it's used for that even on one thread.
+            bool skipping = m_index > 0 || m_ranges.size() > 1;
+            if (viewThreads() > 1 || skipping)
+            {
+                laszip::io::laz_vlr zipvlr(vlr->data());
+                std::vector<LazChunk> chunks =
+                    readLazChunkTable(*m_istream, m_lasHeader.pointOffset(),
+                        zipvlr.chunk_size, getNumPoints());
+                m_istream->clear();
+                if (chunks.size() > 1)
+                {
+                    // Chunks without any points wanted aren't read.
+                    chunks = selectChunks(chunks, m_ranges, m_chunkStarts);
+                    m_chunkDecompressor.reset(
+                        new LazPerfChunkDecompressor(*m_istream, vlr->data(),
+                            chunks, viewThreads(), 2 * viewThreads(),
+                            workerStats()));
+                }
+                else
+                    log()->get(LogLevel::Debug) << getName() << ": No "
+                        "usable chunk table.  Decompressing on a single "
+                        "thread.\n";
+            }
+            if (!m_chunkDecompressor)
+            {
+                m_decompressor.reset(new LazPerfVlrDecompressor(*m_istream,
+                    vlr->data(), m_lasHeader.pointOffset()));
+                m_decompressorBuf.resize(m_decompressor->pointSize());
+                for (point_count_t i = 0; i < m_index; ++i)
+                    m_decompressor->decompress(m_decompressorBuf.data());
+            }
         }
 #endif
 
@@ -229,18 +386,222 @@ void LasReader::ready(PointTableRef table)
 #endif
     }
     else
-        m_istream->seekg(m_lasHeader.pointOffset());
+        readyUncompressed();
 
     m_error.setLog(log());
 }
 
 
+// Uncompressed points are decoded straight from a read-only mapping of
+// the file when it can be made, which saves copying them through the
+// stream.  Either way, getting to the first point is a seek.
+void LasReader::readyUncompressed()
+{
+    size_t pointLen = m_lasHeader.pointLen();
+    uint64_t pointStart = dataOffset() + m_lasHeader.pointOffset();
+
+    m_map = FileUtils::mapFile(m_filename, true);
+    if (m_map.addr() && m_map.size() >= pointStart)
+    {
+        // A truncated file has fewer points than the header says.
+        uint64_t available = (m_map.size() - pointStart) / pointLen;
+        if (available < getNumPoints())
+            clipRanges((point_count_t)available);
+        return;
+    }
+    if (m_map.addr())
+        m_map = FileUtils::unmapFile(m_map);
+    else
+        log()->get(LogLevel::Debug) << getName() << ": " << m_map.what() <<
+            "  Reading through a stream.\n";
+    m_istream->seekg(m_lasHeader.pointOffset() + (uint64_t)m_index * pointLen);
+}
+
+
+char *LasReader::mappedPoint() const
+{
+    return const_cast<char *>(m_map.addr()) + dataOffset() +
+        m_lasHeader.pointOffset() + (uint64_t)m_index * m_lasHeader.pointLen();
+}
+
+
+// Work out the runs of points to read.  That's [start, start + count),
+// cut down to the runs the spatial index gives for the query, if there
+// is one.
+void LasReader::selectRanges()
+{
+    point_count_t begin = std::min(m_start, getNumPoints());
+    point_count_t end = getNumPoints();
+    if (m_count < end - begin)
+        end = begin + m_count;
+
+    m_ranges.clear();
+    LasIndex::IntervalList intervals;
+    if (m_query && (indexRanges(intervals) || chunkRanges(intervals)))
+    {
+        for (auto& i : intervals)
+        {
+            point_count_t b = std::max(i.m_begin, begin);
+            point_count_t e = std::min(i.m_end, end);
+            if (b < e)
+                m_ranges.push_back(LasIndex::Interval(b, e));
+        }
+        log()->get(LogLevel::Debug) << getName() << ": Selected " <<
+            m_ranges.size() << " runs of points to read.\n";
+    }
+    else if (begin < end)
+        m_ranges.push_back(LasIndex::Interval(begin, end));
+}
+
+
+// An index named with the 'index' option must exist and match the file.
+// Otherwise the default index file is used if there is one and it matches,
+// and if not, the whole file is scanned.
+bool LasReader::indexRanges(LasIndex::IntervalList& intervals)
+{
+    std::string filename = m_indexFilename;
+    bool named = filename.size();
+    if (!named)
+    {
+        filename = LasIndex::defaultFilename(m_filename);
+        if (!FileUtils::fileExists(filename))
+            return false;
+    }
+
+    LasIndex index;
+    std::string error;
+    try
+    {
+        index.read(filename);
+        std::string diff = index.mismatch(FileUtils::fileSize(m_filename),
+            m_lasHeader.getBounds().to2d(), getNumPoints());
+        if (diff.size())
+            error = "Index '" + filename + "' is out of date for '" +
+                m_filename + "': the " + diff + " of the file changed.  "
+                "Recreate it with 'pdal index'.";
+    }
+    catch (pdal_error& err)
+    {
+        error = err.what();
+    }
+    if (error.size())
+    {
+        if (named)
+            throw pdal_error(getName() + ": " + error);
+        log()->get(LogLevel::Warning) << getName() << ": Ignoring index.  " <<
+            error << "\n";
+        return false;
+    }
+    intervals = index.query(m_queryBox);
+    return true;
+}
+
+
+// Files written in space-filling-curve order by writers.las carry the
+// bounds of each chunk of points, which serve as a coarse index when there's
+// no index file.
+bool LasReader::chunkRanges(LasIndex::IntervalList& intervals)
+{
+    VariableLengthRecord *vlr = findVlr(PDAL_USER_ID, CHUNK_BOUNDS_RECORD_ID);
+    if (!vlr)
+        return false;
+
+    LasChunkBounds bounds;
+    try
+    {
+        bounds.setData(vlr->data(), vlr->dataLen());
+    }
+    catch (pdal_error& err)
+    {
+        log()->get(LogLevel::Warning) << getName() << ": Ignoring chunk "
+            "bounds.  " << err.what() << "\n";
+        return false;
+    }
+    if (bounds.numPoints() != getNumPoints())
+    {
+        log()->get(LogLevel::Warning) << getName() << ": Ignoring chunk "
+            "bounds, which don't cover the points of the file.\n";
+        return false;
+    }
+    intervals = bounds.query(m_queryBox);
+    return true;
+}
+
+
+// Drop any points past 'numPoints' from the ranges to be read.
+void LasReader::clipRanges(point_count_t numPoints)
+{
+    while (m_ranges.size() && m_ranges.back().m_begin >= numPoints)
+        m_ranges.pop_back();
+    if (m_ranges.size() && m_ranges.back().m_end > numPoints)
+        m_ranges.back().m_end = numPoints;
+    m_end = std::min(m_end, numPoints);
+    m_index = std::min(m_index, m_end);
+}
+
+
+// Start on the next range of points, if any.
+bool LasReader::nextRange()
+{
+    if (m_ranges.empty())
+        return false;
+
+    LasIndex::Interval r = m_ranges.front();
+    m_ranges.pop_front();
+    if (r.m_begin != m_index)
+        seekPoint(r.m_begin);
+    m_index = r.m_begin;
+    m_end = r.m_end;
+    return true;
+}
+
+
+// Position the input so that the next point read is 'index', which is
+// past m_index.
+void LasReader::seekPoint(point_count_t index)
+{
+    if (m_lasHeader.compressed())
+    {
+#ifdef PDAL_HAVE_LASZIP
+        if (m_compression == "LASZIP" && !m_unzipper->seek(index))
+        {
+            std::ostringstream oss;
+            oss << "Unable to seek to point " << index <<
+                " of LASzip stream.";
+            throw pdal_error(oss.str());
+        }
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+        // The chunk decompressor finds the point by m_index by itself.
+        if (m_compression == "LAZPERF" && !m_chunkDecompressor)
+            for (point_count_t i = m_index; i < index; ++i)
+                m_decompressor->decompress(m_decompressorBuf.data());
+#endif
+    }
+    else if (!m_map.addr())
+    {
+        m_istream->clear();
+        m_istream->seekg(m_lasHeader.pointOffset() +
+            (uint64_t)index * m_lasHeader.pointLen());
+    }
+}
+
+
 Options LasReader::getDefaultOptions()
 {
     Options options;
     options.add("filename", "", "file to read from");
     options.add("extra_dims", "", "Extra dimensions not part of the LAS "
         "point format to be read from each point.");
+    options.add("scaled_xyz", false, "Store X, Y and Z as integers scaled "
+        "with the file's scale and offset rather than as doubles.");
+    options.add("start", 0, "Index of the first point to read.");
+    options.add("bounds", "", "Only read points within these bounds.");
+    options.add("polygon", "", "Only read points within this WKT or "
+        "GeoJSON polygon.");
+    options.add("index", "", "Spatial index file used to find the points "
+        "within 'bounds' or 'polygon'.  Defaults to the file name with "
+        "'.pdx' appended, if that file exists.");
     return options;
 }
 
@@ -561,9 +922,19 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 {
     using namespace Dimension;
 
-    layout->registerDim(Id::X, Type::Double);
-    layout->registerDim(Id::Y, Type::Double);
-    layout->registerDim(Id::Z, Type::Double);
+    if (m_scaledXyz)
+    {
+        const LasHeader& h = m_lasHeader;
+        layout->registerScaledDim(Id::X, XForm(h.scaleX(), h.offsetX()));
+        layout->registerScaledDim(Id::Y, XForm(h.scaleY(), h.offsetY()));
+        layout->registerScaledDim(Id::Z, XForm(h.scaleZ(), h.offsetZ()));
+    }
+    else
+    {
+        layout->registerDim(Id::X, Type::Double);
+        layout->registerDim(Id::Y, Type::Double);
+        layout->registerDim(Id::Z, Type::Double);
+    }
     layout->registerDim(Id::Intensity, Type::Unsigned16);
     layout->registerDim(Id::ReturnNumber, Type::Unsigned8);
     layout->registerDim(Id::NumberOfReturns, Type::Unsigned8);
@@ -602,13 +973,48 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 }
 
 
-bool LasReader::processOne(PointRef& point)
+// The dimensions set by loadPoint().  Note that ScanChannel and ClassFlags
+// are registered for all version 1.4 files but only set for 1.4 point
+// formats.
+Dimension::IdList LasReader::initializedDims() const
 {
-    if (m_index >= getNumPoints())
-        return false;
+    using namespace Dimension;
 
-    size_t pointLen = m_lasHeader.pointLen();
+    IdList ids { Id::X, Id::Y, Id::Z, Id::Intensity, Id::ReturnNumber,
+        Id::NumberOfReturns, Id::ScanDirectionFlag, Id::EdgeOfFlightLine,
+        Id::Classification, Id::ScanAngleRank, Id::UserData,
+        Id::PointSourceId };
 
+    if (m_lasHeader.hasTime())
+        ids.push_back(Id::GpsTime);
+    if (m_lasHeader.hasColor())
+    {
+        ids.push_back(Id::Red);
+        ids.push_back(Id::Green);
+        ids.push_back(Id::Blue);
+    }
+    if (m_lasHeader.has14Format())
+    {
+        ids.push_back(Id::ScanChannel);
+        ids.push_back(Id::ClassFlags);
+        if (m_lasHeader.hasInfrared())
+            ids.push_back(Id::Infrared);
+    }
+    for (auto& dim : m_extraDims)
+        if (dim.m_dimType.m_type != Dimension::Type::None)
+            ids.push_back(dim.m_dimType.m_id);
+    return ids;
+}
+
+
+// Return the next point record, moving on to the next range of points
+// when the current one is used up, or NULL when there are no more.
+char *LasReader::nextRecord()
+{
+    if (m_index >= m_end && !nextRange())
+        return NULL;
+
+    char *record = NULL;
     if (m_lasHeader.compressed())
     {
 #ifdef PDAL_HAVE_LASZIP
@@ -623,16 +1029,20 @@ bool LasReader::processOne(PointRef& point)
                 error += err;
                 throw pdal_error(error);
             }
-            loadPoint(point, (char *)m_zipPoint->m_lz_point_data.data(),
-                pointLen);
+            record = (char *)m_zipPoint->m_lz_point_data.data();
         }
 #endif
 
 #ifdef PDAL_HAVE_LAZPERF
         if (m_compression == "LAZPERF")
         {
-            m_decompressor->decompress(m_decompressorBuf.data());
-            loadPoint(point, m_decompressorBuf.data(), pointLen);
+            if (m_chunkDecompressor)
+                record = nextChunkPoint();
+            else
+            {
+                m_decompressor->decompress(m_decompressorBuf.data());
+                record = m_decompressorBuf.data();
+            }
         }
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && !defined(PDAL_HAVE_LASZIP)
@@ -640,24 +1050,76 @@ bool LasReader::processOne(PointRef& point)
             "LAZperf decompression library.");
 #endif
     } // compression
+    else if (m_map.addr())
+        record = mappedPoint();
     else
     {
-        std::vector<char> buf(m_lasHeader.pointLen());
-
-        m_istream->read(buf.data(), pointLen);
-        loadPoint(point, buf.data(), pointLen);
+        m_batchBuf.resize(m_lasHeader.pointLen());
+        m_istream->read(m_batchBuf.data(), m_batchBuf.size());
+        record = m_batchBuf.data();
     }
     m_index++;
+    return record;
+}
+
+
+bool LasReader::processOne(PointRef& point)
+{
+    // Points outside the query are skipped.
+    char *record;
+    do
+    {
+        record = nextRecord();
+        if (!record)
+            return false;
+    } while (m_query && !inQuery(record));
+
+    loadPoint(point, record, m_lasHeader.pointLen());
     return true;
 }
 
 
-point_count_t LasReader::read(PointViewPtr view, point_count_t count)
+bool LasReader::processBatch(PointRange& range, SelectionVector& sel)
 {
-    size_t pointLen = m_lasHeader.pointLen();
-    count = std::min(count, getNumPoints() - m_index);
+    // Compressed points are decompressed one at a time.
+    if (m_lasHeader.compressed())
+    {
+        PointRef point = range.point(0);
+        for (size_t i = 0; i < sel.size(); ++i)
+        {
+            point.setPointId(sel[i]);
+            if (!processOne(point))
+            {
+                sel.resize(i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Uncompressed points are read a range at a time.
+    PointRef point = range.point(0);
+    point_count_t numKept = 0;
+    while (numKept < sel.size() && (m_index < m_end || nextRange()))
+    {
+        char *buf;
+        point_count_t count = std::min<point_count_t>(sel.size() - numKept,
+            m_end - m_index);
+        count = readRecords(count, buf);
+        count = selectRecords(buf, count);
+        loadPoints(point, sel.data() + numKept, buf, count);
+        numKept += count;
+    }
+
+    bool more = (numKept == sel.size());
+    sel.resize(numKept);
+    return more;
+}
+
 
-    PointId i = 0;
+point_count_t LasReader::read(PointViewPtr view, point_count_t count)
+{
+    point_count_t i = 0;
     if (m_lasHeader.compressed())
     {
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
@@ -665,9 +1127,10 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
         {
             for (i = 0; i < count; i++)
             {
-                PointRef point = view->point(i);
                 PointId id = view->size();
-                processOne(point);
+                PointRef point = view->point(id);
+                if (!processOne(point))
+                    break;
                 if (m_cb)
                     m_cb(*view, id);
             }
@@ -679,38 +1142,102 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
     }
     else
     {
-        point_count_t remaining = count;
+        while (i < count && (m_index < m_end || nextRange()))
+        {
+            char *buf;
+            point_count_t blockPoints = std::min(count - i, m_end - m_index);
+            blockPoints = readRecords(blockPoints, buf);
+            blockPoints = selectRecords(buf, blockPoints);
+            loadPoints(*view, buf, blockPoints);
+            i += blockPoints;
+        }
+    }
+    return i;
+}
 
-        // Make a buffer at most a meg.
-        size_t bufsize = std::min<size_t>((point_count_t)1000000,
-            count * pointLen);
-        std::vector<char> buf(bufsize);
-        try
+
+// Get up to 'count' uncompressed records of the current range, straight
+// from the map or read into a buffer of at most a meg.  A short read means
+// the file is truncated, so nothing more is read.
+point_count_t LasReader::readRecords(point_count_t count, char *& buf)
+{
+    if (m_map.addr())
+    {
+        buf = mappedPoint();
+        m_index += count;
+        return count;
+    }
+
+    size_t pointLen = m_lasHeader.pointLen();
+    count = std::min(count,
+        std::max<point_count_t>(1000000 / pointLen, 1));
+    m_batchBuf.resize(count * pointLen);
+    point_count_t numRead = 0;
+    try
+    {
+        numRead = readFileBlock(m_batchBuf, count);
+    }
+    catch (invalid_stream&)
+    {}
+    buf = m_batchBuf.data();
+    m_index += numRead;
+    if (numRead < count)
+    {
+        m_ranges.clear();
+        m_end = m_index;
+    }
+    return numRead;
+}
+
+
+// Keep only the records in 'buf' that meet the query, copying them to a
+// scratch buffer, since the records may be in read-only memory.
+point_count_t LasReader::selectRecords(char *& buf, point_count_t count)
+{
+    if (!m_query)
+        return count;
+
+    size_t pointLen = m_lasHeader.pointLen();
+    m_queryBuf.resize(count * pointLen);
+    char *out = m_queryBuf.data();
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        const char *record = buf + i * pointLen;
+        if (inQuery(record))
         {
-            do
-            {
-                point_count_t blockPoints = readFileBlock(buf, remaining);
-                remaining -= blockPoints;
-                char *pos = buf.data();
-                while (blockPoints--)
-                {
-                    PointId id = view->size();
-                    PointRef point = view->point(id);
-                    loadPoint(point, pos, pointLen);
-                    if (m_cb)
-                        m_cb(*view, id);
-                    pos += pointLen;
-                    i++;
-                }
-            } while (remaining);
+            std::copy(record, record + pointLen, out);
+            out += pointLen;
         }
-        catch (std::out_of_range&)
-        {}
-        catch (invalid_stream&)
-        {}
     }
-    m_index += i;
-    return (point_count_t)i;
+    buf = m_queryBuf.data();
+    return (point_count_t)((out - buf) / pointLen);
+}
+
+
+// X, Y and Z are the first three fields of every point format.
+bool LasReader::inQuery(const char *record) const
+{
+    int32_t xi;
+    int32_t yi;
+    memcpy(&xi, record, sizeof(xi));
+    memcpy(&yi, record + sizeof(xi), sizeof(yi));
+    double x = (int32_t)le32toh((uint32_t)xi) * m_lasHeader.scaleX() +
+        m_lasHeader.offsetX();
+    double y = (int32_t)le32toh((uint32_t)yi) * m_lasHeader.scaleY() +
+        m_lasHeader.offsetY();
+
+    if (!m_queryBox.contains(x, y))
+        return false;
+    if (m_queryZ)
+    {
+        int32_t zi;
+        memcpy(&zi, record + 2 * sizeof(xi), sizeof(zi));
+        double z = (int32_t)le32toh((uint32_t)zi) * m_lasHeader.scaleZ() +
+            m_lasHeader.offsetZ();
+        if (z < m_queryMinZ || z > m_queryMaxZ)
+            return false;
+    }
+    return !m_queryPolygon || m_queryPolygon->covers(x, y);
 }
 
 
@@ -736,6 +1263,27 @@ point_count_t LasReader::readFileBlock(std::vector<char>& buf,
 }
 
 
+#ifdef PDAL_HAVE_LAZPERF
+// Return point m_index from the chunks being decompressed in parallel.
+// Chunks that end before it are passed over.
+char *LasReader::nextChunkPoint()
+{
+    size_t pointSize = m_chunkDecompressor->pointSize();
+    while (!m_chunkPoints ||
+        m_index >= m_chunkStart + m_chunkPoints->size() / pointSize)
+    {
+        m_chunkPoints = m_chunkDecompressor->next();
+        if (!m_chunkPoints || m_chunkStarts.empty())
+            throw pdal_error("Compressed point data ended before the "
+                "number of points in the header was read.");
+        m_chunkStart = m_chunkStarts.front();
+        m_chunkStarts.pop_front();
+    }
+    return m_chunkPoints->data() + (m_index - m_chunkStart) * pointSize;
+}
+#endif
+
+
 void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
 {
     if (m_lasHeader.has14Format())
@@ -745,6 +1293,217 @@ void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
 }
 
 
+// When the table stores X, Y and Z with the file's scaling, the integers
+// from the file are stored without conversion.
+void LasReader::setXyz(PointRef& point, int32_t xi, int32_t yi, int32_t zi)
+{
+    if (m_rawXyz)
+    {
+        m_acc.x.setScaled(point, xi);
+        m_acc.y.setScaled(point, yi);
+        m_acc.z.setScaled(point, zi);
+        return;
+    }
+
+    const LasHeader& h = m_lasHeader;
+
+    m_acc.x.set(point, xi * h.scaleX() + h.offsetX());
+    m_acc.y.set(point, yi * h.scaleY() + h.offsetY());
+    m_acc.z.set(point, zi * h.scaleZ() + h.offsetZ());
+}
+
+
+namespace
+{
+
+// Uncompressed points are decoded this many at a time so that the decoded
+// columns stay in cache while they're stored.
+const point_count_t BatchSize = 4096;
+
+template<typename T>
+void setColumn(PointView& view, Dimension::Id::Enum dim, PointId first,
+    point_count_t count, const std::vector<T>& values)
+{
+    if (view.layout()->hasDim(dim))
+        view.setFieldArray(dim, first, count, values.data());
+}
+
+} // unnamed namespace
+
+
+// Append uncompressed records to a view.  Columns are stored in bulk
+// unless X, Y and Z are kept as the file's integers.
+void LasReader::loadPoints(PointView& view, char *buf, point_count_t count)
+{
+    using namespace Dimension;
+
+    const size_t pointLen = m_lasHeader.pointLen();
+    const size_t extraOffset = m_batchFormat.extraOffset();
+    const LasBatch::Columns& c = m_batch;
+    // A read callback must see each point as soon as it's stored, since the
+    // table may keep only the current point, so it rules out column loads.
+    const bool bulk = !m_rawXyz && !m_cb && view.layout()->hasDim(Id::X);
+
+    while (count)
+    {
+        point_count_t n = std::min(count, BatchSize);
+        decodeBatch(buf, n);
+
+        PointId first = view.size();
+        if (!bulk)
+        {
+            for (point_count_t i = 0; i < n; ++i)
+            {
+                PointRef point = view.point(first + i);
+                storeBatchPoint(point, i, buf + i * pointLen);
+                if (m_cb)
+                    m_cb(view, first + i);
+            }
+            buf += n * pointLen;
+            count -= n;
+            continue;
+        }
+
+        // X comes first, since setting it adds the points to the view.
+        setColumn(view, Id::X, first, n, c.x);
+        setColumn(view, Id::Y, first, n, c.y);
+        setColumn(view, Id::Z, first, n, c.z);
+        setColumn(view, Id::Intensity, first, n, c.intensity);
+        setColumn(view, Id::ReturnNumber, first, n, c.returnNum);
+        setColumn(view, Id::NumberOfReturns, first, n, c.numReturns);
+        if (m_batchFormat.m_v14)
+        {
+            setColumn(view, Id::ClassFlags, first, n, c.classFlags);
+            setColumn(view, Id::ScanChannel, first, n, c.scanChannel);
+        }
+        setColumn(view, Id::ScanDirectionFlag, first, n, c.scanDirFlag);
+        setColumn(view, Id::EdgeOfFlightLine, first, n, c.flight);
+        setColumn(view, Id::Classification, first, n, c.classification);
+        setColumn(view, Id::ScanAngleRank, first, n, c.scanAngle);
+        setColumn(view, Id::UserData, first, n, c.userData);
+        setColumn(view, Id::PointSourceId, first, n, c.pointSourceId);
+        if (m_batchFormat.m_hasTime)
+            setColumn(view, Id::GpsTime, first, n, c.gpsTime);
+        if (m_batchFormat.m_hasColor)
+        {
+            setColumn(view, Id::Red, first, n, c.red);
+            setColumn(view, Id::Green, first, n, c.green);
+            setColumn(view, Id::Blue, first, n, c.blue);
+        }
+        if (m_batchFormat.m_hasInfrared)
+            setColumn(view, Id::Infrared, first, n, c.infrared);
+
+        if (m_extraDims.size())
+        {
+            for (point_count_t i = 0; i < n; ++i)
+            {
+                PointRef point = view.point(first + i);
+                LeExtractor istream(buf + i * pointLen + extraOffset,
+                    pointLen - extraOffset);
+                loadExtraDims(istream, point);
+            }
+        }
+        buf += n * pointLen;
+        count -= n;
+    }
+}
+
+
+// Load uncompressed records into the points with the given IDs.
+void LasReader::loadPoints(PointRef& point, const PointId *ids, char *buf,
+    point_count_t count)
+{
+    const size_t pointLen = m_lasHeader.pointLen();
+
+    while (count)
+    {
+        point_count_t n = std::min(count, BatchSize);
+        decodeBatch(buf, n);
+        for (point_count_t i = 0; i < n; ++i)
+        {
+            point.setPointId(ids[i]);
+            storeBatchPoint(point, i, buf + i * pointLen);
+        }
+        ids += n;
+        buf += n * pointLen;
+        count -= n;
+    }
+}
+
+
+void LasReader::decodeBatch(char *buf, point_count_t count)
+{
+    LasBatch::decode(m_batchFormat, buf, count, m_batch, !m_rawXyz);
+
+    if (m_batchFormat.m_v14)
+        return;
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        uint8_t returnNum = m_batch.returnNum[i];
+        if (returnNum == 0 || returnNum > 5)
+            m_error.returnNumWarning(returnNum);
+
+        uint8_t numReturns = m_batch.numReturns[i];
+        if (numReturns == 0 || numReturns > 5)
+            m_error.numReturnsWarning(numReturns);
+    }
+}
+
+
+// Store point 'i' of the decoded batch.  'record' is the raw record, which
+// is only needed for extra bytes.
+void LasReader::storeBatchPoint(PointRef& point, point_count_t i,
+    char *record)
+{
+    const LasBatch::Columns& c = m_batch;
+
+    if (m_rawXyz)
+    {
+        m_acc.x.setScaled(point, c.xi[i]);
+        m_acc.y.setScaled(point, c.yi[i]);
+        m_acc.z.setScaled(point, c.zi[i]);
+    }
+    else
+    {
+        m_acc.x.set(point, c.x[i]);
+        m_acc.y.set(point, c.y[i]);
+        m_acc.z.set(point, c.z[i]);
+    }
+    m_acc.intensity.set(point, c.intensity[i]);
+    m_acc.returnNum.set(point, c.returnNum[i]);
+    m_acc.numReturns.set(point, c.numReturns[i]);
+    if (m_batchFormat.m_v14)
+    {
+        m_acc.classFlags.set(point, c.classFlags[i]);
+        m_acc.scanChannel.set(point, c.scanChannel[i]);
+    }
+    m_acc.scanDirFlag.set(point, c.scanDirFlag[i]);
+    m_acc.flight.set(point, c.flight[i]);
+    m_acc.classification.set(point, c.classification[i]);
+    m_acc.scanAngle.set(point, c.scanAngle[i]);
+    m_acc.userData.set(point, c.userData[i]);
+    m_acc.pointSourceId.set(point, c.pointSourceId[i]);
+    if (m_batchFormat.m_hasTime)
+        m_acc.gpsTime.set(point, c.gpsTime[i]);
+    if (m_batchFormat.m_hasColor)
+    {
+        m_acc.red.set(point, c.red[i]);
+        m_acc.green.set(point, c.green[i]);
+        m_acc.blue.set(point, c.blue[i]);
+    }
+    if (m_batchFormat.m_hasInfrared)
+        m_acc.infrared.set(point, c.infrared[i]);
+
+    if (m_extraDims.size())
+    {
+        const size_t offset = m_batchFormat.extraOffset();
+        LeExtractor istream(record + offset,
+            m_lasHeader.pointLen() - offset);
+        loadExtraDims(istream, point);
+    }
+}
+
+
 void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
@@ -754,10 +1513,6 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
 
     const LasHeader& h = m_lasHeader;
 
-    double x = xi * h.scaleX() + h.offsetX();
-    double y = yi * h.scaleY() + h.offsetY();
-    double z = zi * h.scaleZ() + h.offsetZ();
-
     uint16_t intensity;
     uint8_t flags;
     uint8_t classification;
@@ -779,33 +1534,31 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
     if (numReturns == 0 || numReturns > 5)
         m_error.numReturnsWarning(numReturns);
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, intensity);
-    point.setField(Dimension::Id::ReturnNumber, returnNum);
-    point.setField(Dimension::Id::NumberOfReturns, numReturns);
-    point.setField(Dimension::Id::ScanDirectionFlag, scanDirFlag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, flight);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, scanAngleRank);
-    point.setField(Dimension::Id::UserData, user);
-    point.setField(Dimension::Id::PointSourceId, pointSourceId);
+    setXyz(point, xi, yi, zi);
+    m_acc.intensity.set(point, intensity);
+    m_acc.returnNum.set(point, returnNum);
+    m_acc.numReturns.set(point, numReturns);
+    m_acc.scanDirFlag.set(point, scanDirFlag);
+    m_acc.flight.set(point, flight);
+    m_acc.classification.set(point, classification);
+    m_acc.scanAngle.set(point, scanAngleRank);
+    m_acc.userData.set(point, user);
+    m_acc.pointSourceId.set(point, pointSourceId);
 
     if (h.hasTime())
     {
         double time;
         istream >> time;
-        point.setField(Dimension::Id::GpsTime, time);
+        m_acc.gpsTime.set(point, time);
     }
 
     if (h.hasColor())
     {
         uint16_t red, green, blue;
         istream >> red >> green >> blue;
-        point.setField(Dimension::Id::Red, red);
-        point.setField(Dimension::Id::Green, green);
-        point.setField(Dimension::Id::Blue, blue);
+        m_acc.red.set(point, red);
+        m_acc.green.set(point, green);
+        m_acc.blue.set(point, blue);
     }
 
     if (m_extraDims.size())
@@ -822,10 +1575,6 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
 
     const LasHeader& h = m_lasHeader;
 
-    double x = xi * h.scaleX() + h.offsetX();
-    double y = yi * h.scaleY() + h.offsetY();
-    double z = zi * h.scaleZ() + h.offsetZ();
-
     uint16_t intensity;
     uint8_t returnInfo;
     uint8_t flags;
@@ -845,29 +1594,27 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
     uint8_t scanDirFlag = (flags >> 6) & 0x01;
     uint8_t flight = (flags >> 7) & 0x01;
 
-    point.setField(Dimension::Id::X, x);
-    point.setField(Dimension::Id::Y, y);
-    point.setField(Dimension::Id::Z, z);
-    point.setField(Dimension::Id::Intensity, intensity);
-    point.setField(Dimension::Id::ReturnNumber, returnNum);
-    point.setField(Dimension::Id::NumberOfReturns, numReturns);
-    point.setField(Dimension::Id::ClassFlags, classFlags);
-    point.setField(Dimension::Id::ScanChannel, scanChannel);
-    point.setField(Dimension::Id::ScanDirectionFlag, scanDirFlag);
-    point.setField(Dimension::Id::EdgeOfFlightLine, flight);
-    point.setField(Dimension::Id::Classification, classification);
-    point.setField(Dimension::Id::ScanAngleRank, scanAngle * .006);
-    point.setField(Dimension::Id::UserData, user);
-    point.setField(Dimension::Id::PointSourceId, pointSourceId);
-    point.setField(Dimension::Id::GpsTime, gpsTime);
+    setXyz(point, xi, yi, zi);
+    m_acc.intensity.set(point, intensity);
+    m_acc.returnNum.set(point, returnNum);
+    m_acc.numReturns.set(point, numReturns);
+    m_acc.classFlags.set(point, classFlags);
+    m_acc.scanChannel.set(point, scanChannel);
+    m_acc.scanDirFlag.set(point, scanDirFlag);
+    m_acc.flight.set(point, flight);
+    m_acc.classification.set(point, classification);
+    m_acc.scanAngle.set(point, scanAngle * .006);
+    m_acc.userData.set(point, user);
+    m_acc.pointSourceId.set(point, pointSourceId);
+    m_acc.gpsTime.set(point, gpsTime);
 
     if (h.hasColor())
     {
         uint16_t red, green, blue;
         istream >> red >> green >> blue;
-        point.setField(Dimension::Id::Red, red);
-        point.setField(Dimension::Id::Green, green);
-        point.setField(Dimension::Id::Blue, blue);
+        m_acc.red.set(point, red);
+        m_acc.green.set(point, green);
+        m_acc.blue.set(point, blue);
     }
 
     if (h.hasInfrared())
@@ -875,7 +1622,7 @@ void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
         uint16_t nearInfraRed;
 
         istream >> nearInfraRed;
-        point.setField(Dimension::Id::Infrared, nearInfraRed);
+        m_acc.infrared.set(point, nearInfraRed);
     }
 
     if (m_extraDims.size())
@@ -887,8 +1634,10 @@ void LasReader::loadExtraDims(LeExtractor& istream, PointRef& point)
 {
     for (auto& dim : m_extraDims)
     {
-        // Dimension type of None is undefined and unprocessed
-        if (dim.m_dimType.m_type == Dimension::Type::None)
+        // Dimension type of None is undefined and unprocessed.  Dimensions
+        // that the pipeline doesn't use have been removed from the layout.
+        if (dim.m_dimType.m_type == Dimension::Type::None ||
+            !point.hasDim(dim.m_dimType.m_id))
         {
             istream.skip(dim.m_size);
             continue;
@@ -910,10 +1659,28 @@ void LasReader::loadExtraDims(LeExtractor& istream, PointRef& point)
 
 void LasReader::done(PointTableRef)
 {
+    if (m_map.addr())
+    {
+        addBytesRead(m_lasHeader.pointOffset() +
+            (uint64_t)m_index * m_lasHeader.pointLen());
+        m_map = FileUtils::unmapFile(m_map);
+    }
+    // Reading may have stopped at the end of the file, which sets the
+    // stream's failure bits and makes tellg() fail.
+    else if (m_istream)
+    {
+        m_istream->clear();
+        std::streamoff pos = m_istream->tellg();
+        if (pos > 0)
+            addBytesRead(pos);
+    }
 #ifdef PDAL_HAVE_LASZIP
     m_zipPoint.reset();
     m_unzipper.reset();
 #endif
+    // The chunk decompressor holds a reference to the stream.
+    m_chunkDecompressor.reset();
+    m_chunkPoints = NULL;
     destroyStream();
     // Reset stream to NULL because destroyStream is virtual and can't reset
     // m_istream.
@@ -36,10 +36,15 @@
 
 #include <pdal/pdal_export.hpp>
 #include <pdal/Compression.hpp>
+#include <pdal/Polygon.hpp>
 #include <pdal/Reader.hpp>
 
+#include <deque>
+
+#include "LasBatch.hpp"
 #include "LasError.hpp"
 #include "LasHeader.hpp"
+#include "LasIndex.hpp"
 #include "LasUtils.hpp"
 #include "ZipPoint.hpp"
 
@@ -58,7 +63,9 @@ class PDAL_DLL LasReader : public pdal::Reader
 {
     friend class NitfReader;
 public:
-    LasReader() : pdal::Reader(), m_index(0), m_istream(NULL)
+    LasReader() : pdal::Reader(), m_chunkPoints(NULL), m_chunkStart(0),
+        m_index(0), m_start(0), m_end(0), m_istream(NULL), m_scaledXyz(false),
+        m_rawXyz(false), m_query(false)
         {}
 
     virtual ~LasReader()
@@ -92,6 +99,9 @@ protected:
         FileUtils::closeFile(m_istream);
         m_istream = NULL;
     }
+    // Position of the LAS data in the file named by m_filename.
+    virtual uint64_t dataOffset() const
+        { return 0; }
 
 private:
     LasError m_error;
@@ -100,17 +110,75 @@ private:
     std::unique_ptr<LASunzipper> m_unzipper;
     std::unique_ptr<LazPerfVlrDecompressor> m_decompressor;
     std::vector<char> m_decompressorBuf;
+    // Chunks of a LAZ file decompressed in parallel, the chunk being read
+    // and the index of its first point, and the first points of the chunks
+    // still to come.
+    std::unique_ptr<LazPerfChunkDecompressor> m_chunkDecompressor;
+    std::vector<char> *m_chunkPoints;
+    point_count_t m_chunkStart;
+    std::deque<point_count_t> m_chunkStarts;
+    std::vector<char> m_batchBuf;
+    std::vector<char> m_queryBuf;
+    // Points in [m_index, m_end) are being read.  Later runs of points to
+    // read are in m_ranges.
     point_count_t m_index;
+    point_count_t m_start;
+    point_count_t m_end;
+    std::deque<LasIndex::Interval> m_ranges;
     std::istream* m_istream;
+    FileUtils::MapContext m_map;
     VlrList m_vlrs;
     std::vector<ExtraDim> m_extraDims;
     std::string m_compression;
+    // Whether X, Y and Z are stored in the table as scaled integers.
+    bool m_scaledXyz;
+    // Whether the stored X, Y and Z use the file's scaling, so the
+    // integers in the file can be stored as-is.
+    bool m_rawXyz;
+    // Area of interest.  m_queryBox is the bounds option if given, otherwise
+    // the extent of m_queryPolygon.  The index only covers X and Y, so a Z
+    // range from 3D bounds is only checked against each point.
+    bool m_query;
+    BOX2D m_queryBox;
+    bool m_queryZ;
+    double m_queryMinZ;
+    double m_queryMaxZ;
+    std::unique_ptr<Polygon> m_queryPolygon;
+    std::string m_indexFilename;
+    // Format and scratch columns for decoding uncompressed points in bulk.
+    LasBatch::Format m_batchFormat;
+    LasBatch::Columns m_batch;
+
+    // Accessors for the standard LAS dimensions, bound in ready().
+    struct Accessors
+    {
+        DimAccessor<double> x;
+        DimAccessor<double> y;
+        DimAccessor<double> z;
+        DimAccessor<uint16_t> intensity;
+        DimAccessor<uint8_t> returnNum;
+        DimAccessor<uint8_t> numReturns;
+        DimAccessor<uint8_t> classFlags;
+        DimAccessor<uint8_t> scanChannel;
+        DimAccessor<uint8_t> scanDirFlag;
+        DimAccessor<uint8_t> flight;
+        DimAccessor<uint8_t> classification;
+        DimAccessor<double> scanAngle;
+        DimAccessor<uint8_t> userData;
+        DimAccessor<uint16_t> pointSourceId;
+        DimAccessor<double> gpsTime;
+        DimAccessor<uint16_t> red;
+        DimAccessor<uint16_t> green;
+        DimAccessor<uint16_t> blue;
+        DimAccessor<uint16_t> infrared;
+    } m_acc;
 
     virtual void processOptions(const Options& options);
     virtual void initialize(PointTableRef table)
         { initializeLocal(table, m_metadata); }
     virtual void initializeLocal(PointTableRef table, MetadataNode& m);
     virtual void addDimensions(PointLayoutPtr layout);
+    virtual Dimension::IdList initializedDims() const;
     VariableLengthRecord *findVlr(const std::string& userId, uint16_t recordId);
     void setSrsFromVlrs(MetadataNode& m);
     void readExtraBytesVlr();
@@ -122,11 +190,33 @@ private:
     virtual QuickInfo inspect();
     virtual void ready(PointTableRef table);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual bool processBatch(PointRange& range, SelectionVector& sel);
     virtual void done(PointTableRef table);
     virtual bool eof()
-        { return m_index >= getNumPoints(); }
+        { return m_index >= m_end && m_ranges.empty(); }
     void loadPoint(PointRef& point, char *buf, size_t bufsize);
+    void loadPoints(PointView& view, char *buf, point_count_t count);
+    void loadPoints(PointRef& point, const PointId *ids, char *buf,
+        point_count_t count);
+    void decodeBatch(char *buf, point_count_t count);
+    void storeBatchPoint(PointRef& point, point_count_t i, char *record);
+    char *nextChunkPoint();
+    void readyUncompressed();
+    char *mappedPoint() const;
+    void selectRanges();
+    bool indexRanges(LasIndex::IntervalList& intervals);
+    bool chunkRanges(LasIndex::IntervalList& intervals);
+    void clipRanges(point_count_t numPoints);
+    bool nextRange();
+    void seekPoint(point_count_t index);
+    char *nextRecord();
+    point_count_t readRecords(point_count_t count, char *& buf);
+    point_count_t selectRecords(char *& buf, point_count_t count);
+    bool inQuery(const char *record) const;
+    void setXyz(PointRef& point, int32_t xi, int32_t yi, int32_t zi);
     void loadPointV10(PointRef& point, char *buf, size_t bufsize);
     void loadPointV14(PointRef& point, char *buf, size_t bufsize);
     void loadExtraDims(LeExtractor& istream, PointRef& data);
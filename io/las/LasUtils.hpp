@@ -52,6 +52,19 @@ enum Enum
 
 }
 
+namespace LasSpatialOrder
+{
+
+// Curve along which writers.las orders points.
+enum Enum
+{
+    None,
+    Morton,
+    Hilbert
+};
+
+}
+
 struct ExtraDim
 {
     ExtraDim(const std::string name, Dimension::Type::Enum type,
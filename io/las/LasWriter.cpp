@@ -34,6 +34,7 @@
 
 #include "LasWriter.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include <pdal/Compression.hpp>
@@ -43,6 +44,7 @@
 #include <pdal/util/Inserter.hpp>
 #include <pdal/util/OStream.hpp>
 #include <pdal/util/Utils.hpp>
+#include <pdal/util/portable_endian.hpp>
 
 #include "GeotiffSupport.hpp"
 #include "ZipPoint.hpp"
@@ -59,9 +61,71 @@ static PluginInfo const s_info = PluginInfo(
 
 CREATE_STATIC_PLUGIN(1, 0, LasWriter, Writer, s_info)
 
+namespace
+{
+
+// Points are grouped for their bounds in chunks the size of those used by
+// LASzip and LAZperf, so that a reader can skip compressed chunks whole.
+const point_count_t ChunkBoundsSize = 50000;
+
+// Spread the bits of a 32-bit value to the even bits of a 64-bit value.
+uint64_t spreadBits(uint32_t v)
+{
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+uint64_t mortonKey(uint32_t x, uint32_t y)
+{
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+// Distance along a Hilbert curve filling a 2^32 by 2^32 grid.  At each
+// level the quadrant is added to the distance and the coordinates are
+// rotated into the frame of the curve within that quadrant.
+uint64_t hilbertKey(uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 31; s; s >>= 1)
+    {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = ~x;
+                y = ~y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Map a value in [min, min + range] to [0, 2^32 - 1].
+uint32_t gridPos(double v, double min, double range)
+{
+    if (!(range > 0))
+        return 0;
+    double pos = (v - min) / range * 4294967295.0;
+    if (!(pos > 0))
+        return 0;
+    return pos >= 4294967295.0 ? 4294967295u : (uint32_t)pos;
+}
+
+} // unnamed namespace
+
 std::string LasWriter::getName() const { return s_info.name; }
 
-LasWriter::LasWriter() : m_ostream(NULL), m_compression(LasCompression::None)
+LasWriter::LasWriter() : m_ostream(NULL), m_compression(LasCompression::None),
+    m_spatialOrder(LasSpatialOrder::None), m_chunkCount(0), m_rawXyz(false)
 {
     m_majorVersion.setDefault(1);
     m_minorVersion.setDefault(2);
@@ -116,6 +180,9 @@ Options LasWriter::getDefaultOptions()
     options.add("creation_year", year, "4-digit year value for file");
     options.add("extra_dims", "", "Extra dimensions not part of the LAS "
         "point format to be added to each point.");
+    options.add("spatial_order", "none", "Order points along a "
+        "space-filling curve ('morton' or 'hilbert') and record the bounds "
+        "of each chunk of points.");
 
     return options;
 }
@@ -148,6 +215,23 @@ void LasWriter::processOptions(const Options& options)
     StringList extraDims = options.getValueOrDefault<StringList>("extra_dims");
     m_extraDims = LasUtils::parse(extraDims);
 
+    std::string order = Utils::toupper(
+        options.getValueOrDefault<std::string>("spatial_order", "none"));
+    if (order == "NONE")
+        m_spatialOrder = LasSpatialOrder::None;
+    else if (order == "MORTON")
+        m_spatialOrder = LasSpatialOrder::Morton;
+    else if (order == "HILBERT")
+        m_spatialOrder = LasSpatialOrder::Hilbert;
+    else
+    {
+        std::ostringstream oss;
+        oss << "Invalid value for option 'spatial_order': '" <<
+            options.getValueOrDefault<std::string>("spatial_order") <<
+            "'.  Valid values are 'none', 'morton' and 'hilbert'.";
+        throw pdal_error(oss.str());
+    }
+
     fillForwardList(options);
     getHeaderOptions(options);
 }
@@ -156,6 +240,9 @@ void LasWriter::processOptions(const Options& options)
 void LasWriter::prepared(PointTableRef table)
 {
     FlexWriter::validateFilename(table);
+    if (m_spatialOrder != LasSpatialOrder::None && !table.supportsView())
+        throw pdal_error(getName() + ": Can't order points spatially when "
+            "streaming.");
 
     PointLayoutPtr layout = table.layout();
 
@@ -190,6 +277,25 @@ void LasWriter::prepared(PointTableRef table)
 }
 
 
+// The point format may not be known until the header is filled, so claim
+// every standard LAS dimension.
+bool LasWriter::usedDims(PointLayoutPtr /*layout*/,
+    Dimension::IdList& dims) const
+{
+    using namespace Dimension;
+
+    Id::Enum lasDims[] { Id::Intensity, Id::ReturnNumber,
+        Id::NumberOfReturns, Id::ScanDirectionFlag, Id::EdgeOfFlightLine,
+        Id::Classification, Id::ScanAngleRank, Id::UserData,
+        Id::PointSourceId, Id::GpsTime, Id::Red, Id::Green, Id::Blue,
+        Id::ScanChannel, Id::ClassFlags, Id::Infrared };
+    dims.insert(dims.end(), std::begin(lasDims), std::end(lasDims));
+    for (auto& dim : m_extraDims)
+        dims.push_back(dim.m_dimType.m_id);
+    return true;
+}
+
+
 // Get header info from options and store in map for processing with
 // metadata.
 void LasWriter::fillForwardList(const Options &options)
@@ -289,6 +395,30 @@ void LasWriter::getHeaderOptions(const Options &options)
 
 void LasWriter::readyTable(PointTableRef table)
 {
+    using namespace Dimension;
+
+    PointLayoutPtr layout = table.layout();
+    m_acc.x.bind(layout, Id::X);
+    m_acc.y.bind(layout, Id::Y);
+    m_acc.z.bind(layout, Id::Z);
+    m_acc.intensity.bind(layout, Id::Intensity);
+    m_acc.returnNum.bind(layout, Id::ReturnNumber);
+    m_acc.numReturns.bind(layout, Id::NumberOfReturns);
+    m_acc.classFlags.bind(layout, Id::ClassFlags);
+    m_acc.scanChannel.bind(layout, Id::ScanChannel);
+    m_acc.scanDirFlag.bind(layout, Id::ScanDirectionFlag);
+    m_acc.flight.bind(layout, Id::EdgeOfFlightLine);
+    m_acc.classification.bind(layout, Id::Classification);
+    m_acc.scanAngle.bind(layout, Id::ScanAngleRank);
+    m_acc.scanAngleRank.bind(layout, Id::ScanAngleRank);
+    m_acc.userData.bind(layout, Id::UserData);
+    m_acc.pointSourceId.bind(layout, Id::PointSourceId);
+    m_acc.gpsTime.bind(layout, Id::GpsTime);
+    m_acc.red.bind(layout, Id::Red);
+    m_acc.green.bind(layout, Id::Green);
+    m_acc.blue.bind(layout, Id::Blue);
+    m_acc.infrared.bind(layout, Id::Infrared);
+
     m_forwardMetadata = table.privateMetadata("lasforward");
     setExtraBytesVlr();
 }
@@ -328,6 +458,18 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     setVlrsFromSpatialRef();
     setVlrsFromMetadata(m_forwardMetadata);
 
+    // Chunk bounds forwarded from the input wouldn't describe the points
+    // written here.
+    deleteVlr(PDAL_USER_ID, CHUNK_BOUNDS_RECORD_ID);
+    m_chunkBounds = LasChunkBounds();
+    m_chunkBox.clear();
+    m_chunkCount = 0;
+    if (m_spatialOrder != LasSpatialOrder::None &&
+        !m_lasHeader.versionAtLeast(1, 4))
+        log()->get(LogLevel::Warning) << getName() << ": Chunk bounds are "
+            "only written to LAS 1.4 files, as an extended VLR.  Points "
+            "will be ordered, but without chunk bounds.\n";
+
     m_summaryData.reset(new SummaryData());
     m_ostream = outStream;
     if (m_lasHeader.compressed())
@@ -359,6 +501,7 @@ void LasWriter::prepOutput(std::ostream *outStream, const SpatialReference& srs)
     // Set the point buffer size here in case we're using the streaming
     // interface.
     m_pointBuf.resize(m_lasHeader.pointLen());
+    setRawXyz();
 
     m_error.setLog(log());
 }
@@ -682,8 +825,16 @@ void LasWriter::readyLazPerfCompression()
     zipvlr.extract((char *)data.data());
     addVlr(LASZIP_USER_ID, LASZIP_RECORD_ID, "http://laszip.org", data);
 
-    m_compressor.reset(new LazPerfVlrCompressor(*m_ostream, schema,
-        zipvlr.chunk_size));
+    // Chunks are independent, so they can be compressed in parallel.
+    m_compressor.reset();
+    m_chunkCompressor.reset();
+    if (viewThreads() > 1)
+        m_chunkCompressor.reset(new LazPerfChunkCompressor(*m_ostream,
+            schema, zipvlr.chunk_size, viewThreads(), 2 * viewThreads(),
+            workerStats()));
+    else
+        m_compressor.reset(new LazPerfVlrCompressor(*m_ostream, schema,
+            zipvlr.chunk_size));
 #endif
 }
 
@@ -724,18 +875,55 @@ bool LasWriter::processOne(PointRef& point)
 }
 
 
+// Fill the point buffer with all the selected points and write them at once.
+bool LasWriter::processBatch(PointRange& range, SelectionVector& sel)
+{
+    size_t pointLen = m_lasHeader.pointLen();
+    if (m_pointBuf.size() < sel.size() * pointLen)
+        m_pointBuf.resize(sel.size() * pointLen);
+
+    LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
+    range.retain(sel, [this, &ostream](PointRef& point)
+        { return fillPointBuf(point, ostream); });
+
+    if (m_compression == LasCompression::LasZip)
+        writeLasZipBuf(m_pointBuf.data(), pointLen, sel.size());
+    else if (m_compression == LasCompression::LazPerf)
+        writeLazPerfBuf(m_pointBuf.data(), pointLen, sel.size());
+    else
+        m_ostream->write(m_pointBuf.data(), sel.size() * pointLen);
+    return true;
+}
+
+
+// X, Y and Z can be copied from the table without conversion if they're
+// stored with the same scaling as the output.
+void LasWriter::setRawXyz()
+{
+    m_rawXyz = m_acc.x.scaledAs(m_xXform) && m_acc.y.scaledAs(m_yXform) &&
+        m_acc.z.scaledAs(m_zXform);
+}
+
+
 void LasWriter::writeView(const PointViewPtr view)
 {
     Utils::writeProgress(m_progressFd, "READYVIEW",
         std::to_string(view->size()));
     setAutoXForm(view);
+    setRawXyz();
 
     size_t pointLen = m_lasHeader.pointLen();
 
     // Make a buffer of at most a meg.
     m_pointBuf.resize(std::min((size_t)1000000, pointLen * view->size()));
 
-    const PointView& viewRef(*view.get());
+    // The reordered view refers to the same points, so nothing is copied.
+    PointViewPtr ordered = view;
+    if (m_spatialOrder != LasSpatialOrder::None)
+        ordered = spatialOrder(*view);
+    const PointView& viewRef(*ordered.get());
+    bool chunkBounds = m_spatialOrder != LasSpatialOrder::None &&
+        m_lasHeader.versionAtLeast(1, 4);
 
     point_count_t remaining = view->size();
     PointId idx = 0;
@@ -744,6 +932,8 @@ void LasWriter::writeView(const PointViewPtr view)
         point_count_t filled = fillWriteBuf(viewRef, idx, m_pointBuf);
         idx += filled;
         remaining -= filled;
+        if (chunkBounds)
+            addChunkBounds(m_pointBuf.data(), pointLen, filled);
 
         if (m_compression == LasCompression::LasZip)
             writeLasZipBuf(m_pointBuf.data(), pointLen, filled);
@@ -757,6 +947,87 @@ void LasWriter::writeView(const PointViewPtr view)
 }
 
 
+// Return a view of the points of 'view' ordered along a space-filling
+// curve over their XY extent.  Ties keep their original order.
+PointViewPtr LasWriter::spatialOrder(const PointView& view) const
+{
+    point_count_t count = view.size();
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    view.getFieldArray(Dimension::Id::X, 0, count, x.data());
+    view.getFieldArray(Dimension::Id::Y, 0, count, y.data());
+
+    BOX2D bounds;
+    for (point_count_t i = 0; i < count; ++i)
+        bounds.grow(x[i], y[i]);
+    double xrange = bounds.maxx - bounds.minx;
+    double yrange = bounds.maxy - bounds.miny;
+
+    std::vector<std::pair<uint64_t, PointId>> keys(count);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        uint32_t gx = gridPos(x[i], bounds.minx, xrange);
+        uint32_t gy = gridPos(y[i], bounds.miny, yrange);
+        uint64_t key = (m_spatialOrder == LasSpatialOrder::Hilbert) ?
+            hilbertKey(gx, gy) : mortonKey(gx, gy);
+        keys[i] = std::make_pair(key, (PointId)i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<PointId> ids(count);
+    for (point_count_t i = 0; i < count; ++i)
+        ids[i] = keys[i].second;
+    return view.select(ids);
+}
+
+
+// Grow the bounds of the chunk being written with the points just encoded.
+// The bounds are taken from the encoded values, so they're exactly what a
+// reader will see.
+void LasWriter::addChunkBounds(const char *buf, size_t pointLen,
+    point_count_t numPts)
+{
+    for (point_count_t i = 0; i < numPts; ++i)
+    {
+        int32_t xyz[3];
+        memcpy(xyz, buf, sizeof(xyz));
+        double x = (int32_t)le32toh((uint32_t)xyz[0]) * m_xXform.m_scale +
+            m_xXform.m_offset;
+        double y = (int32_t)le32toh((uint32_t)xyz[1]) * m_yXform.m_scale +
+            m_yXform.m_offset;
+        double z = (int32_t)le32toh((uint32_t)xyz[2]) * m_zXform.m_scale +
+            m_zXform.m_offset;
+        m_chunkBox.grow(x, y, z);
+        if (++m_chunkCount == ChunkBoundsSize)
+        {
+            m_chunkBounds.add(m_chunkCount, m_chunkBox);
+            m_chunkBox.clear();
+            m_chunkCount = 0;
+        }
+        buf += pointLen;
+    }
+}
+
+
+// Chunk bounds are only known once the points are written, so they're
+// stored in an extended VLR, after the points.
+void LasWriter::addChunkBoundsVlr()
+{
+    if (m_chunkCount)
+    {
+        m_chunkBounds.add(m_chunkCount, m_chunkBox);
+        m_chunkBox.clear();
+        m_chunkCount = 0;
+    }
+    if (m_chunkBounds.chunks().empty())
+        return;
+
+    std::vector<uint8_t> data = m_chunkBounds.data();
+    m_eVlrs.push_back(ExtVariableLengthRecord(PDAL_USER_ID,
+        CHUNK_BOUNDS_RECORD_ID, "Chunk bounds", data));
+}
+
+
 void LasWriter::writeLasZipBuf(char *pos, size_t pointLen, point_count_t numPts)
 {
 #ifdef PDAL_HAVE_LASZIP
@@ -782,6 +1053,11 @@ void LasWriter::writeLazPerfBuf(char *pos, size_t pointLen,
     point_count_t numPts)
 {
 #ifdef PDAL_HAVE_LAZPERF
+    if (m_chunkCompressor)
+    {
+        m_chunkCompressor->compress(pos, numPts);
+        return;
+    }
     for (point_count_t i = 0; i < numPts; i++)
     {
         m_compressor->compress(pos);
@@ -806,12 +1082,12 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
     uint8_t numberOfReturns(1);
     if (point.hasDim(Id::ReturnNumber))
     {
-        returnNumber = point.getFieldAs<uint8_t>(Id::ReturnNumber);
+        returnNumber = m_acc.returnNum.get(point);
         if (returnNumber < 1 || returnNumber > maxReturnCount)
             m_error.returnNumWarning(returnNumber);
     }
     if (point.hasDim(Id::NumberOfReturns))
-        numberOfReturns = point.getFieldAs<uint8_t>(Id::NumberOfReturns);
+        numberOfReturns = m_acc.numReturns.get(point);
     if (numberOfReturns == 0)
         m_error.numReturnsWarning(0);
     if (numberOfReturns > maxReturnCount)
@@ -827,47 +1103,42 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
             m_error.numReturnsWarning(numberOfReturns);
     }
 
-    double xOrig = point.getFieldAs<double>(Id::X);
-    double yOrig = point.getFieldAs<double>(Id::Y);
-    double zOrig = point.getFieldAs<double>(Id::Z);
-
-    double x = (xOrig - m_xXform.m_offset) / m_xXform.m_scale;
-    double y = (yOrig - m_yXform.m_offset) / m_yXform.m_scale;
-    double z = (zOrig - m_zXform.m_offset) / m_zXform.m_scale;
-
-    auto converter = [this](double d, Dimension::Id::Enum dim) -> int32_t
+    double xOrig, yOrig, zOrig;
+    if (m_rawXyz)
     {
-        int32_t i;
-
-        if (!Utils::numericCast(d, i))
-        {
-            std::ostringstream oss;
-            oss << "Unable to convert scaled value (" << d << ") to "
-                "int32 for dimension '" << Dimension::name(dim) <<
-                "' when writing LAS/LAZ file " << m_curFilename << ".";
-            throw pdal_error(oss.str());
-        }
-        return i;
-    };
+        // The table already holds X, Y and Z with the output scaling.
+        int32_t xi = m_acc.x.getScaled(point);
+        int32_t yi = m_acc.y.getScaled(point);
+        int32_t zi = m_acc.z.getScaled(point);
+        ostream << xi << yi << zi;
+
+        xOrig = m_xXform.fromScaled(xi);
+        yOrig = m_yXform.fromScaled(yi);
+        zOrig = m_zXform.fromScaled(zi);
+    }
+    else
+    {
+        xOrig = m_acc.x.get(point);
+        yOrig = m_acc.y.get(point);
+        zOrig = m_acc.z.get(point);
 
-    ostream << converter(x, Id::X);
-    ostream << converter(y, Id::Y);
-    ostream << converter(z, Id::Z);
+        ostream << scaledInt(m_xXform.toScaled(xOrig), Id::X);
+        ostream << scaledInt(m_yXform.toScaled(yOrig), Id::Y);
+        ostream << scaledInt(m_zXform.toScaled(zOrig), Id::Z);
+    }
 
-    ostream << point.getFieldAs<uint16_t>(Id::Intensity);
+    ostream << m_acc.intensity.get(point);
 
-    uint8_t scanChannel = point.getFieldAs<uint8_t>(Id::ScanChannel);
-    uint8_t scanDirectionFlag =
-        point.getFieldAs<uint8_t>(Id::ScanDirectionFlag);
-    uint8_t edgeOfFlightLine =
-        point.getFieldAs<uint8_t>(Id::EdgeOfFlightLine);
+    uint8_t scanChannel = m_acc.scanChannel.get(point);
+    uint8_t scanDirectionFlag = m_acc.scanDirFlag.get(point);
+    uint8_t edgeOfFlightLine = m_acc.flight.get(point);
 
     if (has14Format)
     {
         uint8_t bits = returnNumber | (numberOfReturns << 4);
         ostream << bits;
 
-        uint8_t classFlags = point.getFieldAs<uint8_t>(Id::ClassFlags);
+        uint8_t classFlags = m_acc.classFlags.get(point);
         bits = (classFlags & 0x0F) |
             ((scanChannel & 0x03) << 4) |
             ((scanDirectionFlag & 0x01) << 6) |
@@ -881,45 +1152,66 @@ bool LasWriter::fillPointBuf(PointRef& point, LeInserter& ostream)
         ostream << bits;
     }
 
-    ostream << point.getFieldAs<uint8_t>(Id::Classification);
+    ostream << m_acc.classification.get(point);
 
-    uint8_t userData = point.getFieldAs<uint8_t>(Id::UserData);
+    uint8_t userData = m_acc.userData.get(point);
     if (has14Format)
     {
-         int16_t scanAngleRank =
-             point.getFieldAs<float>(Id::ScanAngleRank) / .006;
+         int16_t scanAngleRank = m_acc.scanAngle.get(point) / .006;
          ostream << userData << scanAngleRank;
     }
     else
     {
-        int8_t scanAngleRank = point.getFieldAs<int8_t>(Id::ScanAngleRank);
+        int8_t scanAngleRank = m_acc.scanAngleRank.get(point);
         ostream << scanAngleRank << userData;
     }
 
-    ostream << point.getFieldAs<uint16_t>(Id::PointSourceId);
+    ostream << m_acc.pointSourceId.get(point);
 
     if (hasTime)
-        ostream << point.getFieldAs<double>(Id::GpsTime);
+        ostream << m_acc.gpsTime.get(point);
 
     if (hasColor)
     {
-        ostream << point.getFieldAs<uint16_t>(Id::Red);
-        ostream << point.getFieldAs<uint16_t>(Id::Green);
-        ostream << point.getFieldAs<uint16_t>(Id::Blue);
+        ostream << m_acc.red.get(point);
+        ostream << m_acc.green.get(point);
+        ostream << m_acc.blue.get(point);
     }
 
     if (hasInfrared)
-        ostream << point.getFieldAs<uint16_t>(Id::Infrared);
+        ostream << m_acc.infrared.get(point);
+
+    writeExtraDims(point, ostream);
+
+    m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
+    return true;
+}
+
+
+int32_t LasWriter::scaledInt(double d, Dimension::Id::Enum dim) const
+{
+    int32_t i;
+
+    if (!Utils::numericCast(d, i))
+    {
+        std::ostringstream oss;
+        oss << "Unable to convert scaled value (" << d << ") to "
+            "int32 for dimension '" << Dimension::name(dim) <<
+            "' when writing LAS/LAZ file " << m_curFilename << ".";
+        throw pdal_error(oss.str());
+    }
+    return i;
+}
 
+
+void LasWriter::writeExtraDims(PointRef& point, LeInserter& ostream)
+{
     Everything e;
     for (auto& dim : m_extraDims)
     {
         point.getField((char *)&e, dim.m_dimType.m_id, dim.m_dimType.m_type);
         Utils::insertDim(ostream, dim.m_dimType.m_type, e);
     }
-
-    m_summaryData->addPoint(xOrig, yOrig, zOrig, returnNumber);
-    return true;
 }
 
 
@@ -930,6 +1222,14 @@ point_count_t LasWriter::fillWriteBuf(const PointView& view,
     blocksize = std::min(blocksize, view.size() - startId);
     PointId lastId = startId + blocksize;
 
+    // The bulk encoder writes every point, so it can't be used when points
+    // with high return numbers are to be dropped.
+    if (!m_discardHighReturnNumbers)
+    {
+        encodeBatch(view, startId, blocksize, buf.data());
+        return blocksize;
+    }
+
     LeInserter ostream(buf.data(), buf.size());
     PointRef point = (const_cast<PointView&>(view)).point(0);
     for (PointId idx = startId; idx < lastId; idx++)
@@ -941,6 +1241,143 @@ point_count_t LasWriter::fillWriteBuf(const PointView& view,
 }
 
 
+namespace
+{
+
+// Fetch a dimension for a range of points, or use a default if the
+// table doesn't have it.
+template<typename T>
+void getColumn(const PointView& view, Dimension::Id::Enum dim,
+    PointId first, point_count_t count, std::vector<T>& values, T def = 0)
+{
+    values.resize(count);
+    if (view.layout()->hasDim(dim))
+        view.getFieldArray(dim, first, count, values.data());
+    else
+        std::fill(values.begin(), values.end(), def);
+}
+
+} // unnamed namespace
+
+
+// Encode the points of a view in bulk.  The checks and summary data are
+// the same as those of fillPointBuf().
+void LasWriter::encodeBatch(const PointView& view, PointId first,
+    point_count_t count, char *buf)
+{
+    using namespace Dimension;
+
+    const LasBatch::Format format(m_lasHeader);
+    LasBatch::Columns& c = m_batch;
+    c.resize(format, count);
+
+    if (m_rawXyz)
+    {
+        PointRef point = (const_cast<PointView&>(view)).point(0);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            point.setPointId(first + i);
+            c.xi[i] = m_acc.x.getScaled(point);
+            c.yi[i] = m_acc.y.getScaled(point);
+            c.zi[i] = m_acc.z.getScaled(point);
+        }
+        LasBatch::fromScaled(m_xXform, c.xi.data(), count, c.x.data());
+        LasBatch::fromScaled(m_yXform, c.yi.data(), count, c.y.data());
+        LasBatch::fromScaled(m_zXform, c.zi.data(), count, c.z.data());
+    }
+    else
+    {
+        getColumn(view, Id::X, first, count, c.x);
+        getColumn(view, Id::Y, first, count, c.y);
+        getColumn(view, Id::Z, first, count, c.z);
+
+        // Find the value that doesn't fit, for the error message.
+        auto scale = [this, count](const XForm& xform,
+            const std::vector<double>& in, std::vector<int32_t>& out,
+            Id::Enum dim)
+        {
+            if (!LasBatch::toScaled(xform, in.data(), count, out.data()))
+                for (point_count_t i = 0; i < count; ++i)
+                    out[i] = scaledInt(xform.toScaled(in[i]), dim);
+        };
+        scale(m_xXform, c.x, c.xi, Id::X);
+        scale(m_yXform, c.y, c.yi, Id::Y);
+        scale(m_zXform, c.z, c.zi, Id::Z);
+    }
+
+    getColumn(view, Id::Intensity, first, count, c.intensity);
+    getColumn<uint8_t>(view, Id::ReturnNumber, first, count, c.returnNum, 1);
+    getColumn<uint8_t>(view, Id::NumberOfReturns, first, count,
+        c.numReturns, 1);
+    if (format.m_v14)
+    {
+        getColumn(view, Id::ClassFlags, first, count, c.classFlags);
+        getColumn(view, Id::ScanChannel, first, count, c.scanChannel);
+    }
+    getColumn(view, Id::ScanDirectionFlag, first, count, c.scanDirFlag);
+    getColumn(view, Id::EdgeOfFlightLine, first, count, c.flight);
+    getColumn(view, Id::Classification, first, count, c.classification);
+    getColumn(view, Id::UserData, first, count, c.userData);
+    getColumn(view, Id::PointSourceId, first, count, c.pointSourceId);
+    if (format.m_hasTime)
+        getColumn(view, Id::GpsTime, first, count, c.gpsTime);
+    if (format.m_hasColor)
+    {
+        getColumn(view, Id::Red, first, count, c.red);
+        getColumn(view, Id::Green, first, count, c.green);
+        getColumn(view, Id::Blue, first, count, c.blue);
+    }
+    if (format.m_hasInfrared)
+        getColumn(view, Id::Infrared, first, count, c.infrared);
+
+    // The scan angle is fetched as the type each format stores.
+    if (format.m_v14)
+    {
+        std::vector<float> angle;
+        getColumn(view, Id::ScanAngleRank, first, count, angle);
+        std::copy(angle.begin(), angle.end(), c.scanAngle.begin());
+    }
+    else
+    {
+        std::vector<int8_t> angle;
+        getColumn(view, Id::ScanAngleRank, first, count, angle);
+        std::copy(angle.begin(), angle.end(), c.scanAngle.begin());
+    }
+
+    const size_t maxReturnCount = m_lasHeader.maxReturnCount();
+    const bool hasReturnNum = view.layout()->hasDim(Id::ReturnNumber);
+    for (point_count_t i = 0; i < count; ++i)
+    {
+        uint8_t returnNumber = c.returnNum[i];
+        uint8_t numberOfReturns = c.numReturns[i];
+        if (hasReturnNum &&
+            (returnNumber < 1 || returnNumber > maxReturnCount))
+            m_error.returnNumWarning(returnNumber);
+        if (numberOfReturns == 0)
+            m_error.numReturnsWarning(0);
+        if (numberOfReturns > maxReturnCount)
+            m_error.numReturnsWarning(numberOfReturns);
+        m_summaryData->addPoint(c.x[i], c.y[i], c.z[i], returnNumber);
+    }
+
+    LasBatch::encode(format, c, count, buf);
+
+    if (m_extraDims.size())
+    {
+        const size_t pointLen = format.m_pointLen;
+        const size_t offset = format.extraOffset();
+        PointRef point = (const_cast<PointView&>(view)).point(0);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            point.setPointId(first + i);
+            LeInserter ostream(buf + i * pointLen + offset,
+                pointLen - offset);
+            writeExtraDims(point, ostream);
+        }
+    }
+}
+
+
 void LasWriter::doneFile()
 {
     finishOutput();
@@ -964,12 +1401,22 @@ void LasWriter::finishOutput()
 
     OLeStream out(m_ostream);
 
+    addChunkBoundsVlr();
+    m_lasHeader.setEVlrCount(m_eVlrs.size());
+    if (m_eVlrs.size())
+        m_lasHeader.setEVlrOffset(m_ostream->tellp());
     for (auto vi = m_eVlrs.begin(); vi != m_eVlrs.end(); ++vi)
     {
         ExtVariableLengthRecord evlr = *vi;
         out << evlr;
     }
 
+    // Everything but the header has been written, so the position is the
+    // size of the file.
+    std::streamoff size = m_ostream->tellp();
+    if (size > 0)
+        addBytesWritten(size);
+
     // Reset the offset/scale since it may have been auto-computed
     m_lasHeader.setOffset(m_xXform.m_offset, m_yXform.m_offset,
         m_zXform.m_offset);
@@ -998,7 +1445,13 @@ void LasWriter::finishLasZipOutput()
 void LasWriter::finishLazPerfOutput()
 {
 #ifdef PDAL_HAVE_LAZPERF
-    m_compressor->done();
+    if (m_chunkCompressor)
+    {
+        m_chunkCompressor->done();
+        m_chunkCompressor.reset();
+    }
+    else
+        m_compressor->done();
 #endif
 }
 
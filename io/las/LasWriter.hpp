@@ -38,8 +38,10 @@
 #include <pdal/FlexWriter.hpp>
 
 #include "HeaderVal.hpp"
+#include "LasBatch.hpp"
 #include "LasError.hpp"
 #include "LasHeader.hpp"
+#include "LasIndex.hpp"
 #include "LasUtils.hpp"
 #include "SummaryData.hpp"
 #include "ZipPoint.hpp"
@@ -87,6 +89,7 @@ private:
     std::unique_ptr<LASzipper> m_zipper;
     std::unique_ptr<ZipPoint> m_zipPoint;
     std::unique_ptr<LazPerfVlrCompressor> m_compressor;
+    std::unique_ptr<LazPerfChunkCompressor> m_chunkCompressor;
     bool m_discardHighReturnNumbers;
     std::map<std::string, std::string> m_headerVals;
     std::vector<VlrOptionInfo> m_optionInfos;
@@ -101,6 +104,41 @@ private:
     bool m_forwardVlrs;
     LasCompression::Enum m_compression;
     std::vector<char> m_pointBuf;
+    LasSpatialOrder::Enum m_spatialOrder;
+    // Bounds of the chunks of points written so far, and of the points of
+    // the chunk being written.
+    LasChunkBounds m_chunkBounds;
+    BOX3D m_chunkBox;
+    point_count_t m_chunkCount;
+
+    // Accessors for the standard LAS dimensions, bound in readyTable().
+    struct Accessors
+    {
+        DimAccessor<double> x;
+        DimAccessor<double> y;
+        DimAccessor<double> z;
+        DimAccessor<uint16_t> intensity;
+        DimAccessor<uint8_t> returnNum;
+        DimAccessor<uint8_t> numReturns;
+        DimAccessor<uint8_t> classFlags;
+        DimAccessor<uint8_t> scanChannel;
+        DimAccessor<uint8_t> scanDirFlag;
+        DimAccessor<uint8_t> flight;
+        DimAccessor<uint8_t> classification;
+        DimAccessor<float> scanAngle;
+        DimAccessor<int8_t> scanAngleRank;
+        DimAccessor<uint8_t> userData;
+        DimAccessor<uint16_t> pointSourceId;
+        DimAccessor<double> gpsTime;
+        DimAccessor<uint16_t> red;
+        DimAccessor<uint16_t> green;
+        DimAccessor<uint16_t> blue;
+        DimAccessor<uint16_t> infrared;
+    } m_acc;
+    // Whether X, Y and Z are stored in the table with the output scaling.
+    bool m_rawXyz;
+    // Scratch columns for encoding points in bulk.
+    LasBatch::Columns m_batch;
 
     NumHeaderVal<uint8_t, 1, 1> m_majorVersion;
     NumHeaderVal<uint8_t, 1, 4> m_minorVersion;
@@ -126,11 +164,16 @@ private:
 
     virtual void processOptions(const Options& options);
     virtual void prepared(PointTableRef table);
+    virtual bool usedDims(PointLayoutPtr layout,
+        Dimension::IdList& dims) const;
     virtual void readyTable(PointTableRef table);
     virtual void readyFile(const std::string& filename,
         const SpatialReference& srs);
     virtual void writeView(const PointViewPtr view);
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
+    virtual bool processBatch(PointRange& range, SelectionVector& sel);
     virtual void doneFile();
 
     void fillForwardList(const Options& options);
@@ -140,9 +183,18 @@ private:
         const MetadataNode& base);
     void handleHeaderForwards(MetadataNode& forward);
     void fillHeader();
+    void setRawXyz();
+    PointViewPtr spatialOrder(const PointView& view) const;
+    void addChunkBounds(const char *buf, size_t pointLen,
+        point_count_t numPts);
+    void addChunkBoundsVlr();
     bool fillPointBuf(PointRef& point, LeInserter& ostream);
     point_count_t fillWriteBuf(const PointView& view, PointId startId,
         std::vector<char>& buf);
+    void encodeBatch(const PointView& view, PointId first,
+        point_count_t count, char *buf);
+    int32_t scaledInt(double d, Dimension::Id::Enum dim) const;
+    void writeExtraDims(PointRef& point, LeInserter& ostream);
     void writeLasZipBuf(char *data, size_t pointLen, point_count_t numPts);
     void writeLazPerfBuf(char *data, size_t pointLen, point_count_t numPts);
     void setVlrsFromMetadata(MetadataNode& forward);
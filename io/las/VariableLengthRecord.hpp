@@ -51,11 +51,13 @@ static const uint16_t GEOTIFF_DOUBLES_RECORD_ID = 34736;
 static const uint16_t GEOTIFF_ASCII_RECORD_ID = 34737;
 static const uint16_t LASZIP_RECORD_ID = 22204;
 static const uint16_t EXTRA_BYTES_RECORD_ID = 4;
+static const uint16_t CHUNK_BOUNDS_RECORD_ID = 100;
 
 static const char TRANSFORM_USER_ID[] = "LASF_Projection";
 static const char SPEC_USER_ID[] = "LASF_Spec";
 static const char LIBLAS_USER_ID[] = "liblas";
 static const char LASZIP_USER_ID[] = "laszip encoded";
+static const char PDAL_USER_ID[] = "PDAL";
 
 class VariableLengthRecord;
 typedef std::vector<VariableLengthRecord> VlrList;
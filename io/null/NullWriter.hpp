@@ -51,6 +51,13 @@ public:
     static int32_t destroy(void *);
     std::string getName() const;
 private:
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
+    virtual bool streamable() const
+        { return true; }
+    virtual bool processOne(PointRef& /*point*/)
+        { return true; }
     virtual void write(const PointViewPtr /*view*/)
         {}
 };
@@ -67,6 +67,8 @@ private:
     point_count_t m_index;
     Dimension::IdList m_dims;
 
+    virtual bool streamable() const
+        { return true; }
     virtual bool processOne(PointRef& point);
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
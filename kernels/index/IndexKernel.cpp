@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include "IndexKernel.hpp"
+
+#include <las/LasIndex.hpp>
+#include <las/LasReader.hpp>
+#include <streamcallback/StreamCallbackFilter.hpp>
+
+namespace pdal
+{
+
+static PluginInfo const s_info = PluginInfo(
+    "kernels.index",
+    "Index Kernel",
+    "http://pdal.io/apps.html#index-command" );
+
+CREATE_STATIC_PLUGIN(1, 0, IndexKernel, Kernel, s_info)
+
+std::string IndexKernel::getName() const
+{
+    return s_info.name;
+}
+
+
+IndexKernel::IndexKernel() : m_level(-1)
+{}
+
+
+void IndexKernel::addSwitches(ProgramArgs& args)
+{
+    args.add("input,i", "Input LAS/LAZ filename", m_inputFile).
+        setPositional();
+    args.add("output,o", "Index filename.  Defaults to the input filename "
+        "with '.pdx' appended", m_outputFile);
+    args.add("level", "Depth of the quadtree.  Chosen from the number of "
+        "points if not given", m_level, -1);
+}
+
+
+int IndexKernel::execute()
+{
+    if (m_outputFile.empty())
+        m_outputFile = LasIndex::defaultFilename(m_inputFile);
+
+    Options readerOptions;
+    readerOptions.add("filename", m_inputFile);
+    readerOptions.add("debug", isDebug());
+    readerOptions.add("verbose", getVerboseLevel());
+
+    LasReader reader;
+    reader.setOptions(readerOptions);
+
+    // Points are streamed, so files of any size can be indexed.
+    LasIndex index;
+    point_count_t count = 0;
+    StreamCallbackFilter filter;
+    filter.setCallback([&index, &count](PointRef& point)
+    {
+        index.add(count++, point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y));
+        return true;
+    });
+    filter.setInput(reader);
+
+    FixedPointTable table(10000);
+    filter.prepare(table);
+    // The extent of the grid is taken from the header.
+    index = LasIndex(reader.header().getBounds().to2d(),
+        reader.getNumPoints(), m_level);
+    index.setFileSize(FileUtils::fileSize(m_inputFile));
+    filter.execute(table);
+
+    index.finish();
+    index.write(m_outputFile);
+
+    if (getVerboseLevel())
+        std::cout << "Indexed " << count << " points in " <<
+            index.numCells() << " cells to '" << m_outputFile << "'." <<
+            std::endl;
+    return 0;
+}
+
+} // namespace pdal
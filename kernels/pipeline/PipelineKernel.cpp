@@ -40,6 +40,10 @@
 
 #include <pdal/PDALUtils.hpp>
 
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+
 namespace pdal
 {
 
@@ -52,7 +56,9 @@ CREATE_STATIC_PLUGIN(1, 0, PipelineKernel, Kernel, s_info)
 
 std::string PipelineKernel::getName() const { return s_info.name; }
 
-PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1)
+PipelineKernel::PipelineKernel() : m_validate(false), m_progressFd(-1),
+    m_scratchResident(0), m_memoryBudget(0), m_streamChunk(0),
+    m_streamDepth(0), m_stats(false)
 {}
 
 
@@ -78,6 +84,21 @@ void PipelineKernel::addSwitches(ProgramArgs& args)
         "information.  The file/FIFO must exist.  PDAL will not create "
         "the progress file.",
         m_progressFile);
+    args.add("scratch-dir", "Store points in a memory-mapped scratch file "
+        "in this directory rather than in memory", m_scratchDir);
+    args.add("scratch-resident", "With --scratch-dir, approximate number "
+        "of megabytes of point data to keep in memory", m_scratchResident);
+    args.add("memory-budget", "Approximate number of megabytes of point "
+        "data to keep in memory.  The pipeline is streamed if possible.  "
+        "Otherwise points beyond the budget are written to a scratch file "
+        "(see --scratch-dir)", m_memoryBudget);
+    args.add("stream-chunk", "When streaming, number of points passed "
+        "through a stage at a time", m_streamChunk);
+    args.add("stream-depth", "When streaming, number of chunks of points "
+        "in flight.  With more than one, stages run concurrently",
+        m_streamDepth);
+    args.add("stats", "Collect performance statistics for each stage and "
+        "print them when the pipeline completes", m_stats);
     args.add("pointcloudschema", "dump PointCloudSchema XML output",
         m_PointCloudSchemaOutput).setHidden();
 }
@@ -89,22 +110,59 @@ int PipelineKernel::execute()
     if (m_progressFile.size())
         m_progressFd = Utils::openProgress(m_progressFile);
 
-    pdal::PipelineManager manager(m_progressFd);
-    bool isWriter = manager.readPipeline(m_inputFile);
+    // Declared first so that it outlives the views held by the manager.
+    std::unique_ptr<BasePointTable> table;
+    PipelineManagerPtr manager(new PipelineManager(m_progressFd));
+    bool isWriter = manager->readPipeline(m_inputFile);
     if (!isWriter)
         throw app_runtime_error("Pipeline file does not contain a writer. "
             "Use 'pdal info' to read the data.");
 
-    applyExtraStageOptionsRecursive(manager.getStage());
-    manager.execute();
+    // With a memory budget, from the command line or the pipeline, the
+    // manager chooses how points are stored.
+    if (m_memoryBudget || manager->memoryBudget())
+    {
+        uint64_t budget = m_memoryBudget ?
+            m_memoryBudget * 1024 * 1024 : manager->memoryBudget();
+        std::string scratchDir = m_scratchDir.size() ?
+            m_scratchDir : manager->scratchDir();
+        manager->setMemoryBudget(budget, scratchDir);
+    }
+    else if (m_scratchDir.size())
+    {
+        table.reset(new MappedPointTable(m_scratchDir,
+            m_scratchResident * 1024 * 1024));
+        manager->setPointTable(*table);
+    }
+    manager->setStreamChunks(m_streamChunk, m_streamDepth);
+
+    applyExtraStageOptionsRecursive(manager->getStage());
+    if (m_stats)
+    {
+        Options statsOpts;
+        statsOpts.add("stats", true);
+        std::vector<Stage *> stages { manager->getStage() };
+        while (stages.size())
+        {
+            Stage *s = stages.back();
+            stages.pop_back();
+            s->removeOptions(statsOpts);
+            s->addOptions(statsOpts);
+            for (Stage *in : s->getInputs())
+                stages.push_back(in);
+        }
+    }
+    manager->execute();
+    if (m_stats)
+        printStats(manager->getStage());
 
     if (m_pipelineFile.size() > 0)
-        PipelineWriter::writePipeline(manager.getStage(), m_pipelineFile);
+        PipelineWriter::writePipeline(manager->getStage(), m_pipelineFile);
 
     if (m_PointCloudSchemaOutput.size() > 0)
     {
 #ifdef PDAL_HAVE_LIBXML2
-        XMLSchema schema(manager.pointTable().layout());
+        XMLSchema schema(manager->pointTable().layout());
         
         std::ostream *out = FileUtils::createFile(m_PointCloudSchemaOutput);
         std::string xml(schema.xml());
@@ -120,4 +178,42 @@ int PipelineKernel::execute()
     return 0;
 }
 
+
+// Print the statistics of each stage, inputs first.
+void PipelineKernel::printStats(Stage *stage)
+{
+    std::vector<Stage *> stages;
+    std::function<void(Stage *)> visit = [&stages, &visit](Stage *s)
+    {
+        if (std::find(stages.begin(), stages.end(), s) != stages.end())
+            return;
+        for (Stage *in : s->getInputs())
+            visit(in);
+        stages.push_back(s);
+    };
+    visit(stage);
+
+    std::ostream& out = std::cout;
+    out << std::left << std::setw(24) << "Stage" << std::right <<
+        std::setw(10) << "Wall (s)" << std::setw(10) << "CPU (s)" <<
+        std::setw(12) << "Points in" << std::setw(12) << "Points out" <<
+        std::setw(14) << "Bytes read" << std::setw(14) << "Bytes written" <<
+        std::setw(14) << "Peak memory" << std::endl;
+    for (Stage *s : stages)
+    {
+        const StageStats *stats = s->stats();
+        if (!stats)
+            continue;
+        out << std::left << std::setw(24) << s->getName() << std::right <<
+            std::fixed << std::setprecision(3) <<
+            std::setw(10) << stats->wallTime() <<
+            std::setw(10) << stats->cpuTime() <<
+            std::setw(12) << stats->pointsIn() <<
+            std::setw(12) << stats->pointsOut() <<
+            std::setw(14) << stats->bytesRead() <<
+            std::setw(14) << stats->bytesWritten() <<
+            std::setw(14) << stats->peakMemory() << std::endl;
+    }
+}
+
 } // pdal
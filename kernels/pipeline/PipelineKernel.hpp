@@ -57,6 +57,7 @@ private:
     PipelineKernel();
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    void printStats(Stage *s);
 
     std::string m_inputFile;
     std::string m_pipelineFile;
@@ -64,6 +65,12 @@ private:
     std::string m_PointCloudSchemaOutput;
     std::string m_progressFile;
     int m_progressFd;
+    std::string m_scratchDir;
+    uint64_t m_scratchResident;
+    uint64_t m_memoryBudget;
+    point_count_t m_streamChunk;
+    point_count_t m_streamDepth;
+    bool m_stats;
 };
 
 } // pdal
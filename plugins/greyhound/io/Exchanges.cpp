@@ -243,7 +243,7 @@ bool Read::check()
             m_numBytes =
                 std::max<int>(jsonResponse["numBytes"].asInt(), 0);
 
-            if (m_pointsToRead * m_layout->pointSize() != m_numBytes)
+            if (m_pointsToRead * m_layout->packedPointSize() != m_numBytes)
             {
                 valid = false;
                 m_error = true;
@@ -290,7 +290,7 @@ void ReadUncompressed::handleRx(const message_ptr message)
         {
             const std::string& bytes(message->get_payload());
             const std::size_t rawNumBytes(bytes.size());
-            const std::size_t stride(m_layout->pointSize());
+            const std::size_t stride(m_layout->packedPointSize());
 
             m_data.insert(m_data.end(), bytes.begin(), bytes.end());
 
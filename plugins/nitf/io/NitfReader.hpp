@@ -77,6 +77,8 @@ protected:
         FileUtils::closeFile(m_istream);
         m_istream = NULL;
     }
+    virtual uint64_t dataOffset() const
+        { return m_offset; }
 
 private:
     uint64_t m_offset;
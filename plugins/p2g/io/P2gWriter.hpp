@@ -81,6 +81,9 @@ private:
     virtual void ready(PointTableRef table);
     virtual void write(const PointViewPtr view);
     virtual void done(PointTableRef table);
+    virtual bool usedDims(PointLayoutPtr /*layout*/,
+            Dimension::IdList& /*dims*/) const
+        { return true; }
 
     std::unique_ptr<OutCoreInterp> m_interpolator;
     uint64_t m_pointCount;
@@ -0,0 +1,180 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/BlockPool.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace pdal
+{
+
+BlockPool& BlockPool::instance()
+{
+    // Never destroyed, so point tables with static storage duration can
+    // release their blocks during program exit.
+    static BlockPool *pool = new BlockPool;
+    return *pool;
+}
+
+
+// The default capacity is enough to recycle the blocks of a few small
+// tables without holding on to much memory once they're gone.
+BlockPool::BlockPool() : m_held(0), m_capacity(16 * 1024 * 1024),
+    m_hugePages(false)
+{}
+
+
+char *BlockPool::allocate(std::size_t size, bool zero)
+{
+    char *block = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto fi = m_free.find(size);
+        if (fi != m_free.end() && fi->second.size())
+        {
+            block = fi->second.back();
+            fi->second.pop_back();
+            m_held -= size;
+        }
+    }
+    if (!block)
+        return create(size);
+    if (zero)
+        memset(block, 0, size);
+    return block;
+}
+
+
+void BlockPool::release(char *block, std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_held + size <= m_capacity)
+        {
+            m_free[size].push_back(block);
+            m_held += size;
+            return;
+        }
+    }
+    destroy(block, size);
+}
+
+
+void BlockPool::setCapacity(std::size_t capacity)
+{
+    std::vector<std::pair<char *, std::size_t>> freed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_capacity = capacity;
+        for (auto fi = m_free.begin(); fi != m_free.end(); ++fi)
+            while (m_held > m_capacity && fi->second.size())
+            {
+                freed.push_back(std::make_pair(fi->second.back(),
+                    fi->first));
+                fi->second.pop_back();
+                m_held -= fi->first;
+            }
+    }
+    for (auto& f : freed)
+        destroy(f.first, f.second);
+}
+
+
+std::size_t BlockPool::capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_capacity;
+}
+
+
+void BlockPool::clear()
+{
+    std::map<std::size_t, std::vector<char *>> freed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        freed.swap(m_free);
+        m_held = 0;
+    }
+    for (auto& f : freed)
+        for (char *block : f.second)
+            destroy(block, f.first);
+}
+
+
+// Fresh anonymous mappings read as zero and are only faulted in as they're
+// touched, so new blocks are never cleared explicitly.
+char *BlockPool::create(std::size_t size)
+{
+#ifdef _WIN32
+    char *block = (char *)calloc(size, 1);
+    if (!block)
+        throw std::bad_alloc();
+#else
+    void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (m_hugePages)
+        madvise(buf, size, MADV_HUGEPAGE);
+#endif
+    char *block = (char *)buf;
+#endif
+    return block;
+}
+
+
+void BlockPool::destroy(char *block, std::size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    free(block);
+#else
+    munmap(block, size);
+#endif
+}
+
+} // namespace pdal
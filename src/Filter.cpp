@@ -33,15 +33,81 @@
 ****************************************************************************/
 
 #include <pdal/Filter.hpp>
-#include <pdal/PipelineWriter.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <vector>
 
 namespace pdal
 {
 
-pdalboost::property_tree::ptree Filter::serializePipeline() const
+void Filter::filterPoints(PointView& view, PointView *keep)
+{
+    // Don't bother with threads unless each one has a reasonable amount
+    // of work to do.
+    const point_count_t minRange = 16384;
+
+    point_count_t size = view.size();
+    size_t numRanges = (std::min)((point_count_t)viewThreads(),
+        size / minRange);
+    std::vector<char> flags(keep ? size : 0);
+    char *flagPtr = flags.empty() ? NULL : flags.data();
+
+    // A serial run uses whatever the stage set up for itself, so there's
+    // no state to make.
+    if (numRanges <= 1)
+        filterRange(view, 0, size, NULL, flagPtr);
+    else
+    {
+        // The states are created here rather than in the worker threads
+        // so that makePointState() needn't be thread-safe.
+        std::vector<PointStatePtr> states;
+        for (size_t i = 0; i < numRanges; ++i)
+            states.push_back(makePointState());
+
+        // The calling thread just waits, so the stage's CPU time is that
+        // of the workers.
+        StageStats *stats = workerStats();
+        ThreadPool pool(numRanges);
+        point_count_t rangeSize = (size + numRanges - 1) / numRanges;
+        for (size_t i = 0; i < numRanges; ++i)
+        {
+            PointId begin = i * rangeSize;
+            PointId end = (std::min)(begin + rangeSize, size);
+            PointState *state = states[i].get();
+            char *f = flagPtr ? flagPtr + begin : NULL;
+            pool.add([this, &view, begin, end, state, f, stats]()
+            {
+                StageStats::Timer timer(stats, false, true);
+                filterRange(view, begin, end, state, f);
+            });
+        }
+        pool.await();
+    }
+
+    if (keep)
+    {
+        std::vector<PointId> ids;
+        for (PointId idx = 0; idx < size; ++idx)
+            if (flags[idx])
+                ids.push_back(idx);
+        keep->appendPoints(view, ids);
+    }
+}
+
+
+void Filter::filterRange(PointView& view, PointId begin, PointId end,
+    PointState *state, char *keep)
 {
-    return serialize(getName(), "Filter");
+    PointRef point(view, begin);
+    for (PointId idx = begin; idx < end; ++idx)
+    {
+        point.setPointId(idx);
+        bool ok = filterPoint(point, state);
+        if (keep)
+            keep[idx - begin] = ok;
+    }
 }
 
 } // namespace pdal
-
@@ -36,6 +36,7 @@
 
 #include <delta/DeltaKernel.hpp>
 #include <diff/DiffKernel.hpp>
+#include <index/IndexKernel.hpp>
 #include <info/InfoKernel.hpp>
 #include <merge/MergeKernel.hpp>
 #include <pipeline/PipelineKernel.hpp>
@@ -55,6 +56,7 @@ KernelFactory::KernelFactory(bool no_plugins)
 
     PluginManager::initializePlugin(DeltaKernel_InitPlugin);
     PluginManager::initializePlugin(DiffKernel_InitPlugin);
+    PluginManager::initializePlugin(IndexKernel_InitPlugin);
     PluginManager::initializePlugin(InfoKernel_InitPlugin);
     PluginManager::initializePlugin(MergeKernel_InitPlugin);
     PluginManager::initializePlugin(PipelineKernel_InitPlugin);
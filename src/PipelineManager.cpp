@@ -33,6 +33,7 @@
 ****************************************************************************/
 
 #include <pdal/PipelineManager.hpp>
+#include <pdal/Writer.hpp>
 #include "PipelineReader.hpp"
 
 namespace pdal
@@ -103,18 +104,55 @@ void PipelineManager::prepare() const
 {
     Stage *s = getStage();
     if (s)
-       s->prepare(m_table);
+       s->prepare(*m_table);
+}
+
+
+// Streaming produces no views, so only pipelines that end in a writer are
+// streamed.
+bool PipelineManager::streamable() const
+{
+    Stage *s = getStage();
+    return s && dynamic_cast<Writer *>(s) && s->pipelineStreamable();
 }
 
 
 point_count_t PipelineManager::execute()
 {
+    m_streamed = false;
+    if (m_memoryBudget)
+    {
+        if (streamable())
+        {
+            // The chunk size isn't derived from the budget.  A chunk only
+            // needs to be large enough to amortize the per-chunk overhead
+            // of each stage, and even several chunks are far smaller than
+            // any useful budget.
+            FixedPointTable *table = new FixedPointTable(m_streamChunk,
+                m_streamDepth);
+            m_tablePtr.reset(table);
+            m_table = table;
+            m_viewSet.clear();
+            m_streamed = true;
+
+            Stage *s = getStage();
+            s->prepare(*table);
+            return s->execute(*table);
+        }
+        if (m_tablePtr)
+        {
+            m_tablePtr.reset(new MappedPointTable(m_scratchDir,
+                m_memoryBudget));
+            m_table = m_tablePtr.get();
+        }
+    }
+
     prepare();
 
     Stage *s = getStage();
     if (!s)
         return 0;
-    m_viewSet = s->execute(m_table);
+    m_viewSet = s->execute(*m_table);
     point_count_t cnt = 0;
     for (auto pi = m_viewSet.begin(); pi != m_viewSet.end(); ++pi)
     {
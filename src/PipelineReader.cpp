@@ -420,6 +420,27 @@ bool PipelineReader::parseElement_Pipeline(const ptree& tree)
     if (version != "1.0")
         throw pdal_error("PipelineReader: unsupported pipeline xml version");
 
+    // The memory budget is given in megabytes.
+    if (attrs.count("memory_budget"))
+    {
+        uint64_t budget;
+        if (!Utils::fromString(attrs["memory_budget"], budget))
+            throw pdal_error("PipelineReader: invalid memory_budget value '" +
+                attrs["memory_budget"] + "'.");
+        m_manager.setMemoryBudget(budget * 1024 * 1024, attrs["scratch_dir"]);
+    }
+
+    auto count = [&attrs](const std::string& name)
+    {
+        point_count_t val = 0;
+        if (attrs.count(name) &&
+            (!Utils::fromString(attrs[name], val) || val == 0))
+            throw pdal_error("PipelineReader: invalid " + name + " value '" +
+                attrs[name] + "'.");
+        return val;
+    };
+    m_manager.setStreamChunks(count("stream_chunk"), count("stream_depth"));
+
     bool isWriter = false;
 
     for (auto iter = tree.begin(); iter != tree.end(); ++iter)
@@ -80,9 +80,38 @@ void PointLayout::registerDim(Dimension::Id::Enum id, Dimension::Type::Enum type
 {
     Dimension::Detail dd = m_detail[id];
     dd.setType(resolveType(type, dd.type()));
+    unscale(dd);
     update(dd, Dimension::name(id));
 }
 
+void PointLayout::registerScaledDim(Dimension::Id::Enum id,
+    const XForm& xform)
+{
+    Dimension::Detail dd = m_detail[id];
+    if (dd.type() == Dimension::Type::None)
+    {
+        dd.setType(Dimension::Type::Signed32);
+        dd.setXForm(xform);
+    }
+    else if (!dd.scaled() || dd.xform() != xform)
+    {
+        dd.setType(resolveType(Dimension::Type::Double, dd.type()));
+        unscale(dd);
+    }
+    update(dd, Dimension::name(id));
+}
+
+// A dimension is only stored scaled if every registration agrees on the
+// scaling.  Otherwise it's stored as a double.
+void PointLayout::unscale(Dimension::Detail& dd)
+{
+    if (dd.scaled())
+    {
+        dd.setType(Dimension::Type::Double);
+        dd.clearXForm();
+    }
+}
+
 Dimension::Id::Enum PointLayout::assignDim(const std::string& name,
     Dimension::Type::Enum type)
 {
@@ -93,6 +122,7 @@ Dimension::Id::Enum PointLayout::assignDim(const std::string& name,
         id = di->second;
     Dimension::Detail dd = m_detail[id];
     dd.setType(resolveType(type, dd.type()));
+    unscale(dd);
     if (update(dd, name))
     {
         if (di == m_propIds.end())
@@ -172,12 +202,13 @@ const Dimension::IdList& PointLayout::dims() const
 
 Dimension::Type::Enum PointLayout::dimType(Dimension::Id::Enum id) const
 {
-    return dimDetail(id)->type();
+    const Dimension::Detail *dd = dimDetail(id);
+    return dd->scaled() ? Dimension::Type::Double : dd->type();
 }
 
 size_t PointLayout::dimSize(Dimension::Id::Enum id) const
 {
-    return dimDetail(id)->size();
+    return Dimension::size(dimType(id));
 }
 
 size_t PointLayout::dimOffset(Dimension::Id::Enum id) const
@@ -190,6 +221,14 @@ size_t PointLayout::pointSize() const
     return m_pointSize;
 }
 
+size_t PointLayout::packedPointSize() const
+{
+    size_t size = 0;
+    for (auto id : m_used)
+        size += dimSize(id);
+    return size;
+}
+
 const Dimension::Detail* PointLayout::dimDetail(Dimension::Id::Enum id) const
 {
     return &(m_detail[(size_t)id]);
@@ -221,29 +260,7 @@ bool PointLayout::update(Dimension::Detail dd, const std::string& name)
         [dd](const Dimension::Detail& td){ return td.id() == dd.id(); });
     Dimension::Detail *cur = &(*di);
 
-    {
-        auto sorter = [this](const Dimension::Detail& d1,
-                const Dimension::Detail& d2) -> bool
-        {
-            if (d1.size() > d2.size())
-                return true;
-            if (d1.size() < d2.size())
-                return false;
-            return d1.id() < d2.id();
-        };
-
-        int offset = 0;
-        std::sort(detail.begin(), detail.end(), sorter);
-        for (auto& d : detail)
-        {
-            d.setOffset(offset);
-            offset += (int)d.size();
-        }
-        //NOTE - I tried forcing all points to be aligned on 8-byte boundaries
-        // in case this would matter to the optimized memcpy, but it made
-        // no difference.  No sense wasting space for no difference.
-        m_pointSize = (size_t)offset;
-    }
+    assignOffsets(detail);
 
     if (!used)
         m_used.push_back(dd.id());
@@ -254,6 +271,54 @@ bool PointLayout::update(Dimension::Detail dd, const std::string& name)
     return true;
 }
 
+void PointLayout::removeDim(Dimension::Id::Enum id)
+{
+    if (m_finalized)
+    {
+        throw pdal_error("Can't update layout after points have been added.");
+    }
+    if (!hasDim(id))
+        return;
+
+    m_used.erase(std::remove(m_used.begin(), m_used.end(), id), m_used.end());
+    m_detail[id].setType(Dimension::Type::None);
+    m_detail[id].setOffset(-1);
+    m_detail[id].clearXForm();
+
+    Dimension::DetailList detail;
+    for (auto used : m_used)
+        detail.push_back(m_detail[used]);
+    assignOffsets(detail);
+    for (auto& dtemp : detail)
+        m_detail[dtemp.id()] = dtemp;
+}
+
+// Dimensions are laid out largest first, then by ID.
+void PointLayout::assignOffsets(Dimension::DetailList& detail)
+{
+    auto sorter = [](const Dimension::Detail& d1,
+            const Dimension::Detail& d2) -> bool
+    {
+        if (d1.size() > d2.size())
+            return true;
+        if (d1.size() < d2.size())
+            return false;
+        return d1.id() < d2.id();
+    };
+
+    int offset = 0;
+    std::sort(detail.begin(), detail.end(), sorter);
+    for (auto& d : detail)
+    {
+        d.setOffset(offset);
+        offset += (int)d.size();
+    }
+    //NOTE - I tried forcing all points to be aligned on 8-byte boundaries
+    // in case this would matter to the optimized memcpy, but it made
+    // no difference.  No sense wasting space for no difference.
+    m_pointSize = (size_t)offset;
+}
+
 Dimension::Type::Enum PointLayout::resolveType(
         Dimension::Type::Enum t1,
         Dimension::Type::Enum t2)
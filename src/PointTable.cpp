@@ -33,6 +33,20 @@
 ****************************************************************************/
 
 #include <pdal/PointTable.hpp>
+#include <pdal/BlockPool.hpp>
+#include <pdal/Compression.hpp>
+
+#include <pdal/PointView.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace pdal
 {
@@ -69,8 +83,9 @@ void SimplePointTable::getFieldInternal(Dimension::Id::Enum id, PointId idx,
 
 PointTable::~PointTable()
 {
+    size_t size = pointsToBytes(m_blockPtCnt);
     for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
-        delete [] *vi;
+        BlockPool::instance().release(*vi, size);
 }
 
 PointId PointTable::addPoint()
@@ -78,19 +93,492 @@ PointId PointTable::addPoint()
     if (m_numPts % m_blockPtCnt == 0)
     {
         size_t size = pointsToBytes(m_blockPtCnt);
-        char *buf = new char[size];
-        memset(buf, 0, size);
-        m_blocks.push_back(buf);
+        m_blockZeroed = !m_pointsInitialized;
+        m_blocks.push_back(BlockPool::instance().allocate(size,
+            m_blockZeroed));
+        updatePeakMemory(memoryUsed());
     }
+    // A block that was handed out without being cleared may be shared
+    // with points added by a stage that doesn't set every dimension.
+    else if (!m_blockZeroed && !m_pointsInitialized)
+        memset(getPoint(m_numPts), 0, pointsToBytes(1));
     return m_numPts++;
 }
 
 
+bool PointTable::compact(double threshold)
+{
+    const PointId unused = (std::numeric_limits<PointId>::max)();
+
+    std::vector<PointView *> views = m_viewRegistry->views();
+    std::sort(views.begin(), views.end(),
+        [](const PointView *v1, const PointView *v2)
+        { return v1->id() < v2->id(); });
+
+    // Number the referenced points in the order of the views that refer
+    // to them, so that each view's points end up contiguous if possible.
+    std::vector<PointId> newIds(m_numPts, unused);
+    std::vector<PointId> oldIds;
+    for (PointView *v : views)
+        for (PointId i = 0; i < v->size(); ++i)
+        {
+            PointId& newId = newIds[v->m_index[i]];
+            if (newId == unused)
+            {
+                newId = (PointId)oldIds.size();
+                oldIds.push_back(v->m_index[i]);
+            }
+        }
+    if (!m_numPts || oldIds.size() >= threshold * m_numPts)
+        return false;
+
+    size_t pointSize = pointsToBytes(1);
+    size_t blockSize = pointsToBytes(m_blockPtCnt);
+    std::vector<char *> blocks;
+    for (PointId id = 0; id < oldIds.size(); ++id)
+    {
+        if (id % m_blockPtCnt == 0)
+            blocks.push_back(BlockPool::instance().allocate(blockSize,
+                false));
+        memcpy(blocks.back() + pointsToBytes(id % m_blockPtCnt),
+            getPoint(oldIds[id]), pointSize);
+    }
+    // The old and new blocks are both held until the copy is done.
+    updatePeakMemory(memoryUsed() + (uint64_t)blocks.size() * blockSize);
+    for (char *block : m_blocks)
+        BlockPool::instance().release(block, blockSize);
+    m_blocks.swap(blocks);
+    m_numPts = (point_count_t)oldIds.size();
+    // The end of the last block wasn't cleared.
+    m_blockZeroed = false;
+
+    for (PointView *v : views)
+    {
+        PointViewIndex index;
+        for (PointId i = 0; i < v->size(); ++i)
+            index.push_back(newIds[v->m_index[i]]);
+        v->m_index = index;
+        v->clearTemps();
+    }
+    return true;
+}
+
+
 char *PointTable::getPoint(PointId idx)
 {
     char *buf = m_blocks[idx / m_blockPtCnt];
     return buf + pointsToBytes(idx % m_blockPtCnt);
 }
 
+
+char *PointTable::getDimensionRun(const Dimension::Detail *d, PointId idx,
+    size_t& stride, point_count_t& run)
+{
+    // Derived tables that keep their own storage return no raw points.
+    char *p = getPoint(idx);
+    if (!p)
+        return NULL;
+    stride = m_layoutRef.pointSize();
+    run = m_blockPtCnt - (idx % m_blockPtCnt);
+    return p + d->offset();
+}
+
+
+MappedPointTable::MappedPointTable(const std::string& dir,
+    uint64_t maxResident) : SimplePointTable(m_layout), m_numPts(0),
+    m_maxResident(maxResident), m_fd(-1)
+{
+#ifdef _WIN32
+    throw pdal_error("MappedPointTable isn't supported on this platform.");
+#else
+    std::string path(dir);
+    if (path.empty())
+    {
+        const char *tmp = std::getenv("TMPDIR");
+        path = tmp ? tmp : "/tmp";
+    }
+    path += "/pdal_points_XXXXXX";
+
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back(0);
+    m_fd = mkstemp(name.data());
+    if (m_fd < 0)
+        throw pdal_error("Unable to create point scratch file '" + path +
+            "'.");
+    // The file disappears once it's closed.
+    unlink(name.data());
+#endif
+}
+
+
+MappedPointTable::~MappedPointTable()
+{
+#ifndef _WIN32
+    size_t size = pointsToBytes(m_blockPtCnt);
+    for (char *block : m_blocks)
+        munmap(block, size);
+    if (m_fd >= 0)
+        close(m_fd);
+#endif
+}
+
+
+PointId MappedPointTable::addPoint()
+{
+#ifndef _WIN32
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        // Block sizes are a multiple of 65536 bytes, so each block starts
+        // on a page boundary in the file.  Space added to the file reads
+        // as zero.
+        size_t size = pointsToBytes(m_blockPtCnt);
+        off_t offset = (off_t)size * m_blocks.size();
+        if (ftruncate(m_fd, offset + size) != 0)
+            throw pdal_error("Unable to extend point scratch file.");
+        void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+            m_fd, offset);
+        if (buf == MAP_FAILED)
+            throw pdal_error("Unable to map point scratch file.");
+        m_blocks.push_back((char *)buf);
+        updatePeakMemory(memoryUsed());
+
+        // Keep the most recent 'keep' blocks resident.  Writing back the
+        // oldest of them starts now, so that it has usually finished by
+        // the time the block leaves the window and is released.
+        if (m_maxResident)
+        {
+            size_t keep = (std::max)((uint64_t)1, m_maxResident / size);
+            size_t num = m_blocks.size();
+            if (num >= keep)
+                msync(m_blocks[num - keep], size, MS_ASYNC);
+            if (num > keep)
+                release(num - keep - 1);
+        }
+    }
+#endif
+    return m_numPts++;
+}
+
+
+// Dropping a shared mapping's pages from the process doesn't free them:
+// dirty pages stay in the page cache until the kernel gets around to
+// writing them.  So the block is written to the file, its pages are
+// unmapped and then, once they're clean, dropped from the page cache.
+void MappedPointTable::release(size_t blockNum)
+{
+#ifndef _WIN32
+    size_t size = pointsToBytes(m_blockPtCnt);
+    char *block = m_blocks[blockNum];
+    msync(block, size, MS_SYNC);
+    madvise(block, size, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(m_fd, (off_t)size * blockNum, size, POSIX_FADV_DONTNEED);
+#endif
+#endif
+}
+
+
+// Without a resident limit, assume the operating system keeps everything
+// in memory.
+uint64_t MappedPointTable::memoryUsed() const
+{
+    uint64_t size = pointsToBytes(m_blockPtCnt);
+    uint64_t total = size * m_blocks.size();
+    if (!m_maxResident)
+        return total;
+    uint64_t keep = (std::max)((uint64_t)1, m_maxResident / size);
+    return (std::min)(total, keep * size);
+}
+
+
+char *MappedPointTable::getPoint(PointId idx)
+{
+    char *buf = m_blocks[idx / m_blockPtCnt];
+    return buf + pointsToBytes(idx % m_blockPtCnt);
+}
+
+
+char *MappedPointTable::getDimensionRun(const Dimension::Detail *d,
+    PointId idx, size_t& stride, point_count_t& run)
+{
+    // Derived tables that keep their own storage return no raw points.
+    char *p = getPoint(idx);
+    if (!p)
+        return NULL;
+    stride = m_layoutRef.pointSize();
+    run = m_blockPtCnt - (idx % m_blockPtCnt);
+    return p + d->offset();
+}
+
+
+#ifdef PDAL_HAVE_LAZPERF
+
+CompressedPointTable::CompressedPointTable(point_count_t maxResident) :
+    SimplePointTable(m_layout), m_numPts(0),
+    m_maxResident((std::max)((point_count_t)1, maxResident))
+{}
+
+
+CompressedPointTable::~CompressedPointTable()
+{
+    size_t size = pointsToBytes(m_blockPtCnt);
+    for (Block& block : m_blocks)
+        if (block.m_data)
+            BlockPool::instance().release(block.m_data, size);
+}
+
+
+uint64_t CompressedPointTable::compressedSize() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    uint64_t size = 0;
+    for (const Block& block : m_blocks)
+        size += block.m_compressed.size();
+    return size;
+}
+
+
+point_count_t CompressedPointTable::residentBlocks() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_lru.size();
+}
+
+
+uint64_t CompressedPointTable::memoryUsed() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return memoryUsedLocked();
+}
+
+
+// Must be called with the lock held.
+uint64_t CompressedPointTable::memoryUsedLocked() const
+{
+    uint64_t size = (uint64_t)m_lru.size() * pointsToBytes(m_blockPtCnt);
+    for (const Block& block : m_blocks)
+        size += block.m_compressed.size();
+    return size;
+}
+
+
+PointId CompressedPointTable::addPoint()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        if (m_blocks.empty())
+            setDimTypes();
+
+        // New blocks are zeroed.  A block is compressed and decompressed
+        // whole, including the storage of points not yet added, so new
+        // points always start out zeroed.
+        Block block;
+        block.m_data =
+            BlockPool::instance().allocate(pointsToBytes(m_blockPtCnt));
+        block.m_dirty = true;
+        m_blocks.push_back(block);
+        m_lru.push_front(m_blocks.size() - 1);
+        updatePeakMemory(memoryUsedLocked());
+        if (m_lru.size() > m_maxResident)
+        {
+            evict(m_lru.back());
+            m_lru.pop_back();
+        }
+    }
+    return m_numPts++;
+}
+
+
+// The caller may write through the pointer, so assume the block changes.
+// The pointer is invalidated if the block is evicted.
+char *CompressedPointTable::getPoint(PointId idx)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    char *buf = residentBlock(idx);
+    m_blocks[idx / m_blockPtCnt].m_dirty = true;
+    return buf + pointsToBytes(idx % m_blockPtCnt);
+}
+
+
+void CompressedPointTable::setFieldInternal(Dimension::Id::Enum id,
+    PointId idx, const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src  = (const char *)value;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    char *dst = residentBlock(idx) + pointsToBytes(idx % m_blockPtCnt) +
+        d->offset();
+    std::copy(src, src + d->size(), dst);
+    m_blocks[idx / m_blockPtCnt].m_dirty = true;
+}
+
+
+void CompressedPointTable::getFieldInternal(Dimension::Id::Enum id,
+    PointId idx, void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    char *dst = (char *)value;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    CompressedPointTable *ncThis = const_cast<CompressedPointTable *>(this);
+    const char *src = ncThis->residentBlock(idx) +
+        pointsToBytes(idx % m_blockPtCnt) + d->offset();
+    std::copy(src, src + d->size(), dst);
+}
+
+
+// Blocks are compressed straight from their storage, so the compressor
+// fields must be in the same order as the dimensions' offsets.  The layout
+// can't change once points have been added.
+void CompressedPointTable::setDimTypes()
+{
+    std::vector<const Dimension::Detail *> details;
+    for (Dimension::Id::Enum id : m_layoutRef.dims())
+        details.push_back(m_layoutRef.dimDetail(id));
+    std::sort(details.begin(), details.end(),
+        [](const Dimension::Detail *d1, const Dimension::Detail *d2)
+        { return d1->offset() < d2->offset(); });
+
+    m_dimTypes.clear();
+    for (const Dimension::Detail *d : details)
+        m_dimTypes.push_back(DimType(d->id(), d->type()));
+}
+
+
+// Must be called with the lock held.  Returns the uncompressed storage of
+// the block containing a point, decompressing it if necessary.
+char *CompressedPointTable::residentBlock(PointId idx)
+{
+    size_t blockNum = idx / m_blockPtCnt;
+    Block& block = m_blocks[blockNum];
+
+    if (block.m_data)
+    {
+        // Most accesses are to the block used last, so check it first.
+        if (m_lru.front() != blockNum)
+        {
+            auto li = std::find(m_lru.begin(), m_lru.end(), blockNum);
+            m_lru.splice(m_lru.begin(), m_lru, li);
+        }
+        return block.m_data;
+    }
+
+    if (m_lru.size() >= m_maxResident)
+    {
+        evict(m_lru.back());
+        m_lru.pop_back();
+    }
+    decompress(block);
+    m_lru.push_front(blockNum);
+    updatePeakMemory(memoryUsedLocked());
+    return block.m_data;
+}
+
+
+// Release a block's uncompressed storage.  If the block hasn't been
+// modified since it was decompressed, its compressed data is still good.
+void CompressedPointTable::evict(size_t blockNum)
+{
+    Block& block = m_blocks[blockNum];
+
+    if (block.m_dirty)
+        compress(block);
+    BlockPool::instance().release(block.m_data, pointsToBytes(m_blockPtCnt));
+    block.m_data = NULL;
+}
+
+
+void CompressedPointTable::compress(Block& block)
+{
+    block.m_compressed.clear();
+    SignedLazPerfBuf buf(block.m_compressed);
+    LazPerfCompressor<SignedLazPerfBuf> compressor(buf, m_dimTypes);
+    compressor.compress(block.m_data, pointsToBytes(m_blockPtCnt));
+    compressor.done();
+    std::vector<char>(block.m_compressed).swap(block.m_compressed);
+    block.m_dirty = false;
+}
+
+
+void CompressedPointTable::decompress(Block& block)
+{
+    size_t size = pointsToBytes(m_blockPtCnt);
+    block.m_data = BlockPool::instance().allocate(size, false);
+
+    SignedLazPerfBuf buf(block.m_compressed);
+    LazPerfDecompressor<SignedLazPerfBuf> decompressor(buf, m_dimTypes);
+    decompressor.decompress(block.m_data, size);
+}
+
+#endif  // PDAL_HAVE_LAZPERF
+
+
+ColumnPointTable::~ColumnPointTable()
+{
+    size_t size = m_layoutRef.pointSize() * m_blockPtCnt;
+    for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
+        BlockPool::instance().release(*vi, size);
+}
+
+
+// A point's values are spread over a block, so blocks are always zeroed.
+PointId ColumnPointTable::addPoint()
+{
+    if (m_numPts % m_blockPtCnt == 0)
+    {
+        size_t size = m_layoutRef.pointSize() * m_blockPtCnt;
+        m_blocks.push_back(BlockPool::instance().allocate(size));
+        updatePeakMemory(memoryUsed());
+    }
+    return m_numPts++;
+}
+
+
+// Gather the values of the point into a row laid out as in PointTable.
+char *ColumnPointTable::getPoint(PointId idx)
+{
+    m_row.resize(m_layoutRef.pointSize());
+    for (auto id : m_layoutRef.dims())
+    {
+        const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+        const char *src = getDimension(d, idx);
+        std::copy(src, src + d->size(), m_row.data() + d->offset());
+    }
+    return m_row.data();
+}
+
+
+char *ColumnPointTable::getDimensionRun(const Dimension::Detail *d,
+    PointId idx, size_t& stride, point_count_t& run)
+{
+    stride = d->size();
+    run = m_blockPtCnt - (idx % m_blockPtCnt);
+    return getDimension(d, idx);
+}
+
+
+void ColumnPointTable::setFieldInternal(Dimension::Id::Enum id, PointId idx,
+    const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src  = (const char *)value;
+    char *dst = getDimension(d, idx);
+    std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::getFieldInternal(Dimension::Id::Enum id, PointId idx,
+    void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const char *src = getDimension(d, idx);
+    char *dst = (char *)value;
+    std::copy(src, src + d->size(), dst);
+}
+
 } // namespace pdal
 
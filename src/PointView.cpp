@@ -32,6 +32,7 @@
 * OF SUCH DAMAGE.
 ****************************************************************************/
 
+#include <atomic>
 #include <iomanip>
 
 #include <pdal/PointView.hpp>
@@ -40,6 +41,13 @@
 namespace pdal
 {
 
+int PointView::nextId()
+{
+    static std::atomic<int> lastId(0);
+    return ++lastId;
+}
+
+
 PointViewIter PointView::begin()
 {
     return PointViewIter(this, 0);
@@ -52,6 +60,26 @@ PointViewIter PointView::end()
 }
 
 
+PointViewPtr PointView::slice(PointId begin, PointId end) const
+{
+    if (begin > end || end > size())
+        throw pdal_error("Invalid range for point view slice.");
+
+    PointViewPtr view(makeNew());
+    view->m_index = m_index.slice(begin, end);
+    view->m_size = end - begin;
+    return view;
+}
+
+
+PointViewPtr PointView::select(const std::vector<PointId>& ids) const
+{
+    PointViewPtr view(makeNew());
+    view->appendPoints(*this, ids);
+    return view;
+}
+
+
 void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
     const void *buf)
 {
@@ -77,14 +105,42 @@ void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
 }
 
 
-void PointView::calculateBounds(BOX2D& output) const
+char *PointView::getPointData(PointId idx)
 {
-    for (PointId idx = 0; idx < size(); idx++)
+    if (idx >= size())
+        return NULL;
+    return m_pointTable.getPointData(m_index[idx]);
+}
+
+
+// As with setFieldInternal(), writing the point just past the end of the
+// view adds a point.
+char *PointView::getWritablePointData(PointId idx)
+{
+    if (idx == size())
     {
-        double x = getFieldAs<double>(Dimension::Id::X, idx);
-        double y = getFieldAs<double>(Dimension::Id::Y, idx);
+        PointId rawId = m_pointTable.addPoint();
+        m_index.push_back(rawId);
+        m_size++;
+        assert(m_temps.empty());
+    }
+    return getPointData(idx);
+}
 
-        output.grow(x, y);
+
+void PointView::calculateBounds(BOX2D& output) const
+{
+    const point_count_t chunk(4096);
+    std::vector<double> x(chunk);
+    std::vector<double> y(chunk);
+
+    for (PointId idx = 0; idx < size(); idx += chunk)
+    {
+        point_count_t cnt = (std::min)(chunk, size() - idx);
+        getFieldArray(Dimension::Id::X, idx, cnt, x.data());
+        getFieldArray(Dimension::Id::Y, idx, cnt, y.data());
+        for (point_count_t i = 0; i < cnt; ++i)
+            output.grow(x[i], y[i]);
     }
 }
 
@@ -101,13 +157,19 @@ void PointView::calculateBounds(const PointViewSet& set, BOX2D& output)
 
 void PointView::calculateBounds(BOX3D& output) const
 {
-    for (PointId idx = 0; idx < size(); idx++)
-    {
-        double x = getFieldAs<double>(Dimension::Id::X, idx);
-        double y = getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = getFieldAs<double>(Dimension::Id::Z, idx);
+    const point_count_t chunk(4096);
+    std::vector<double> x(chunk);
+    std::vector<double> y(chunk);
+    std::vector<double> z(chunk);
 
-        output.grow(x, y, z);
+    for (PointId idx = 0; idx < size(); idx += chunk)
+    {
+        point_count_t cnt = (std::min)(chunk, size() - idx);
+        getFieldArray(Dimension::Id::X, idx, cnt, x.data());
+        getFieldArray(Dimension::Id::Y, idx, cnt, y.data());
+        getFieldArray(Dimension::Id::Z, idx, cnt, z.data());
+        for (point_count_t i = 0; i < cnt; ++i)
+            output.grow(x[i], y[i], z[i]);
     }
 }
 
@@ -139,7 +201,7 @@ void PointView::dump(std::ostream& ostr) const
             Dimension::Id::Enum d = *di;
             const Dimension::Detail *dd = layout->dimDetail(d);
             ostr << Dimension::name(d) << " (" <<
-                Dimension::interpretationName(dd->type()) << ") : ";
+                Dimension::interpretationName(layout->dimType(d)) << ") : ";
 
             switch (dd->type())
             {
@@ -155,7 +217,10 @@ void PointView::dump(std::ostream& ostr) const
                 }
             case Dimension::Type::Signed32:
                 {
-                    ostr << getFieldInternal<int32_t>(d, idx);
+                    if (dd->scaled())
+                        ostr << getFieldAs<double>(d, idx);
+                    else
+                        ostr << getFieldInternal<int32_t>(d, idx);
                     break;
                 }
             case Dimension::Type::Signed64:
@@ -348,15 +348,19 @@ double Polygon::area() const
 }
 
 bool Polygon::covers(PointRef& ref) const
+{
+    return covers(ref.getFieldAs<double>(Dimension::Id::X),
+        ref.getFieldAs<double>(Dimension::Id::Y),
+        ref.getFieldAs<double>(Dimension::Id::Z));
+}
+
+
+bool Polygon::covers(double x, double y, double z) const
 {
     GEOSCoordSequence* coords = GEOSCoordSeq_create_r(m_ctx, 1, 3);
     if (!coords)
         throw pdal_error("Unable to allocate coordinate sequence");
 
-    const double x = ref.getFieldAs<double>(Dimension::Id::X);
-    const double y = ref.getFieldAs<double>(Dimension::Id::Y);
-    const double z = ref.getFieldAs<double>(Dimension::Id::Z);
-
     if (!GEOSCoordSeq_setX_r(m_ctx, coords, 0, x))
         throw pdal_error("unable to set x for coordinate sequence");
     if (!GEOSCoordSeq_setY_r(m_ctx, coords, 0, y))
@@ -37,11 +37,20 @@
 #include <pdal/Stage.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/UserCallback.hpp>
+#include <pdal/Writer.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/util/Algorithm.hpp>
 
 #include "StageRunner.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 
 namespace pdal
 {
@@ -70,6 +79,9 @@ void Stage::Construct()
 {
     m_debug = false;
     m_verbose = 0;
+    m_threads = 1;
+    m_threadsUsed = false;
+    m_concurrentRun = false;
 }
 
 
@@ -96,13 +108,21 @@ void Stage::serialize(MetadataNode root, PipelineWriter::TagMap& tags) const
 }
 
 void Stage::prepare(PointTableRef table)
+{
+    l_prepare(table);
+    pruneDims(table.layout());
+}
+
+
+void Stage::l_prepare(PointTableRef table)
 {
     for (size_t i = 0; i < m_inputs.size(); ++i)
     {
         Stage *prev = m_inputs[i];
-        prev->prepare(table);
+        prev->l_prepare(table);
     }
     l_processOptions(m_options);
+    StageStats::Timer timer(m_stats.get());
     processOptions(m_options);
     l_initialize(table);
     initialize(table);
@@ -111,6 +131,90 @@ void Stage::prepare(PointTableRef table)
 }
 
 
+// Remove dimensions that no stage in the pipeline reads.  Readers register
+// their dimensions before downstream stages have processed their options,
+// so this can only be done once the whole pipeline is prepared.  It's only
+// done when this stage is a writer and every stage reports the dimensions
+// it uses; otherwise whoever gets the resulting views may read anything.
+// X, Y and Z are always kept.
+void Stage::pruneDims(PointLayoutPtr layout)
+{
+    if (!dynamic_cast<Writer *>(this))
+        return;
+
+    Dimension::IdList used { Dimension::Id::X, Dimension::Id::Y,
+        Dimension::Id::Z };
+    std::set<const Stage *> seen;
+    std::vector<const Stage *> stages { this };
+    while (stages.size())
+    {
+        const Stage *s = stages.back();
+        stages.pop_back();
+        if (!seen.insert(s).second)
+            continue;
+        if (!s->usedDims(layout, used))
+            return;
+        for (auto prev : s->m_inputs)
+            stages.push_back(prev);
+    }
+
+    Dimension::IdList dims = layout->dims();
+    for (auto id : dims)
+        if (!Utils::contains(used, id))
+        {
+            log()->get(LogLevel::Debug) << "Dimension '" <<
+                layout->dimName(id) << "' isn't used and won't be "
+                "stored.\n";
+            layout->removeDim(id);
+        }
+}
+
+
+bool Stage::initializesPoints(PointLayoutPtr layout) const
+{
+    Dimension::IdList initDims = initializedDims();
+    for (auto id : layout->dims())
+        if (std::find(initDims.begin(), initDims.end(), id) == initDims.end())
+            return false;
+    return true;
+}
+
+
+namespace
+{
+
+// Marks a table's points as initialized by the stage adding them while
+// the guard exists.
+class PointsInitializedGuard
+{
+public:
+    PointsInitializedGuard(PointTableRef table, bool initialized) :
+        m_table(table)
+    { m_table.setPointsInitialized(initialized); }
+    ~PointsInitializedGuard()
+    { m_table.setPointsInitialized(false); }
+
+private:
+    PointTableRef m_table;
+};
+
+// Sets a flag for the life of the guard, so that it's cleared even if
+// running a view throws.
+class FlagGuard
+{
+public:
+    FlagGuard(bool& flag, bool val) : m_flag(flag)
+        { m_flag = val; }
+    ~FlagGuard()
+        { m_flag = false; }
+
+private:
+    bool& m_flag;
+};
+
+} // unnamed namespace
+
+
 PointViewSet Stage::execute(PointTableRef table)
 {
     table.finalize();
@@ -146,164 +250,431 @@ PointViewSet Stage::execute(PointTableRef table)
     for (auto const& it : views)
         table.addSpatialReference(it->spatialReference());
 
+    StageStats *stats = m_stats.get();
+    point_count_t pointsIn = 0;
+    if (stats)
+        for (auto const& it : views)
+            pointsIn += it->size();
+
     // Do the ready operation and then start running all the views
-    // through the stage.
-    ready(table);
-    for (auto const& it : views)
+    // through the stage.  If the stage allows it and there's more than
+    // one view, the views are run concurrently.
     {
-        StageRunnerPtr runner(new StageRunner(this, it));
-        runners.push_back(runner);
-        runner->run();
+        StageStats::Timer timer(stats);
+        ready(table);
     }
-
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
-    srs = getSpatialReference();
-    for (auto const& it : runners)
+    PointsInitializedGuard initGuard(table,
+        m_inputs.empty() && initializesPoints(table.layout()));
+    std::unique_ptr<ThreadPool> pool;
+    if (m_threads != 1 && views.size() > 1 && supportsConcurrentRun())
     {
-        StageRunnerPtr runner(it);
-        PointViewSet temp = runner->wait();
+        pool.reset(new ThreadPool(
+            (std::min)((size_t)m_threads - 1, views.size() - 1) + 1));
+        m_threadsUsed = true;
+    }
+    {
+        FlagGuard concurrentGuard(m_concurrentRun, (bool)pool);
 
-        // If our stage has a spatial reference, the view takes it on once
-        // the stage has been run.
-        if (!srs.empty())
-            for (PointViewPtr v : temp)
-                v->setSpatialReference(srs);
-        outViews.insert(temp.begin(), temp.end());
+        // The runners time their own CPU use on whichever thread they run.
+        std::unique_ptr<StageStats::Timer> runTimer;
+        if (stats)
+            runTimer.reset(new StageStats::Timer(stats, true, false));
+        for (auto const& it : views)
+        {
+            StageRunnerPtr runner(new StageRunner(this, it));
+            runners.push_back(runner);
+            runner->run(pool.get());
+        }
+
+        // As the stages complete, propagate the spatial reference and
+        // merge the output views.
+        srs = getSpatialReference();
+        for (auto const& it : runners)
+        {
+            StageRunnerPtr runner(it);
+            PointViewSet temp = runner->wait();
+
+            // Views created by concurrent runs get IDs in whatever order
+            // the threads happened to create them.  Renumber them in input
+            // order so the output set is ordered as it would be for a
+            // serial run.
+            if (pool)
+            {
+                std::vector<PointViewPtr> created(temp.begin(),
+                    temp.end());
+                temp.clear();
+                for (PointViewPtr v : created)
+                {
+                    if (v != runner->view())
+                        v->renumber();
+                    temp.insert(v);
+                }
+            }
+
+            // If our stage has a spatial reference, the view takes it on
+            // once the stage has been run.
+            if (!srs.empty())
+                for (PointViewPtr v : temp)
+                    v->setSpatialReference(srs);
+            outViews.insert(temp.begin(), temp.end());
+        }
+    }
+    if (stats)
+        stats->updateMemory(table.peakMemoryUsed());
+    {
+        StageStats::Timer timer(stats);
+        done(table);
+    }
+    logUnusedThreads();
+    if (stats)
+    {
+        point_count_t pointsOut = 0;
+        for (auto const& v : outViews)
+            pointsOut += v->size();
+        stats->addPoints(pointsIn, pointsOut);
+        stats->updateMemory(table.peakMemoryUsed());
+        stats->toMetadata(m_metadata);
     }
-    done(table);
     return outViews;
 }
 
 
+namespace
+{
+
+// Holds copies of streamed points when the output of a stage feeds more
+// than one stage.
+class BranchPointTable : public StreamPointTable
+{
+public:
+    BranchPointTable(PointLayout& layout, point_count_t capacity) :
+        StreamPointTable(layout), m_buf(pointsToBytes(capacity)),
+        m_capacity(capacity)
+    {}
+
+    point_count_t capacity() const
+        { return m_capacity; }
+
+protected:
+    virtual char *getPoint(PointId idx)
+        { return m_buf.data() + pointsToBytes(idx); }
+
+private:
+    std::vector<char> m_buf;
+    point_count_t m_capacity;
+};
+
+} // unnamed namespace
+
+
 // Streamed execution.
-void Stage::execute(StreamPointTable& table)
+bool Stage::pipelineStreamable() const
 {
-    typedef std::list<Stage *> StageList;
+    if (!streamable())
+        return false;
+    for (const Stage *in : m_inputs)
+        if (!in->pipelineStreamable())
+            return false;
+    return true;
+}
 
-    std::list<StageList> lists;
-    StageList stages;
 
+point_count_t Stage::execute(StreamPointTable& table)
+{
     table.finalize();
 
-    // Walk from the current stage backwards.  As we add each input, copy
-    // the list of stages and push it on a list.  We then pull a list from the
-    // front of list and keep going.  Placing on the back and pulling from the
-    // front insures that the stages will be executed in the order that they
-    // were added.  If we hit stage with no previous stages, we execute
-    // the stage list.
-    // All this often amounts to a bunch of list copying for
-    // no reason, but it's more simple than what we might otherwise do and
-    // this should be a nit in the grand scheme of execution time.
-    //
-    // As an example, if there are four paths from the end stage (writer) to
-    // reader stages, there will be four stage lists and execute(table, stages)
-    // will be called four times.
-    Stage *s = this;
-    stages.push_front(s);
-    while (true)
+    // Order the stages so that each stage follows its inputs.  Inputs are
+    // visited in the order that they were added to each stage, which
+    // determines the order in which readers are run.
+    std::vector<Stage *> stages;
+    std::function<void(Stage *)> visit = [&stages, &visit](Stage *s)
     {
-        if (s->m_inputs.empty())
-            execute(table, stages);
-        else
+        if (std::find(stages.begin(), stages.end(), s) != stages.end())
+            return;
+        for (Stage *in : s->m_inputs)
+            visit(in);
+        stages.push_back(s);
+    };
+    visit(this);
+
+    std::map<Stage *, std::vector<Stage *>> consumers;
+    for (Stage *s : stages)
+        for (Stage *in : s->m_inputs)
+            consumers[in].push_back(s);
+
+    SpatialReference srs;
+    for (Stage *s : stages)
+    {
+        StageStats::Timer timer(s->m_stats.get());
+        s->ready(table);
+        srs = s->getSpatialReference();
+        if (!srs.empty())
+            table.setSpatialReference(srs);
+    }
+
+    // Each reader is run once.  Its points are passed to each of its
+    // consumers, and so on, until they reach this stage.  When a stage
+    // feeds more than one stage, each consumer but the last gets a copy of
+    // the points so that the data is read and decoded only once.
+    std::vector<std::unique_ptr<BranchPointTable>> branches;
+    const DimTypeList dimTypes = table.layout()->dimTypes();
+    std::vector<char> pointBuf(table.layout()->packedPointSize());
+    point_count_t count = 0;
+
+    std::function<void(Stage *, PointRange&, SelectionVector&, size_t)>
+        pushPoints;
+    auto runStage = [&](Stage *s, PointRange& range, SelectionVector& sel,
+        size_t depth)
+    {
+        if (!sel.empty())
+            s->l_processBatch(range, sel);
+        if (s == this)
+            count += sel.size();
+        srs = s->getSpatialReference();
+        if (!srs.empty())
+            table.setSpatialReference(srs);
+        pushPoints(s, range, sel, depth);
+    };
+    pushPoints = [&](Stage *s, PointRange& range, SelectionVector& sel,
+        size_t depth)
+    {
+        const std::vector<Stage *>& next = consumers[s];
+        for (size_t i = 0; i < next.size(); ++i)
+        {
+            if (i + 1 == next.size())
+            {
+                runStage(next[i], range, sel, depth);
+                break;
+            }
+
+            if (branches.size() <= depth)
+                branches.emplace_back(new BranchPointTable(*table.layout(),
+                    table.capacity()));
+            PointRange branchRange(*branches[depth], 0, sel.size());
+            SelectionVector branchSel;
+            branchRange.selectAll(branchSel);
+            for (size_t j = 0; j < sel.size(); ++j)
+            {
+                range.point(sel[j]).getPackedData(dimTypes, pointBuf.data());
+                branchRange.point(j).setPackedData(dimTypes, pointBuf.data());
+            }
+            runStage(next[i], branchRange, branchSel, depth + 1);
+        }
+    };
+
+    for (Stage *reader : stages)
+    {
+        if (reader->m_inputs.empty())
         {
-            for (auto s2 : s->m_inputs)
+            // If the points of the reader pass through a single chain of
+            // stages, the stages can run on separate threads.
+            std::list<Stage *> chain;
+            Stage *s = reader;
+            chain.push_back(s);
+            while (consumers[s].size() == 1)
+            {
+                s = consumers[s].front();
+                chain.push_back(s);
+            }
+            if (s == this && table.pipelineDepth() > 1 &&
+                table.capacity() / table.pipelineDepth() > 0)
+            {
+                count += executePipelined(table, chain);
+                continue;
+            }
+
+            PointRange range(table, 0, table.capacity());
+            SelectionVector sel;
+            bool finished = false;
+            while (!finished)
             {
-                StageList newStages(stages);
-                newStages.push_front(s2);
-                lists.push_front(newStages);
+                // Clear the spatial reference when processing starts.
+                table.clearSpatialReferences();
+
+                // When we get false back from a reader, we're done.  The
+                // selection holds the points that were read.
+                range.selectAll(sel);
+                finished = !reader->l_processBatch(range, sel);
+                if (reader == this)
+                    count += sel.size();
+                srs = reader->getSpatialReference();
+                if (!srs.empty())
+                    table.setSpatialReference(srs);
+                pushPoints(reader, range, sel, 0);
+                table.reset();
             }
         }
-        if (lists.empty())
+    }
+
+    for (Stage *s : stages)
+    {
+        StageStats *stats = s->m_stats.get();
+        if (stats)
+            stats->updateMemory(table.peakMemoryUsed());
+        {
+            StageStats::Timer timer(stats);
+            s->done(table);
+        }
+        s->logUnusedThreads();
+        if (stats)
+            stats->toMetadata(s->m_metadata);
+    }
+    return count;
+}
+
+
+bool Stage::processBatch(PointRange& range, SelectionVector& sel)
+{
+    bool isReader = m_inputs.empty();
+    PointRef point = range.point(0);
+    size_t out = 0;
+    for (size_t i = 0; i < sel.size(); ++i)
+    {
+        point.setPointId(sel[i]);
+        if (processOne(point))
+            sel[out++] = sel[i];
+        else if (isReader)
             break;
-        stages = lists.back();
-        lists.pop_back();
-        s = stages.front();
     }
+    bool more = !isReader || out == sel.size();
+    sel.resize(out);
+    return more;
 }
 
 
-void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
+// Process a batch, collecting statistics if requested.
+bool Stage::l_processBatch(PointRange& range, SelectionVector& sel)
 {
-    std::vector<bool> skips(table.capacity());
-    std::list<Stage *> filters;
-    SpatialReference srs;
+    if (!m_stats)
+        return processBatch(range, sel);
+
+    StageStats::Timer timer(m_stats.get());
+    size_t in = m_inputs.empty() ? 0 : sel.size();
+    bool more = processBatch(range, sel);
+    m_stats->addPoints(in, sel.size());
+    return more;
+}
 
-    // Separate out the first stage.
-    Stage *reader = stages.front();
 
-    // Build a list of all stages except the first.  We may have a writer in
-    // this list in addition to filters, but we treat them in the same way.
-    auto begin = stages.begin();
-    begin++;
-    std::copy(begin, stages.end(), std::back_inserter(filters));
+void Stage::l_initialize(PointTableRef table)
+{
+    m_metadata = table.metadata().add(getName());
+}
 
+
+// Streamed execution where each stage runs on its own thread.  The table's
+// capacity is split into 'depth' chunks that are handed from stage to stage
+// in order, so while the reader fills one chunk, filters and writers work
+// on the chunks that the reader filled previously.  Each stage still sees
+// every point in order and processOne() is only ever called for a stage
+// from a single thread.
+point_count_t Stage::executePipelined(StreamPointTable& table,
+    std::list<Stage *>& stages)
+{
+    const point_count_t depth = table.pipelineDepth();
+    const point_count_t chunkSize = table.capacity() / depth;
+    const size_t numStages = stages.size();
+
+    // For each chunk, the position in the stage list of the next stage
+    // that should process it, the points selected and whether it's the last
+    // chunk of points.
+    std::vector<size_t> nextStage(depth, 0);
+    std::vector<SelectionVector> sels(depth);
+    std::vector<char> lastChunk(depth, false);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+    bool abort = false;
+    point_count_t count = 0;
+
+    // The table's spatial reference is shared by the chunks in flight, so
+    // it's set once from the stages' references as they were after ready()
+    // rather than being reset for each chunk.  It's the same as the value
+    // that a serial run leaves after each chunk.
+    table.clearSpatialReferences();
     for (Stage *s : stages)
     {
-        s->ready(table);
-        srs = s->getSpatialReference();
+        const SpatialReference& srs = s->getSpatialReference();
         if (!srs.empty())
             table.setSpatialReference(srs);
     }
 
-    // Loop until we're finished.  We handle the number of points up to
-    // the capacity of the StreamPointTable that we've been provided.
-
-    bool finished = false;
-    while (!finished)
+    auto runStage = [&](Stage *s, size_t pos)
     {
-        // Clear the spatial reference when processing starts.
-        table.clearSpatialReferences();
-        PointId idx = 0;
-        PointRef point(table, idx);
-        point_count_t pointLimit = table.capacity();
-
-        // When we get false back from a reader, we're done, so set
-        // the point limit to the number of points processed in this loop
-        // of the table.
-        for (PointId idx = 0; idx < pointLimit; idx++)
-        {
-            point.setPointId(idx);
-            finished = !reader->processOne(point);
-            if (finished)
-                pointLimit = idx;
-        }
-        srs = reader->getSpatialReference();
-        if (!srs.empty())
-            table.setSpatialReference(srs);
-
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
-        for (Stage *s : filters)
+        try
         {
-            for (PointId idx = 0; idx < pointLimit; idx++)
+            bool isReader = (pos == 0);
+            for (point_count_t chunk = 0; ; chunk = (chunk + 1) % depth)
             {
-                if (skips[idx])
-                    continue;
-                point.setPointId(idx);
-                if (!s->processOne(point))
-                    skips[idx] = true;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]()
+                        { return abort || nextStage[chunk] == pos; });
+                    if (abort)
+                        return;
+                }
+
+                PointRange range(table, chunk * chunkSize, chunkSize);
+                SelectionVector& sel = sels[chunk];
+                bool last;
+                if (isReader)
+                {
+                    range.selectAll(sel);
+                    last = !s->l_processBatch(range, sel);
+                }
+                else
+                {
+                    last = lastChunk[chunk];
+                    if (!sel.empty())
+                        s->l_processBatch(range, sel);
+                }
+                if (pos + 1 == numStages)
+                {
+                    count += sel.size();
+                    table.resetChunk(chunk * chunkSize, chunkSize);
+                }
+
+                // Hand the chunk to the next stage.  After the last stage,
+                // the chunk goes back to the reader to be refilled.
+                std::unique_lock<std::mutex> lock(mutex);
+                if (isReader)
+                    lastChunk[chunk] = last;
+                nextStage[chunk] = (pos + 1) % numStages;
+                cv.notify_all();
+                if (last)
+                    return;
             }
-            srs = s->getSpatialReference();
-            if (!srs.empty())
-                table.setSpatialReference(srs);
         }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            abort = true;
+            cv.notify_all();
+        }
+    };
 
-        // Yes, vector<bool> is terrible.  Can do something better later.
-        for (size_t i = 0; i < skips.size(); ++i)
-            skips[i] = false;
-        table.reset();
-    }
-
+    std::vector<std::thread> threads;
+    size_t pos = 0;
     for (Stage *s : stages)
-        s->done(table);
+        threads.push_back(std::thread(runStage, s, pos++));
+    for (auto& t : threads)
+        t.join();
+    if (error)
+        std::rethrow_exception(error);
+    return count;
 }
 
 
-void Stage::l_initialize(PointTableRef table)
+// Every stage accepts the 'threads' option, so note when a stage didn't
+// use it.  Stages that can run views concurrently use it whenever they're
+// given more than one view.
+void Stage::logUnusedThreads() const
 {
-    m_metadata = table.metadata().add(getName());
+    if (m_threads != 1 && !m_threadsUsed && !supportsConcurrentRun())
+        log()->get(LogLevel::Debug) << getName() << ": Ignoring the "
+            "'threads' option.  The stage doesn't use threads.\n";
 }
 
 
@@ -311,6 +682,13 @@ void Stage::l_processOptions(const Options& options)
 {
     m_debug = options.getValueOrDefault<bool>("debug", false);
     m_verbose = options.getValueOrDefault<uint32_t>("verbose", 0);
+    m_threads = options.getValueOrDefault<uint32_t>("threads", 1);
+    if (options.getValueOrDefault<bool>("stats", false))
+        m_stats.reset(new StageStats);
+    else
+        m_stats.reset();
+    if (m_threads == 0)
+        m_threads = (std::max)(1u, std::thread::hardware_concurrency());
     if (m_debug && !m_verbose)
         m_verbose = 1;
 
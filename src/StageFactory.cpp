@@ -39,6 +39,7 @@
 // filters
 #include <chipper/ChipperFilter.hpp>
 #include <colorization/ColorizationFilter.hpp>
+#include <compact/CompactFilter.hpp>
 #include <crop/CropFilter.hpp>
 #include <decimation/DecimationFilter.hpp>
 #include <divider/DividerFilter.hpp>
@@ -193,6 +194,7 @@ StageFactory::StageFactory(bool no_plugins)
     // filters
     PluginManager::initializePlugin(ChipperFilter_InitPlugin);
     PluginManager::initializePlugin(ColorizationFilter_InitPlugin);
+    PluginManager::initializePlugin(CompactFilter_InitPlugin);
     PluginManager::initializePlugin(CropFilter_InitPlugin);
     PluginManager::initializePlugin(DecimationFilter_InitPlugin);
     PluginManager::initializePlugin(DividerFilter_InitPlugin);
@@ -34,9 +34,11 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 
 #include <pdal/Stage.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -48,17 +50,45 @@ public:
         m_stage(s), m_view(view)
     {}
 
-    // For now this is all synchronous
-    void run()
-        { m_viewSet = m_stage->run(m_view); }
+    // Run the stage on the view.  If a pool is provided, the run is
+    // queued to the pool and the caller must wait() for the result.
+    void run(ThreadPool *pool = NULL)
+    {
+        if (!pool)
+        {
+            m_viewSet = timedRun();
+            return;
+        }
 
+        typedef std::packaged_task<PointViewSet()> Task;
+        std::shared_ptr<Task> task(new Task(
+            [this](){ return timedRun(); }));
+        m_future = task->get_future();
+        pool->add([task](){ (*task)(); });
+    }
+
+    // Exceptions thrown by an asynchronous run are rethrown here.
     PointViewSet wait()
-        { return m_viewSet; }
+    {
+        if (m_future.valid())
+            m_viewSet = m_future.get();
+        return m_viewSet;
+    }
+
+    PointViewPtr view() const
+        { return m_view; }
 
 private:
+    PointViewSet timedRun()
+    {
+        StageStats::Timer timer(m_stage->m_stats.get(), false, true);
+        return m_stage->run(m_view);
+    }
+
     Stage *m_stage;
     PointViewPtr m_view;
     PointViewSet m_viewSet;
+    std::future<PointViewSet> m_future;
 };
 typedef std::shared_ptr<StageRunner> StageRunnerPtr;
 
@@ -0,0 +1,141 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/StageStats.hpp>
+
+#include <algorithm>
+#include <ctime>
+
+namespace pdal
+{
+
+StageStats::Timer::Timer(StageStats *stats, bool wall, bool cpu) :
+    m_stats(stats), m_wall(wall), m_cpu(cpu), m_cpuStart(0)
+{
+    if (!m_stats)
+        return;
+    if (m_wall)
+        m_wallStart = std::chrono::steady_clock::now();
+    if (m_cpu)
+        m_cpuStart = threadCpuTime();
+}
+
+
+StageStats::Timer::~Timer()
+{
+    if (!m_stats)
+        return;
+
+    double wall = 0;
+    double cpu = 0;
+    if (m_wall)
+        wall = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - m_wallStart).count();
+    if (m_cpu)
+        cpu = threadCpuTime() - m_cpuStart;
+    m_stats->addTime(wall, cpu);
+}
+
+
+// Windows has no per-thread CPU clock in the standard library, so the
+// process clock is used there.  It's only accurate when a single stage is
+// running at a time.
+double StageStats::threadCpuTime()
+{
+#ifdef _WIN32
+    return (double)std::clock() / CLOCKS_PER_SEC;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+
+void StageStats::addTime(double wall, double cpu)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wallTime += wall;
+    m_cpuTime += cpu;
+}
+
+
+void StageStats::addPoints(uint64_t in, uint64_t out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pointsIn += in;
+    m_pointsOut += out;
+}
+
+
+void StageStats::addBytesRead(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytesRead += bytes;
+}
+
+
+void StageStats::addBytesWritten(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytesWritten += bytes;
+}
+
+
+void StageStats::updateMemory(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peakMemory = (std::max)(m_peakMemory, bytes);
+}
+
+
+void StageStats::toMetadata(MetadataNode node) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    MetadataNode stats = node.findChild("stats");
+    if (!stats.valid())
+        stats = node.add("stats");
+    stats.addOrUpdate("wall_time", m_wallTime);
+    stats.addOrUpdate("cpu_time", m_cpuTime);
+    stats.addOrUpdate("points_in", m_pointsIn);
+    stats.addOrUpdate("points_out", m_pointsOut);
+    stats.addOrUpdate("bytes_read", m_bytesRead);
+    stats.addOrUpdate("bytes_written", m_bytesWritten);
+    stats.addOrUpdate("peak_memory", m_peakMemory);
+}
+
+} // namespace pdal
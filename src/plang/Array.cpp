@@ -153,7 +153,8 @@ void Array::update(PointViewPtr view)
     std::vector<npy_intp> strides(dims.size());
 
 
-    DataPtr pdata( new std::vector<uint8_t>(view->pointSize()* view->size(), 0));
+    const size_t pointSize = view->layout()->packedPointSize();
+    DataPtr pdata( new std::vector<uint8_t>(pointSize * view->size(), 0));
 
     PyArray_Descr *dtype(0);
     PyObject * dtype_dict = (PyObject*)buildNumpyDescription(view);
@@ -184,7 +185,7 @@ void Array::update(PointViewPtr view)
     DimTypeList types = view->dimTypes();
     for (PointId idx = 0; idx < view->size(); idx++)
     {
-        p = sp + (view->pointSize() * idx);
+        p = sp + (pointSize * idx);
         view->getPackedPoint(types, idx, (char*)p);
     }
 
@@ -60,17 +60,19 @@ void BufferedInvocation::begin(PointView& view, MetadataNode m)
     for (auto di = dims.begin(); di != dims.end(); ++di)
     {
         Dimension::Id::Enum d = *di;
-        const Dimension::Detail *dd = layout->dimDetail(d);
-        void *data = malloc(dd->size() * view.size());
+        // Scaled dimensions are passed as doubles.
+        Dimension::Type::Enum type = layout->dimType(d);
+        size_t size = layout->dimSize(d);
+        void *data = malloc(size * view.size());
         m_buffers.push_back(data);  // Hold pointer for deallocation
         char *p = (char *)data;
         for (PointId idx = 0; idx < view.size(); ++idx)
         {
-            view.getFieldInternal(d, idx, (void *)p);
-            p += dd->size();
+            view.getField(p, d, type, idx);
+            p += size;
         }
         std::string name = layout->dimName(*di);
-        insertArgument(name, (uint8_t *)data, dd->type(), view.size());
+        insertArgument(name, (uint8_t *)data, type, view.size());
     }
     Py_XDECREF(m_metaIn);
     m_metaIn = plang::fromMetadata(m);
@@ -93,7 +95,7 @@ void BufferedInvocation::end(PointView& view, MetadataNode m)
     for (auto di = dims.begin(); di != dims.end(); ++di)
     {
         Dimension::Id::Enum d = *di;
-        const Dimension::Detail *dd = layout->dimDetail(d);
+        Dimension::Type::Enum type = layout->dimType(d);
         std::string name = layout->dimName(*di);
         auto found = std::find(names.begin(), names.end(), name);
         if (found == names.end()) continue; // didn't have this dim in the names
@@ -101,12 +103,12 @@ void BufferedInvocation::end(PointView& view, MetadataNode m)
         assert(name == *found);
         assert(hasOutputVariable(name));
 
-        size_t size = dd->size();
-        void *data = extractResult(name, dd->type());
+        size_t size = layout->dimSize(d);
+        void *data = extractResult(name, type);
         char *p = (char *)data;
         for (PointId idx = 0; idx < view.size(); ++idx)
         {
-            view.setField(d, dd->type(), idx, (void *)p);
+            view.setField(d, type, idx, (void *)p);
             p += size;
         }
     }
@@ -34,6 +34,14 @@
 
 #include <sys/stat.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -349,6 +357,64 @@ std::string extension(const std::string& filename)
     return filename.substr(idx);
 }
 
+
+MapContext mapFile(const std::string& filename, bool sequential)
+{
+    MapContext ctx;
+
+#ifdef _WIN32
+    (void)filename;
+    (void)sequential;
+    ctx.m_error = "Memory mapping of files isn't supported on this platform.";
+#else
+    ctx.m_fd = open(filename.c_str(), O_RDONLY);
+    if (ctx.m_fd == -1)
+    {
+        ctx.m_error = "Unable to open '" + filename + "': " +
+            strerror(errno) + ".";
+        return ctx;
+    }
+
+    struct stat sbuf;
+    if (fstat(ctx.m_fd, &sbuf) != 0 || sbuf.st_size == 0)
+    {
+        ctx.m_error = "Unable to map empty or unreadable file '" +
+            filename + "'.";
+        close(ctx.m_fd);
+        ctx.m_fd = -1;
+        return ctx;
+    }
+    ctx.m_size = sbuf.st_size;
+
+    void *addr = mmap(NULL, ctx.m_size, PROT_READ, MAP_SHARED, ctx.m_fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        ctx.m_error = "Unable to map '" + filename + "': " +
+            strerror(errno) + ".";
+        close(ctx.m_fd);
+        ctx.m_fd = -1;
+        ctx.m_size = 0;
+        return ctx;
+    }
+    ctx.m_addr = addr;
+    if (sequential)
+        posix_madvise(addr, ctx.m_size, POSIX_MADV_SEQUENTIAL);
+#endif
+    return ctx;
+}
+
+
+MapContext unmapFile(MapContext ctx)
+{
+#ifndef _WIN32
+    if (ctx.m_addr)
+        munmap(ctx.m_addr, ctx.m_size);
+    if (ctx.m_fd != -1)
+        close(ctx.m_fd);
+#endif
+    return MapContext();
+}
+
 } // namespace FileUtils
 
 } // namespace pdal
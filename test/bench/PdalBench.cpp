@@ -0,0 +1,620 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+// Throughput benchmarks for the core point storage, the common readers,
+// writers and filters, and the streaming executor.  All input is generated
+// by readers.faux with a fixed seed, so runs are repeatable and need
+// nothing beyond a build tree.  Results are printed as a table and can be
+// written as JSON for tracking across releases.
+
+#include <pdal/KDIndex.hpp>
+#include <pdal/Metadata.hpp>
+#include <pdal/PDALUtils.hpp>
+#include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <pdal/pdal_config.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/ProgramArgs.hpp>
+#include <BufferReader.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pdal;
+
+namespace
+{
+
+const uint32_t c_seed = 20160101;
+
+// A single benchmark.  'setup' runs before each repetition and isn't
+// timed; 'body' is timed and returns the number of points (or queries)
+// it processed.
+struct Case
+{
+    std::string name;
+    std::function<void()> setup;
+    std::function<point_count_t()> body;
+};
+
+
+struct Result
+{
+    std::string name;
+    point_count_t points;
+    std::vector<double> seconds;
+
+    double min() const
+        { return *std::min_element(seconds.begin(), seconds.end()); }
+    double median() const
+    {
+        std::vector<double> s(seconds);
+        std::sort(s.begin(), s.end());
+        size_t mid = s.size() / 2;
+        return (s.size() % 2) ? s[mid] : (s[mid - 1] + s[mid]) / 2;
+    }
+    double mean() const
+    {
+        double total = 0;
+        for (double s : seconds)
+            total += s;
+        return total / seconds.size();
+    }
+    double rate() const
+    {
+        double m = median();
+        return m > 0 ? points / m : 0;
+    }
+};
+
+
+class Bench
+{
+public:
+    Bench(point_count_t count, int repeat, const std::string& tempdir) :
+        m_count(count), m_repeat(std::max(repeat, 1)), m_tempdir(tempdir)
+    {}
+
+    point_count_t count() const
+        { return m_count; }
+
+    std::string temppath(const std::string& file)
+    {
+        std::string path = m_tempdir + "/pdal_bench_" + file;
+        m_files.push_back(path);
+        return path;
+    }
+
+    void cleanup()
+    {
+        for (auto& f : m_files)
+            FileUtils::deleteFile(f);
+        m_files.clear();
+    }
+
+    // Stages are owned by the caller so that they, and any views they
+    // hold, go away with the table they were run against.
+    std::unique_ptr<Stage> stage(const std::string& type,
+        const Options& options, Stage *input = nullptr)
+    {
+        std::unique_ptr<Stage> s(m_factory.createStage(type));
+        if (!s)
+            throw pdal_error("pdal_bench: stage '" + type +
+                "' isn't available.");
+        s->setOptions(options);
+        if (input)
+            s->setInput(*input);
+        return s;
+    }
+
+    // Fills a table with faux points.  Every call with the same bounds
+    // produces the same points.
+    PointViewPtr generate(PointTableRef table, const BOX3D& bounds)
+    {
+        Options opts;
+        opts.add("bounds", bounds);
+        opts.add("count", m_count);
+        opts.add("mode", "uniform");
+        opts.add("seed", c_seed);
+        opts.add("number_of_returns", 3);
+        std::unique_ptr<Stage> faux(stage("readers.faux", opts));
+        faux->prepare(table);
+        PointViewSet set = faux->execute(table);
+        return *set.begin();
+    }
+
+    PointViewPtr generate(PointTableRef table)
+        { return generate(table, BOX3D(0, 0, 0, 1000, 1000, 100)); }
+
+    Result run(const Case& c)
+    {
+        using namespace std::chrono;
+
+        Result r;
+        r.name = c.name;
+        r.points = 0;
+        // The first pass warms caches and creates any input files.
+        for (int i = 0; i <= m_repeat; ++i)
+        {
+            if (c.setup)
+                c.setup();
+            auto start = steady_clock::now();
+            point_count_t points = c.body();
+            duration<double> elapsed = steady_clock::now() - start;
+            if (i == 0)
+                continue;
+            r.points = points;
+            r.seconds.push_back(elapsed.count());
+        }
+        return r;
+    }
+
+private:
+    point_count_t m_count;
+    int m_repeat;
+    std::string m_tempdir;
+    std::vector<std::string> m_files;
+    StageFactory m_factory;
+};
+
+
+// Writes the generated points through 'writer' to 'file' and reads them back
+// with 'reader', adding a case for each direction.
+void addFileCases(Bench& b, std::vector<Case>& cases, const std::string& name,
+    const std::string& writer, const std::string& reader,
+    const std::string& file, const Options& writerOpts)
+{
+    struct State
+    {
+        std::unique_ptr<PointTable> table;
+        PointViewPtr view;
+        bool written;
+    };
+    std::shared_ptr<State> s(new State);
+    s->written = false;
+    const std::string filename = b.temppath(file);
+
+    auto write = [&b, s, writer, writerOpts, filename]()
+    {
+        BufferReader buf;
+        buf.addView(s->view);
+        Options opts(writerOpts);
+        opts.add("filename", filename);
+        std::unique_ptr<Stage> w(b.stage(writer, opts, &buf));
+        w->prepare(*s->table);
+        w->execute(*s->table);
+        s->written = true;
+        return s->view->size();
+    };
+
+    Case w;
+    w.name = name + ".write";
+    w.setup = [&b, s]()
+    {
+        s->table.reset(new PointTable);
+        s->view = b.generate(*s->table);
+    };
+    w.body = write;
+    cases.push_back(w);
+
+    Case r;
+    r.name = name + ".read";
+    r.setup = [&b, s, w, write]()
+    {
+        if (!s->written)
+        {
+            w.setup();
+            write();
+        }
+        s->table.reset(new PointTable);
+        s->view.reset();
+    };
+    r.body = [&b, s, reader, filename]()
+    {
+        Options opts;
+        opts.add("filename", filename);
+        std::unique_ptr<Stage> rd(b.stage(reader, opts));
+        rd->prepare(*s->table);
+        PointViewSet set = rd->execute(*s->table);
+        return (*set.begin())->size();
+    };
+    cases.push_back(r);
+}
+
+
+// Runs a filter over freshly generated points.
+Case filterCase(Bench& b, const std::string& name, const std::string& filter,
+    const Options& opts, const BOX3D& bounds = BOX3D(0, 0, 0, 1000, 1000, 100))
+{
+    struct State
+    {
+        std::unique_ptr<PointTable> table;
+        PointViewPtr view;
+    };
+    std::shared_ptr<State> s(new State);
+
+    Case c;
+    c.name = name;
+    c.setup = [&b, s, bounds]()
+    {
+        s->table.reset(new PointTable);
+        s->view = b.generate(*s->table, bounds);
+    };
+    c.body = [&b, s, filter, opts]()
+    {
+        BufferReader buf;
+        buf.addView(s->view);
+        std::unique_ptr<Stage> f(b.stage(filter, opts, &buf));
+        f->prepare(*s->table);
+        f->execute(*s->table);
+        return s->view->size();
+    };
+    return c;
+}
+
+
+std::vector<Case> allCases(Bench& b)
+{
+    std::vector<Case> cases;
+
+    // Point storage.
+    {
+        struct State
+        {
+            std::unique_ptr<PointTable> table;
+            PointViewPtr view;
+        };
+        std::shared_ptr<State> s(new State);
+
+        Case alloc;
+        alloc.name = "table.alloc";
+        alloc.body = [&b]()
+        {
+            PointTable table;
+            PointLayoutPtr layout(table.layout());
+            layout->registerDims({ Dimension::Id::X, Dimension::Id::Y,
+                Dimension::Id::Z, Dimension::Id::Intensity,
+                Dimension::Id::GpsTime });
+            layout->finalize();
+            PointView view(table);
+            for (PointId i = 0; i < b.count(); ++i)
+                view.setField(Dimension::Id::Intensity, i, 0);
+            return view.size();
+        };
+        cases.push_back(alloc);
+
+        auto setup = [&b, s]()
+        {
+            if (s->view)
+                return;
+            s->table.reset(new PointTable);
+            s->view = b.generate(*s->table);
+        };
+
+        Case set;
+        set.name = "field.set";
+        set.setup = setup;
+        set.body = [s]()
+        {
+            PointView& v = *s->view;
+            for (PointId i = 0; i < v.size(); ++i)
+            {
+                v.setField(Dimension::Id::X, i, i * .5);
+                v.setField(Dimension::Id::Y, i, i * .25);
+                v.setField(Dimension::Id::Z, i, (double)(i % 100));
+                v.setField(Dimension::Id::ReturnNumber, i, 1);
+            }
+            return v.size();
+        };
+        cases.push_back(set);
+
+        Case get;
+        get.name = "field.get";
+        get.setup = setup;
+        get.body = [s]()
+        {
+            PointView& v = *s->view;
+            double sum = 0;
+            for (PointId i = 0; i < v.size(); ++i)
+            {
+                sum += v.getFieldAs<double>(Dimension::Id::X, i);
+                sum += v.getFieldAs<double>(Dimension::Id::Y, i);
+                sum += v.getFieldAs<double>(Dimension::Id::Z, i);
+                sum += v.getFieldAs<int>(Dimension::Id::ReturnNumber, i);
+            }
+            // Keep the loop from being optimized away.
+            volatile double keep = sum;
+            (void)keep;
+            return v.size();
+        };
+        cases.push_back(get);
+    }
+
+    // File formats.
+    for (int format : { 0, 1, 2, 3, 6, 7, 8 })
+    {
+        Options opts;
+        opts.add("dataformat_id", format);
+        opts.add("minor_version", format > 5 ? 4 : 2);
+        std::string name = "las.pf" + std::to_string(format);
+        addFileCases(b, cases, name, "writers.las", "readers.las",
+            name + ".las", opts);
+#if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
+        // LAZperf only handles the legacy point formats.
+#ifdef PDAL_HAVE_LASZIP
+        opts.add("compression", "laszip");
+#else
+        if (format > 5)
+            continue;
+        opts.add("compression", "lazperf");
+#endif
+        name = "laz.pf" + std::to_string(format);
+        addFileCases(b, cases, name, "writers.las", "readers.las",
+            name + ".laz", opts);
+#endif
+    }
+    addFileCases(b, cases, "bpf", "writers.bpf", "readers.bpf", "bench.bpf",
+        Options());
+    {
+        Options opts;
+        opts.add("order", "X,Y,Z,ReturnNumber,NumberOfReturns,OffsetTime");
+        opts.add("keep_unspecified", false);
+        addFileCases(b, cases, "text", "writers.text", "readers.text",
+            "bench.txt", opts);
+    }
+
+    // Filters.
+    {
+        Options opts;
+        opts.add("dimension", "X");
+        cases.push_back(filterCase(b, "sort", "filters.sort", opts));
+    }
+    {
+        Options opts;
+        opts.add("capacity", 5000);
+        cases.push_back(filterCase(b, "chipper", "filters.chipper", opts));
+    }
+    {
+        Options opts;
+        opts.add("bounds", BOX2D(250, 250, 750, 750));
+        cases.push_back(filterCase(b, "crop", "filters.crop", opts));
+    }
+    {
+        Options opts;
+        opts.add("in_srs", "EPSG:4326");
+        opts.add("out_srs", "EPSG:3857");
+        cases.push_back(filterCase(b, "reprojection", "filters.reprojection",
+            opts, BOX3D(-120, 30, 0, -110, 40, 100)));
+    }
+
+    // Spatial index.
+    {
+        struct State
+        {
+            std::unique_ptr<PointTable> table;
+            PointViewPtr view;
+            std::unique_ptr<KD3Index> index;
+        };
+        std::shared_ptr<State> s(new State);
+
+        auto setup = [&b, s]()
+        {
+            if (s->view)
+                return;
+            s->table.reset(new PointTable);
+            s->view = b.generate(*s->table);
+        };
+
+        Case build;
+        build.name = "kdindex.build";
+        build.setup = setup;
+        build.body = [s]()
+        {
+            s->index.reset(new KD3Index(*s->view));
+            s->index->build();
+            return s->view->size();
+        };
+        cases.push_back(build);
+
+        Case query;
+        query.name = "kdindex.query";
+        query.setup = [s, setup]()
+        {
+            setup();
+            if (!s->index)
+            {
+                s->index.reset(new KD3Index(*s->view));
+                s->index->build();
+            }
+        };
+        query.body = [s]()
+        {
+            std::mt19937 gen(c_seed);
+            std::uniform_real_distribution<double> xy(0, 1000);
+            std::uniform_real_distribution<double> z(0, 100);
+            point_count_t queries = std::max(s->view->size() / 10, 1u);
+            for (point_count_t i = 0; i < queries; ++i)
+                s->index->neighbors(xy(gen), xy(gen), z(gen), 8);
+            return queries;
+        };
+        cases.push_back(query);
+    }
+
+    // Streaming, serial and with the chunk pipeline.
+    for (point_count_t depth : { 1u, 4u })
+    {
+        Case c;
+        c.name = "stream.depth" + std::to_string(depth);
+        c.body = [&b, depth]()
+        {
+            Options fauxOpts;
+            fauxOpts.add("bounds", BOX3D(0, 0, 0, 1000, 1000, 100));
+            fauxOpts.add("count", b.count());
+            fauxOpts.add("mode", "uniform");
+            fauxOpts.add("seed", c_seed);
+            std::unique_ptr<Stage> faux(b.stage("readers.faux", fauxOpts));
+
+            Options cropOpts;
+            cropOpts.add("bounds", BOX2D(0, 0, 500, 1000));
+            std::unique_ptr<Stage> crop(
+                b.stage("filters.crop", cropOpts, faux.get()));
+
+            std::unique_ptr<Stage> writer(
+                b.stage("writers.null", Options(), crop.get()));
+
+            FixedPointTable table(10000, depth);
+            writer->prepare(table);
+            writer->execute(table);
+            return b.count();
+        };
+        cases.push_back(c);
+    }
+
+    return cases;
+}
+
+} // unnamed namespace
+
+
+int main(int argc, char *argv[])
+{
+    point_count_t count;
+    int repeat;
+    std::string filter;
+    std::string output;
+    std::string tempdir;
+    bool list;
+    bool help;
+
+    ProgramArgs args;
+    args.add("count", "Number of points per benchmark", count,
+        (point_count_t)1000000);
+    args.add("repeat", "Timed repetitions per benchmark", repeat, 5);
+    args.add("filter", "Only run benchmarks whose name contains this string",
+        filter);
+    args.add("output", "Write results as JSON to this file", output);
+    args.add("tempdir", "Directory for generated files", tempdir,
+        std::string("."));
+    args.add("list", "List benchmarks and exit", list);
+    args.add("help,h", "Print this message", help);
+
+    try
+    {
+        std::vector<std::string> s(argv + 1, argv + argc);
+        args.parse(s);
+    }
+    catch (arg_error& e)
+    {
+        std::cerr << "pdal_bench: " << e.m_error << std::endl;
+        return 1;
+    }
+    if (help)
+    {
+        std::cout << "usage: pdal_bench [options]" << std::endl;
+        args.dump(std::cout, 2, 80);
+        return 0;
+    }
+
+    Bench bench(count, repeat, tempdir);
+    std::vector<Case> all = allCases(bench);
+
+    MetadataNode root;
+    root.add("pdal_version", GetFullVersionString());
+    root.add("points", count);
+    root.add("repeat", repeat);
+
+    if (!list)
+        std::cout << std::left << std::setw(18) << "benchmark" <<
+            std::right << std::setw(12) << "points" << std::setw(12) <<
+            "min (s)" << std::setw(12) << "median (s)" << std::setw(14) <<
+            "Mpts/s" << std::endl;
+    int status = 0;
+    for (const Case& c : all)
+    {
+        if (c.name.find(filter) == std::string::npos)
+            continue;
+        if (list)
+        {
+            std::cout << c.name << std::endl;
+            continue;
+        }
+
+        try
+        {
+            Result r = bench.run(c);
+            std::cout << std::left << std::setw(18) << r.name <<
+                std::right << std::setw(12) << r.points <<
+                std::fixed << std::setprecision(4) <<
+                std::setw(12) << r.min() << std::setw(12) << r.median() <<
+                std::setw(14) << r.rate() / 1e6 << std::endl;
+
+            MetadataNode n = root.addList("benchmark");
+            n.add("name", r.name);
+            n.add("points", r.points);
+            n.add("min", r.min());
+            n.add("median", r.median());
+            n.add("mean", r.mean());
+            n.add("points_per_second", r.rate());
+        }
+        catch (pdal_error& e)
+        {
+            std::cerr << c.name << ": " << e.what() << std::endl;
+            status = 1;
+        }
+    }
+
+    bench.cleanup();
+
+    if (output.size())
+    {
+        std::ostream *out = FileUtils::createFile(output, false);
+        if (!out)
+        {
+            std::cerr << "pdal_bench: can't create '" << output << "'." <<
+                std::endl;
+            return 1;
+        }
+        Utils::toJSON(root, *out);
+        FileUtils::closeFile(out);
+    }
+    return status;
+}
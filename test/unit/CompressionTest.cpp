@@ -283,3 +283,103 @@ TEST(Compression, types)
 //     BOOST_CHECK_EQUAL(r, 26u);
 // }
 
+
+
+// Points written in chunks by the VLR compressor come back, in order, from
+// the parallel chunk decompressor, whatever the prefetch window.
+TEST(Compression, chunks)
+{
+    using namespace laszip;
+
+    factory::record_schema schema;
+    schema.push(factory::record_item::POINT10);
+    io::laz_vlr zipvlr = io::laz_vlr::from_schema(schema);
+    zipvlr.chunk_size = 100;
+    std::vector<char> vlrData(zipvlr.size());
+    zipvlr.extract(vlrData.data());
+
+    const point_count_t numPoints = 1050;
+    const size_t pointSize = schema.size_in_bytes();
+    std::mt19937 gen(1);
+    std::vector<char> points(numPoints * pointSize);
+    for (char& c : points)
+        c = (char)gen();
+
+    // Leave room for a header and the chunk table offset.
+    const std::streamoff pointOffset = 10;
+    std::stringstream ss;
+    ss << std::string(pointOffset + sizeof(int64_t), ' ');
+    ss.seekp(pointOffset);
+    LazPerfVlrCompressor compressor(ss, schema, zipvlr.chunk_size);
+    for (point_count_t i = 0; i < numPoints; ++i)
+        compressor.compress(points.data() + i * pointSize);
+    compressor.done();
+
+    std::vector<LazChunk> chunks = readLazChunkTable(ss, pointOffset,
+        zipvlr.chunk_size, numPoints);
+    ss.clear();
+    ASSERT_EQ(chunks.size(), 11u);
+    EXPECT_EQ(chunks[0].offset, pointOffset + (std::streamoff)sizeof(int64_t));
+    EXPECT_EQ(chunks[0].count, 100u);
+    EXPECT_EQ(chunks[10].count, 50u);
+
+    for (size_t window : { 1, 3, 20 })
+    {
+        LazPerfChunkDecompressor decompressor(ss, vlrData.data(), chunks, 4,
+            window);
+        std::vector<char> out;
+        while (std::vector<char> *buf = decompressor.next())
+            out.insert(out.end(), buf->begin(), buf->end());
+        EXPECT_TRUE(out == points);
+    }
+
+    // A table that doesn't match the point count isn't used.
+    EXPECT_EQ(readLazChunkTable(ss, pointOffset, zipvlr.chunk_size,
+        numPoints * 2).size(), 0u);
+}
+
+
+// Compressing chunks in parallel produces the same bytes as the serial
+// compressor, however the points are handed over.
+TEST(Compression, parallelChunks)
+{
+    using namespace laszip;
+
+    factory::record_schema schema;
+    schema.push(factory::record_item::POINT10);
+    schema.push(factory::record_item::GPSTIME);
+    const uint32_t chunkSize = 100;
+    const point_count_t numPoints = 1234;
+    const size_t pointSize = schema.size_in_bytes();
+
+    std::mt19937 gen(2);
+    std::vector<char> points(numPoints * pointSize);
+    for (char& c : points)
+        c = (char)gen();
+
+    const std::streamoff pointOffset = 10;
+    std::stringstream serial;
+    serial << std::string(pointOffset + sizeof(int64_t), ' ');
+    serial.seekp(pointOffset);
+    LazPerfVlrCompressor compressor(serial, schema, chunkSize);
+    for (point_count_t i = 0; i < numPoints; ++i)
+        compressor.compress(points.data() + i * pointSize);
+    compressor.done();
+
+    for (point_count_t batch : { 1, 37, 100, 5000 })
+    {
+        std::stringstream parallel;
+        parallel << std::string(pointOffset, ' ');
+        LazPerfChunkCompressor chunkCompressor(parallel, schema, chunkSize,
+            4, 3);
+        for (point_count_t i = 0; i < numPoints; i += batch)
+            chunkCompressor.compress(points.data() + i * pointSize,
+                (std::min)(batch, numPoints - i));
+        chunkCompressor.done();
+        EXPECT_TRUE(parallel.str() == serial.str()) << "Batch of " << batch;
+    }
+
+    std::vector<LazChunk> chunks = readLazChunkTable(serial, pointOffset,
+        chunkSize, numPoints);
+    EXPECT_EQ(chunks.size(), 13u);
+}
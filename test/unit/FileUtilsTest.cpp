@@ -210,3 +210,25 @@ TEST(FileUtilsTest, stem)
     EXPECT_EQ(FileUtils::stem("."), ".");
     EXPECT_EQ(FileUtils::stem(".."), "..");
 }
+
+TEST(FileUtilsTest, map)
+{
+    const std::string filename(Support::datapath("las/simple.las"));
+
+    FileUtils::MapContext ctx = FileUtils::mapFile(filename, true);
+#ifdef _WIN32
+    EXPECT_TRUE(ctx.addr() == NULL);
+    EXPECT_NE(ctx.what(), "");
+#else
+    ASSERT_TRUE(ctx.addr() != NULL) << ctx.what();
+    EXPECT_EQ(ctx.size(), FileUtils::fileSize(filename));
+    EXPECT_EQ(memcmp(ctx.addr(), "LASF", 4), 0);
+    ctx = FileUtils::unmapFile(ctx);
+    EXPECT_TRUE(ctx.addr() == NULL);
+    EXPECT_EQ(ctx.what(), "");
+#endif
+
+    ctx = FileUtils::mapFile(Support::temppath("nonexistent.foo"));
+    EXPECT_TRUE(ctx.addr() == NULL);
+    EXPECT_NE(ctx.what(), "");
+}
@@ -36,9 +36,48 @@
 #include <pdal/Options.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
 #include <FauxReader.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
 
 //ABELL - Need some tests here, but what we had was crap.
+
+namespace
+{
+
+std::string runFaux(uint32_t threads)
+{
+    std::string filename = Support::temppath("faux.log");
+    {
+        Options ops;
+        ops.add("bounds", BOX3D(1, 2, 3, 101, 102, 103));
+        ops.add("mode", "constant");
+        ops.add("count", 10);
+        ops.add("threads", threads);
+        ops.add("verbose", (int)LogLevel::Debug);
+        ops.add("log", filename);
+
+        FauxReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        reader.execute(table);
+    }
+    std::string contents = FileUtils::readFileIntoString(filename);
+    FileUtils::deleteFile(filename);
+    return contents;
+}
+
+} // unnamed namespace
+
+// The 'threads' option is accepted by every stage, so a stage that ignores
+// it says so.
+TEST(LogTest, unusedThreads)
+{
+    const std::string msg("Ignoring the 'threads' option");
+    EXPECT_NE(runFaux(2).find(msg), std::string::npos);
+    EXPECT_EQ(runFaux(1).find(msg), std::string::npos);
+}
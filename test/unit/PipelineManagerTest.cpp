@@ -71,6 +71,177 @@ TEST(PipelineManagerTest, basic)
 }
 
 
+// Every stage supports streaming, so the points shouldn't be stored.
+TEST(PipelineManagerTest, memoryBudgetStream)
+{
+    const std::string outfile(Support::temppath("budget.las"));
+    FileUtils::deleteFile(outfile);
+
+    PipelineManager mgr;
+    mgr.setMemoryBudget(1024 * 1024);
+
+    Options optsR;
+    optsR.add("filename", Support::datapath("las/1.2-with-color.las"));
+    Stage& reader = mgr.addReader("readers.las");
+    reader.setOptions(optsR);
+
+    Options optsW;
+    optsW.add("filename", outfile);
+    Stage& writer = mgr.addWriter("writers.las");
+    writer.setInput(reader);
+    writer.setOptions(optsW);
+
+    EXPECT_EQ(mgr.execute(), 1065U);
+    EXPECT_TRUE(mgr.streamed());
+    EXPECT_TRUE(mgr.views().empty());
+    FixedPointTable *table =
+        dynamic_cast<FixedPointTable *>(&mgr.pointTable());
+    ASSERT_TRUE(table);
+    // Stages only run on separate threads when that's asked for.
+    EXPECT_EQ(table->pipelineDepth(), 1u);
+
+    PipelineManager mgr2;
+    Stage& check = mgr2.addReader("readers.las");
+    check.setOptions(Options(Option("filename", outfile)));
+    EXPECT_EQ(mgr2.execute(), 1065U);
+    FileUtils::deleteFile(outfile);
+}
+
+
+// Sorting needs all the points, so they're stored in a scratch file.
+TEST(PipelineManagerTest, memoryBudgetSpill)
+{
+    const std::string outfile(Support::temppath("budget.las"));
+    FileUtils::deleteFile(outfile);
+
+    PipelineManager mgr;
+    mgr.setMemoryBudget(1024 * 1024, Support::temppath());
+
+    Options optsR;
+    optsR.add("filename", Support::datapath("las/1.2-with-color.las"));
+    Stage& reader = mgr.addReader("readers.las");
+    reader.setOptions(optsR);
+
+    Options optsS;
+    optsS.add("dimension", "X");
+    Stage& sort = mgr.addFilter("filters.sort");
+    sort.setInput(reader);
+    sort.setOptions(optsS);
+
+    Options optsW;
+    optsW.add("filename", outfile);
+    Stage& writer = mgr.addWriter("writers.las");
+    writer.setInput(sort);
+    writer.setOptions(optsW);
+
+    EXPECT_EQ(mgr.execute(), 1065U);
+    EXPECT_FALSE(mgr.streamed());
+    EXPECT_TRUE(dynamic_cast<MappedPointTable *>(&mgr.pointTable()));
+    FileUtils::deleteFile(outfile);
+}
+
+// The shape of the streaming table can be given in the pipeline XML.
+TEST(PipelineManagerTest, streamChunks)
+{
+    const std::string outfile(Support::temppath("budget.las"));
+    FileUtils::deleteFile(outfile);
+
+    std::ostringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+        "<Pipeline version=\"1.0\" memory_budget=\"1\" "
+            "stream_chunk=\"100\" stream_depth=\"3\">"
+          "<Writer type=\"writers.las\">"
+            "<Option name=\"filename\">" << outfile << "</Option>"
+            "<Reader type=\"readers.las\">"
+              "<Option name=\"filename\">" <<
+                Support::datapath("las/1.2-with-color.las") << "</Option>"
+            "</Reader>"
+          "</Writer>"
+        "</Pipeline>";
+
+    PipelineManager mgr;
+    std::istringstream in(xml.str());
+    mgr.readPipeline(in);
+    EXPECT_EQ(mgr.streamChunkSize(), 100u);
+    EXPECT_EQ(mgr.streamDepth(), 3u);
+
+    EXPECT_EQ(mgr.execute(), 1065U);
+    EXPECT_TRUE(mgr.streamed());
+    FixedPointTable *table =
+        dynamic_cast<FixedPointTable *>(&mgr.pointTable());
+    ASSERT_TRUE(table);
+    EXPECT_EQ(table->capacity(), 300u);
+    EXPECT_EQ(table->pipelineDepth(), 3u);
+
+    PipelineManager mgr2;
+    Stage& check = mgr2.addReader("readers.las");
+    check.setOptions(Options(Option("filename", outfile)));
+    EXPECT_EQ(mgr2.execute(), 1065U);
+    FileUtils::deleteFile(outfile);
+
+    std::string bad(xml.str());
+    bad.replace(bad.find("stream_depth=\"3\""), 16, "stream_depth=\"0\"");
+    PipelineManager mgr3;
+    std::istringstream badIn(bad);
+    EXPECT_THROW(mgr3.readPipeline(badIn), pdal_error);
+}
+
+// A budget given in the pipeline XML applies to a manager that was handed
+// a table, though points aren't moved out of the caller's table.
+TEST(PipelineManagerTest, memoryBudgetXml)
+{
+    const std::string outfile(Support::temppath("budget.las"));
+    FileUtils::deleteFile(outfile);
+
+    auto pipeline = [&outfile](const std::string& filter)
+    {
+        std::ostringstream xml;
+        xml << "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+            "<Pipeline version=\"1.0\" memory_budget=\"1\">"
+              "<Writer type=\"writers.las\">"
+                "<Option name=\"filename\">" << outfile << "</Option>" <<
+                filter <<
+                "<Reader type=\"readers.las\">"
+                  "<Option name=\"filename\">" <<
+                    Support::datapath("las/1.2-with-color.las") <<
+                  "</Option>"
+                "</Reader>" <<
+                (filter.size() ? "</Filter>" : "") <<
+              "</Writer>"
+            "</Pipeline>";
+        return xml.str();
+    };
+
+    PointTable table;
+    PipelineManager mgr(table);
+    std::istringstream in(pipeline(""));
+    mgr.readPipeline(in);
+    EXPECT_EQ(mgr.memoryBudget(), 1024u * 1024u);
+    EXPECT_EQ(mgr.execute(), 1065U);
+    EXPECT_TRUE(mgr.streamed());
+    EXPECT_TRUE(dynamic_cast<FixedPointTable *>(&mgr.pointTable()));
+    FileUtils::deleteFile(outfile);
+
+    PointTable table2;
+    PipelineManager mgr2(table2);
+    std::istringstream in2(pipeline("<Filter type=\"filters.sort\">"
+        "<Option name=\"dimension\">X</Option>"));
+    mgr2.readPipeline(in2);
+    EXPECT_EQ(mgr2.execute(), 1065U);
+    EXPECT_FALSE(mgr2.streamed());
+    EXPECT_EQ(&mgr2.pointTable(), &table2);
+    FileUtils::deleteFile(outfile);
+
+    // Without a table of its own, the manager spills to a scratch file.
+    PipelineManager mgr3;
+    std::istringstream in3(pipeline("<Filter type=\"filters.sort\">"
+        "<Option name=\"dimension\">X</Option>"));
+    mgr3.readPipeline(in3);
+    EXPECT_EQ(mgr3.execute(), 1065U);
+    EXPECT_TRUE(dynamic_cast<MappedPointTable *>(&mgr3.pointTable()));
+    FileUtils::deleteFile(outfile);
+}
+
 //ABELL - Mosaic
 /**
 TEST(PipelineManagerTest, PipelineManagerTest_test2)
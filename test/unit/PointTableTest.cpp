@@ -34,6 +34,7 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <pdal/BlockPool.hpp>
 #include <pdal/PointTable.hpp>
 #include <las/LasReader.hpp>
 #include "Support.hpp"
@@ -178,3 +179,284 @@ TEST(PointTable, userView)
     EXPECT_TRUE(called);
 }
 
+
+TEST(PointTable, columnTable)
+{
+    LasReader reader;
+
+    Options opts;
+    opts.add("filename", Support::datapath("las/simple.las"));
+
+    reader.setOptions(opts);
+
+    PointTable rowTable;
+    reader.prepare(rowTable);
+    PointViewSet viewSet = reader.execute(rowTable);
+    PointViewPtr rowView = *viewSet.begin();
+
+    ColumnPointTable colTable;
+    reader.prepare(colTable);
+    viewSet = reader.execute(colTable);
+    PointViewPtr colView = *viewSet.begin();
+
+    EXPECT_EQ(rowView->size(), colView->size());
+    EXPECT_EQ(rowView->dims().size(), colView->dims().size());
+    for (PointId idx = 0; idx < rowView->size(); ++idx)
+        for (auto d : rowView->dims())
+            EXPECT_EQ(rowView->getFieldAs<double>(d, idx),
+                colView->getFieldAs<double>(d, idx));
+}
+
+TEST(PointTable, columnTableBlocks)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+    layout->registerDim(Id::Classification);
+
+    PointView view(table);
+
+    // Cross a block boundary to make sure columns in each block are
+    // addressed properly.
+    const point_count_t cnt = 70000;
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        view.setField(Id::X, i, i * 1.5);
+        view.setField(Id::Intensity, i, (uint16_t)(i % 65000));
+        view.setField(Id::Classification, i, (uint8_t)(i % 32));
+    }
+
+    EXPECT_EQ(view.size(), cnt);
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, i), i * 1.5);
+        EXPECT_EQ(view.getFieldAs<uint16_t>(Id::Intensity, i), i % 65000);
+        EXPECT_EQ(view.getFieldAs<uint8_t>(Id::Classification, i), i % 32);
+    }
+}
+
+TEST(PointTable, columnTableGetPoint)
+{
+    using namespace Dimension;
+
+    ColumnPointTable table;
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+
+    PointView view(table);
+    for (PointId i = 0; i < 3; ++i)
+    {
+        view.setField(Id::X, i, i * 1.5);
+        view.setField(Id::Intensity, i, (uint16_t)(i + 100));
+    }
+
+    // The point is gathered into a row laid out by the dimension offsets.
+    for (PointId i = 0; i < 3; ++i)
+    {
+        char *p = view.getPoint(i);
+        ASSERT_TRUE(p);
+
+        double x;
+        uint16_t intensity;
+        memcpy(&x, p + layout->dimOffset(Id::X), sizeof(x));
+        memcpy(&intensity, p + layout->dimOffset(Id::Intensity),
+            sizeof(intensity));
+        EXPECT_DOUBLE_EQ(x, i * 1.5);
+        EXPECT_EQ(intensity, i + 100);
+    }
+}
+
+TEST(PointTable, mappedTable)
+{
+    using namespace Dimension;
+
+    // Keep only a single block in memory so that earlier blocks must be
+    // paged back in from the scratch file.
+    MappedPointTable table(Support::temppath(), 1);
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+
+    PointView view(table);
+
+    const point_count_t cnt = 200000;
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        view.setField(Id::X, i, i * 1.5);
+        view.setField(Id::Intensity, i, (uint16_t)(i % 65000));
+    }
+
+    EXPECT_EQ(view.size(), cnt);
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, i), i * 1.5);
+        EXPECT_EQ(view.getFieldAs<uint16_t>(Id::Intensity, i), i % 65000);
+    }
+    EXPECT_THROW(MappedPointTable("/nonexistent/directory"), pdal_error);
+}
+
+#ifdef PDAL_HAVE_LAZPERF
+TEST(PointTable, compressedTable)
+{
+    using namespace Dimension;
+
+    CompressedPointTable table(1);
+    PointLayoutPtr layout(table.layout());
+
+    layout->registerDim(Id::X);
+    layout->registerDim(Id::Intensity);
+    layout->registerDim(Id::Classification);
+
+    PointView view(table);
+
+    // Four blocks, only one of which is held uncompressed at a time.
+    const point_count_t cnt = 200000;
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        view.setField(Id::X, i, i * 1.5);
+        view.setField(Id::Intensity, i, (uint16_t)(i % 65000));
+    }
+    EXPECT_EQ(table.residentBlocks(), 1u);
+    EXPECT_GT(table.compressedSize(), 0u);
+    EXPECT_LT(table.compressedSize(), (uint64_t)cnt * layout->pointSize());
+    // Each new block is allocated before the previous one is evicted.
+    EXPECT_GE(table.peakMemoryUsed(),
+        2 * (uint64_t)65536 * layout->pointSize());
+
+    // Modify points, working back to the first block.  Each block is
+    // decompressed, changed and compressed again.
+    for (PointId i = 0; i < cnt; i += 7)
+    {
+        PointId j = cnt - 1 - i;
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, j), j * 1.5);
+        view.setField(Id::Classification, j, 2);
+    }
+    EXPECT_EQ(table.residentBlocks(), 1u);
+
+    EXPECT_EQ(view.size(), cnt);
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, i), i * 1.5);
+        EXPECT_EQ(view.getFieldAs<uint16_t>(Id::Intensity, i), i % 65000);
+        EXPECT_EQ(view.getFieldAs<int>(Id::Classification, i),
+            (cnt - 1 - i) % 7 == 0 ? 2 : 0);
+    }
+}
+#endif
+
+TEST(PointTable, blockPool)
+{
+    BlockPool& pool = BlockPool::instance();
+
+    // Only a little memory is held once tables are gone unless asked for.
+    EXPECT_EQ(pool.capacity(), 16u * 1024 * 1024);
+
+    const size_t size = 65536 * 10;
+    char *block = pool.allocate(size);
+    for (size_t i = 0; i < size; ++i)
+        EXPECT_EQ(block[i], 0);
+    memset(block, 1, size);
+    pool.release(block, size);
+
+    // A recycled block is only cleared if requested.
+    char *block2 = pool.allocate(size, false);
+    EXPECT_EQ(block, block2);
+    EXPECT_EQ(block2[size - 1], 1);
+    pool.release(block2, size);
+    block2 = pool.allocate(size);
+    EXPECT_EQ(block, block2);
+    for (size_t i = 0; i < size; ++i)
+        EXPECT_EQ(block2[i], 0);
+    pool.release(block2, size);
+    pool.clear();
+}
+
+// Make sure points in a recycled block are cleared when the stage adding
+// them doesn't set every dimension.
+TEST(PointTable, recycledBlocks)
+{
+    using namespace Dimension;
+
+    const point_count_t cnt = 70000;
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        PointTable table;
+        PointLayoutPtr layout(table.layout());
+
+        layout->registerDim(Id::X);
+        layout->registerDim(Id::Intensity);
+
+        // On the middle pass, points are added as if by a stage that
+        // initializes every dimension.
+        table.setPointsInitialized(pass == 1);
+        PointView view(table);
+        for (PointId i = 0; i < cnt; ++i)
+        {
+            view.setField(Id::X, i, i * 1.5);
+            if (pass != 2)
+                view.setField(Id::Intensity, i, (uint16_t)(i % 65000 + 1));
+        }
+        table.setPointsInitialized(false);
+
+        for (PointId i = 0; i < cnt; ++i)
+        {
+            EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, i), i * 1.5);
+            EXPECT_EQ(view.getFieldAs<uint16_t>(Id::Intensity, i),
+                pass == 2 ? 0 : i % 65000 + 1);
+        }
+    }
+}
+
+TEST(PointTable, compact)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    table.layout()->registerDim(Id::X);
+    table.layout()->registerDim(Id::Y);
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 100000; ++i)
+    {
+        view->setField(Id::X, i, (double)i);
+        view->setField(Id::Y, i, (double)i);
+    }
+
+    std::vector<PointId> ids1 { 90000, 10, 50 };
+    std::vector<PointId> ids2 { 50, 60 };
+    PointViewPtr v1 = view->select(ids1);
+    PointViewPtr v2 = view->select(ids2);
+    view.reset();
+
+    uint64_t used = table.memoryUsed();
+    EXPECT_EQ(table.peakMemoryUsed(), used);
+    EXPECT_TRUE(table.compact(1.0));
+    EXPECT_FALSE(table.compact(1.0));
+
+    // The memory freed by compaction is still counted in the peak, along
+    // with the new block that was held while the points were copied.
+    EXPECT_LT(table.memoryUsed(), used);
+    EXPECT_EQ(table.peakMemoryUsed(), used + table.memoryUsed());
+    EXPECT_EQ(v1->getFieldAs<double>(Id::X, 0), 90000.0);
+    EXPECT_EQ(v1->getFieldAs<double>(Id::X, 1), 10.0);
+    EXPECT_EQ(v1->getFieldAs<double>(Id::X, 2), 50.0);
+    EXPECT_EQ(v2->getFieldAs<double>(Id::X, 0), 50.0);
+    EXPECT_EQ(v2->getFieldAs<double>(Id::X, 1), 60.0);
+
+    // Views still share points after compaction.
+    v1->setField(Id::X, 2, 500.0);
+    EXPECT_EQ(v2->getFieldAs<double>(Id::X, 0), 500.0);
+
+    // Points added after compaction start out zeroed.
+    v2->setField(Id::X, 2, 1.0);
+    EXPECT_EQ(v2->size(), 3u);
+    EXPECT_EQ(v2->getFieldAs<double>(Id::Y, 1), 60.0);
+    EXPECT_EQ(v2->getFieldAs<double>(Id::Y, 2), 0.0);
+}
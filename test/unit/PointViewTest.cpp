@@ -142,6 +142,197 @@ TEST(PointViewTest, getAsInt32)
 }
 
 
+TEST(PointViewTest, getFieldArray)
+{
+    PointTable table;
+    PointViewPtr view = makeTestView(table);
+
+    std::vector<double> x(17);
+    std::vector<int32_t> y(17);
+    view->getFieldArray(Dimension::Id::Classification, 0, 17, x.data());
+    view->getFieldArray(Dimension::Id::X, 0, 17, y.data());
+    for (int i = 0; i < 17; i++)
+    {
+        EXPECT_DOUBLE_EQ(x[i], i + 1.0);
+        EXPECT_EQ(y[i], i * 10);
+    }
+
+    // Non-contiguous points and a partial range.
+    PointViewPtr v2 = view->makeNew();
+    for (PointId i = 0; i < view->size(); i += 2)
+        v2->appendPoint(*view, i);
+    std::vector<uint8_t> c(4);
+    v2->getFieldArray(Dimension::Id::Classification, 2, 4, c.data());
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(c[i], (2 * (i + 2)) + 1u);
+
+    std::vector<uint8_t> z(17);
+    EXPECT_THROW(view->getFieldArray(Dimension::Id::Y, 0, 17, z.data()),
+        pdal_error);
+}
+
+TEST(PointViewTest, setFieldArray)
+{
+    PointTable table;
+    PointViewPtr view = makeTestView(table);
+
+    // Overwrite existing points and append new ones.
+    std::vector<double> x(20);
+    for (int i = 0; i < 20; i++)
+        x[i] = i * 2.0;
+    view->setFieldArray(Dimension::Id::X, 10, 20, x.data());
+    EXPECT_EQ(view->size(), 30u);
+    for (int i = 0; i < 10; i++)
+        EXPECT_EQ(view->getFieldAs<int32_t>(Dimension::Id::X, i), i * 10);
+    for (int i = 10; i < 30; i++)
+        EXPECT_EQ(view->getFieldAs<int32_t>(Dimension::Id::X, i),
+            (i - 10) * 2);
+
+    std::vector<int> c { 1, 2, 1000 };
+    EXPECT_THROW(view->setFieldArray(Dimension::Id::Classification, 0, 3,
+        c.data()), pdal_error);
+    EXPECT_THROW(view->setFieldArray(Dimension::Id::Classification, 31, 3,
+        c.data()), pdal_error);
+
+    // Points added for a failed conversion are removed.
+    EXPECT_THROW(view->setFieldArray(Dimension::Id::Classification, 29, 3,
+        c.data()), pdal_error);
+    EXPECT_EQ(view->size(), 30u);
+}
+
+namespace
+{
+
+// A table that keeps X in its own storage and has no raw points.
+template<typename BASE>
+class ListTable : public BASE
+{
+public:
+    ListTable()
+        { BASE::layout()->registerDim(Dimension::Id::X); }
+
+private:
+    std::vector<double> m_x;
+
+    PointId addPoint()
+    {
+        m_x.push_back(0);
+        return m_x.size() - 1;
+    }
+    char *getPoint(PointId /*idx*/)
+        { return NULL; }
+    void setFieldInternal(Dimension::Id::Enum /*id*/, PointId idx,
+        const void *value)
+        { m_x[idx] = *(const double *)value; }
+    void getFieldInternal(Dimension::Id::Enum /*id*/, PointId idx,
+        void *value) const
+        { *(double *)value = m_x[idx]; }
+};
+
+template<typename TABLE>
+void testListTable()
+{
+    TABLE table;
+    PointView view(table);
+
+    std::vector<int> in { 1, 2, 3, 4 };
+    view.setFieldArray(Dimension::Id::X, 0, 4, in.data());
+    EXPECT_EQ(view.size(), 4u);
+
+    std::vector<int> out(4);
+    view.getFieldArray(Dimension::Id::X, 0, 4, out.data());
+    EXPECT_EQ(in, out);
+}
+
+} // unnamed namespace
+
+// Tables without raw points are accessed through their field interface.
+TEST(PointViewTest, fieldArrayNoRawPoints)
+{
+    testListTable<ListTable<PointTable>>();
+    testListTable<ListTable<MappedPointTable>>();
+}
+
+TEST(PointViewTest, fieldArrayColumnTable)
+{
+    ColumnPointTable table;
+    PointViewPtr view = makeTestView(table, 100);
+
+    std::vector<float> y(100);
+    view->getFieldArray(Dimension::Id::Y, 0, 100, y.data());
+    for (int i = 0; i < 100; i++)
+        EXPECT_FLOAT_EQ(y[i], i * 100.0f);
+    for (int i = 0; i < 100; i++)
+        y[i] = i * 3.0f;
+    view->setFieldArray(Dimension::Id::Y, 0, 100, y.data());
+    for (int i = 0; i < 100; i++)
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::Y, i),
+            i * 3.0);
+}
+
+TEST(PointViewTest, dimAccessor)
+{
+    auto test = [](PointTableRef table)
+    {
+        PointViewPtr view = makeTestView(table);
+        PointLayoutPtr layout = table.layout();
+
+        DimAccessor<double> x(layout, Dimension::Id::X);
+        DimAccessor<int> cls(layout, Dimension::Id::Classification);
+        DimAccessor<uint8_t> y(layout, Dimension::Id::Y);
+        DimAccessor<double> z(layout, Dimension::Id::Z);
+        TypedDimAccessor<int, uint8_t> tcls(layout,
+            Dimension::Id::Classification);
+        TypedDimAccessor<double, double> tx(layout, Dimension::Id::X);
+        EXPECT_EQ(x.type(), Dimension::Type::Double);
+        EXPECT_THROW((TypedDimAccessor<double, float>(layout,
+            Dimension::Id::X)), pdal_error);
+
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            PointRef point(view->point(i));
+            EXPECT_DOUBLE_EQ(x.get(point), i * 10.0);
+            EXPECT_EQ(cls.get(point), (int)i + 1);
+            EXPECT_DOUBLE_EQ(z.get(point), 0.0);
+            if (i < 3)
+                EXPECT_EQ(y.get(point), i * 100u);
+            else
+                EXPECT_THROW(y.get(point), pdal_error);
+
+            x.set(point, i * 2.0);
+            cls.set(point, 1000);  // Out of range - ignored.
+            EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::X, i), (int)i * 2);
+            EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::Classification, i),
+                (int)i + 1);
+            EXPECT_EQ(tcls.get(point), (int)i + 1);
+            EXPECT_DOUBLE_EQ(tx.get(point), i * 2.0);
+            tx.set(point, i * 4.0);
+            EXPECT_DOUBLE_EQ(x.get(point), i * 4.0);
+            tcls.set(point, 1000);  // Out of range - ignored.
+            EXPECT_EQ(tcls.get(point), (int)i + 1);
+            tcls.set(point, -1);  // Out of range - ignored.
+            EXPECT_EQ(tcls.get(point), (int)i + 1);
+        }
+
+        // Values that don't fit the requested type throw.
+        TypedDimAccessor<uint8_t, double> tx8(layout, Dimension::Id::X);
+        PointRef last(view->point(view->size() - 1));
+        tx.set(last, 1000.0);
+        EXPECT_THROW(tx8.get(last), pdal_error);
+
+        // Setting the point past the end adds a point.
+        PointRef point(view->point(view->size()));
+        x.set(point, 25.0);
+        EXPECT_EQ(view->size(), 18u);
+        EXPECT_DOUBLE_EQ(view->getFieldAs<double>(Dimension::Id::X, 17), 25.0);
+    };
+
+    PointTable table;
+    test(table);
+    ColumnPointTable colTable;
+    test(colTable);
+}
+
 TEST(PointViewTest, getFloat)
 {
     PointTable table;
@@ -432,6 +623,219 @@ TEST(PointViewTest, order)
     }
 }
 
+TEST(PointViewTest, index)
+{
+    PointViewIndex index;
+
+    // Sequential IDs are kept as a range.
+    for (PointId i = 10; i < 20; ++i)
+        index.push_back(i);
+    EXPECT_FALSE(index.isExplicit());
+    EXPECT_EQ(index.size(), 10u);
+    EXPECT_EQ(index[3], 13u);
+    EXPECT_EQ(index.run(2, 8), 8u);
+
+    PointViewIndex tail;
+    tail.push_back(20);
+    tail.push_back(21);
+    index.append(tail, tail.size());
+    EXPECT_FALSE(index.isExplicit());
+    EXPECT_EQ(index.size(), 12u);
+    EXPECT_EQ(index[11], 21u);
+
+    // Setting an entry to its current value doesn't change the form.
+    index.set(4, 14);
+    EXPECT_FALSE(index.isExplicit());
+
+    index.set(4, 100);
+    EXPECT_TRUE(index.isExplicit());
+    EXPECT_EQ(index.size(), 12u);
+    EXPECT_EQ(index[3], 13u);
+    EXPECT_EQ(index[4], 100u);
+    EXPECT_EQ(index[5], 15u);
+    EXPECT_EQ(index.run(0, 12), 4u);
+    EXPECT_EQ(index.run(5, 7), 7u);
+
+    index.truncate(5);
+    EXPECT_EQ(index.size(), 5u);
+    index.append(index, index.size());
+    EXPECT_EQ(index.size(), 10u);
+    EXPECT_EQ(index[9], 100u);
+}
+
+TEST(PointViewTest, appendRange)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointViewPtr view = makeTestView(table, 40);
+
+    // Append points out of order and then in order, so that the new view
+    // is stored both ways.
+    PointViewPtr odd(new PointView(table));
+    PointViewPtr even(new PointView(table));
+    for (PointId i = 0; i < view->size(); ++i)
+        if (i % 2)
+            odd->appendPoint(*view, i);
+    for (PointId i = 0; i < view->size(); i += 2)
+        even->appendPoint(*view, i);
+    even->append(*odd);
+    view->append(*view);
+
+    EXPECT_EQ(even->size(), 40u);
+    EXPECT_EQ(view->size(), 80u);
+    for (PointId i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(even->getFieldAs<uint8_t>(Id::Classification, i),
+            view->getFieldAs<uint8_t>(Id::Classification, i * 2));
+        EXPECT_EQ(even->getFieldAs<uint8_t>(Id::Classification, i + 20),
+            view->getFieldAs<uint8_t>(Id::Classification, i * 2 + 1));
+    }
+    for (PointId i = 0; i < 40; ++i)
+        EXPECT_EQ(view->getFieldAs<double>(Id::X, i),
+            view->getFieldAs<double>(Id::X, i + 40));
+
+    std::vector<double> x(40);
+    even->getFieldArray(Id::X, 0, 40, x.data());
+    for (PointId i = 0; i < 40; ++i)
+        EXPECT_EQ(x[i], even->getFieldAs<double>(Id::X, i));
+}
+
+TEST(PointViewTest, sliceSelect)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointViewPtr view = makeTestView(table, 40);
+
+    PointViewPtr slice = view->slice(10, 30);
+    EXPECT_EQ(slice->size(), 20u);
+    for (PointId i = 0; i < slice->size(); ++i)
+        EXPECT_EQ(slice->getFieldAs<double>(Id::X, i),
+            view->getFieldAs<double>(Id::X, i + 10));
+    EXPECT_THROW(view->slice(30, 41), pdal_error);
+
+    std::vector<PointId> ids { 39, 0, 5, 6, 7 };
+    PointViewPtr sel = view->select(ids);
+    EXPECT_EQ(sel->size(), ids.size());
+    for (PointId i = 0; i < sel->size(); ++i)
+        EXPECT_EQ(sel->getFieldAs<double>(Id::X, i),
+            view->getFieldAs<double>(Id::X, ids[i]));
+
+    // Slices of a reordered view share its index until either changes.
+    PointViewPtr sub = sel->slice(1, 4);
+    sel->appendPoints(*view, { 1, 2 });
+    sub->appendPoint(*view, 20);
+    EXPECT_EQ(sel->size(), 7u);
+    EXPECT_EQ(sub->size(), 4u);
+    EXPECT_EQ(sel->getFieldAs<double>(Id::X, 5),
+        view->getFieldAs<double>(Id::X, 1));
+    EXPECT_EQ(sub->getFieldAs<double>(Id::X, 0),
+        view->getFieldAs<double>(Id::X, 0));
+    EXPECT_EQ(sub->getFieldAs<double>(Id::X, 2),
+        view->getFieldAs<double>(Id::X, 6));
+    EXPECT_EQ(sub->getFieldAs<double>(Id::X, 3),
+        view->getFieldAs<double>(Id::X, 20));
+    sel->setField(Id::X, 1, 1000.0);
+    EXPECT_EQ(sub->getFieldAs<double>(Id::X, 0), 1000.0);
+}
+
+TEST(PointViewTest, scaledDims)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerScaledDim(Id::X, XForm(.01, 1000));
+    layout->registerScaledDim(Id::Y, XForm(.01, 1000));
+    layout->registerDim(Id::Z);
+    EXPECT_EQ(layout->dimType(Id::X), Type::Double);
+    EXPECT_EQ(layout->dimSize(Id::X), 8u);
+    EXPECT_EQ(layout->pointSize(), 16u);
+    EXPECT_TRUE(layout->dimDetail(Id::X)->scaled());
+
+    // Registering with a different scaling stores the dimension as a double.
+    layout->registerScaledDim(Id::Y, XForm(.001, 1000));
+    EXPECT_FALSE(layout->dimDetail(Id::Y)->scaled());
+    EXPECT_EQ(layout->dimDetail(Id::Y)->type(), Type::Double);
+    EXPECT_EQ(layout->pointSize(), 20u);
+
+    PointView view(table);
+    view.setField(Id::X, 0, 1234.56);
+    view.setField(Id::X, 1, 999.99);
+    view.setField(Id::X, 2, 1000);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 0), 1234.56);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 1), 999.99);
+    EXPECT_EQ(view.getFieldAs<int>(Id::X, 2), 1000);
+    EXPECT_THROW(view.setField(Id::X, 3, 1e9), pdal_error);
+
+    double x[3];
+    view.getFieldArray(Id::X, 0, 3, x);
+    EXPECT_DOUBLE_EQ(x[0], 1234.56);
+    EXPECT_DOUBLE_EQ(x[1], 999.99);
+    EXPECT_DOUBLE_EQ(x[2], 1000.0);
+    x[2] = 1000.5;
+    view.setFieldArray(Id::X, 2, 1, x + 2);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 2), 1000.5);
+
+    PointRef point(view, 0);
+    EXPECT_DOUBLE_EQ(point.getFieldAs<double>(Id::X), 1234.56);
+    point.setField(Id::X, 1111.11);
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 0), 1111.11);
+
+    DimAccessor<double> acc(layout, Id::X);
+    EXPECT_TRUE(acc.scaledAs(XForm(.01, 1000)));
+    EXPECT_FALSE(acc.scaledAs(XForm(.01, 0)));
+    EXPECT_DOUBLE_EQ(acc.get(point), 1111.11);
+    EXPECT_EQ(acc.getScaled(point), 11111);
+    acc.setScaled(point, -5);
+    EXPECT_DOUBLE_EQ(acc.get(point), 999.95);
+}
+
+TEST(PointViewTest, scaledRawAndPacked)
+{
+    using namespace Dimension;
+
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerScaledDim(Id::X, XForm(-.01, 0));
+    layout->registerDim(Id::Intensity);
+
+    PointView view(table);
+    double in[] = { 1.5, -2.25, 3.0, 0.01 };
+    view.setFieldArray(Id::X, 0, 4, in);
+    EXPECT_EQ(view.size(), 4u);
+
+    double out[4];
+    view.getFieldArray(Id::X, 0, 4, out);
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_DOUBLE_EQ(out[i], in[i]);
+
+    // Raw values are written as the reported type and size.
+    char buf[8];
+    ASSERT_EQ(view.dimSize(Id::X), sizeof(double));
+    view.getRawField(Id::X, 1, buf);
+    double d;
+    memcpy(&d, buf, sizeof(d));
+    EXPECT_DOUBLE_EQ(d, -2.25);
+
+    // Packed data uses the same layout.
+    DimTypeList types = view.dimTypes();
+    std::vector<char> packed(view.layout()->packedPointSize());
+    EXPECT_EQ(packed.size(), 10u);
+    view.getPackedPoint(types, 2, packed.data());
+    memcpy(&d, packed.data(), sizeof(d));
+    EXPECT_DOUBLE_EQ(d, 3.0);
+    d = 7.5;
+    memcpy(packed.data(), &d, sizeof(d));
+    view.setPackedPoint(types, 3, packed.data());
+    EXPECT_DOUBLE_EQ(view.getFieldAs<double>(Id::X, 3), 7.5);
+
+    // A negative scale reverses the stored order, not the value order.
+    EXPECT_TRUE(view.compare(Id::X, 1, 0));
+    EXPECT_FALSE(view.compare(Id::X, 0, 1));
+}
+
 // Per discussions with @abellgithub (https://github.com/gadomski/PDAL/commit/c1d54e56e2de841d37f2a1b1c218ed723053f6a9#commitcomment-14415138)
 // we only do bounds checking on `PointView`s when in debug mode.
 #ifndef NDEBUG
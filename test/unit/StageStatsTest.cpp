@@ -0,0 +1,203 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointTable.hpp>
+#include <FauxReader.hpp>
+#include <LasReader.hpp>
+#include <RangeFilter.hpp>
+#include <StreamCallbackFilter.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+Options fauxOptions()
+{
+    Options ops;
+    ops.add("bounds", BOX3D(0, 0, 0, 99, 99, 99));
+    ops.add("mode", "ramp");
+    ops.add("count", 100);
+    ops.add("stats", true);
+    return ops;
+}
+
+Options rangeOptions()
+{
+    Options ops;
+    ops.add("limits", "X[0:49]");
+    ops.add("stats", true);
+    return ops;
+}
+
+void checkStats(const Stage& s, uint64_t in, uint64_t out)
+{
+    const StageStats *stats = s.stats();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats->pointsIn(), in);
+    EXPECT_EQ(stats->pointsOut(), out);
+    EXPECT_GE(stats->wallTime(), 0.0);
+    EXPECT_GE(stats->cpuTime(), 0.0);
+    EXPECT_GT(stats->peakMemory(), 0u);
+
+    MetadataNode m = s.getMetadata().findChild("stats");
+    ASSERT_TRUE(m.valid());
+    EXPECT_EQ(m.findChild("points_in").value<uint64_t>(), in);
+    EXPECT_EQ(m.findChild("points_out").value<uint64_t>(), out);
+    EXPECT_EQ(m.findChild("peak_memory").value<uint64_t>(),
+        stats->peakMemory());
+}
+
+// Does enough work for each point that the CPU time of the threads is
+// easily measured.
+class BusyFilter : public Filter
+{
+public:
+    std::string getName() const
+        { return "filters.busy"; }
+
+private:
+    virtual void filter(PointView& view)
+        { filterPoints(view); }
+    virtual bool filterPoint(PointRef& point, PointState *)
+    {
+        volatile double d = point.getFieldAs<double>(Dimension::Id::X);
+        for (int i = 0; i < 500; ++i)
+            d = d * 1.0000001 + 1;
+        return true;
+    }
+};
+
+} // unnamed namespace
+
+TEST(StageStatsTest, standard)
+{
+    FauxReader reader;
+    reader.setOptions(fauxOptions());
+
+    RangeFilter range;
+    range.setOptions(rangeOptions());
+    range.setInput(reader);
+
+    // Statistics aren't collected unless asked for.
+    StreamCallbackFilter f;
+    f.setInput(range);
+
+    PointTable table;
+    f.prepare(table);
+    PointViewSet viewSet = f.execute(table);
+    EXPECT_EQ((*viewSet.begin())->size(), 50u);
+
+    checkStats(reader, 0, 100);
+    checkStats(range, 100, 50);
+    EXPECT_FALSE(f.stats());
+    EXPECT_FALSE(f.getMetadata().findChild("stats").valid());
+}
+
+TEST(StageStatsTest, stream)
+{
+    for (point_count_t depth = 1; depth <= 2; ++depth)
+    {
+        FauxReader reader;
+        reader.setOptions(fauxOptions());
+
+        RangeFilter range;
+        range.setOptions(rangeOptions());
+        range.setInput(reader);
+
+        StreamCallbackFilter f;
+        f.setCallback([](PointRef&){ return true; });
+        f.setInput(range);
+
+        FixedPointTable table(16, depth);
+        f.prepare(table);
+        EXPECT_EQ(f.execute(table), 50u);
+
+        checkStats(reader, 0, 100);
+        checkStats(range, 100, 50);
+    }
+}
+
+TEST(StageStatsTest, bytesRead)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/simple.las"));
+    ops.add("stats", true);
+
+    LasReader reader;
+    reader.setOptions(ops);
+
+    PointTable table;
+    reader.prepare(table);
+    reader.execute(table);
+
+    const StageStats *stats = reader.stats();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats->pointsOut(), 1065u);
+    EXPECT_GT(stats->bytesRead(), 1065u * 20);
+    EXPECT_EQ(stats->bytesWritten(), 0u);
+}
+
+// The range threads do all of the filter's work, so their CPU time must be
+// counted.
+TEST(StageStatsTest, workerThreads)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 99, 99, 99));
+    ro.add("mode", "ramp");
+    ro.add("count", 65536);
+
+    FauxReader reader;
+    reader.setOptions(ro);
+
+    Options fo;
+    fo.add("threads", 2);
+    fo.add("stats", true);
+
+    BusyFilter filter;
+    filter.setOptions(fo);
+    filter.setInput(reader);
+
+    PointTable table;
+    filter.prepare(table);
+    filter.execute(table);
+
+    const StageStats *stats = filter.stats();
+    ASSERT_TRUE(stats);
+    EXPECT_GT(stats->cpuTime(), stats->wallTime() / 4);
+}
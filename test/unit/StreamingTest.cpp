@@ -36,13 +36,64 @@
 
 #include <pdal/Filter.hpp>
 #include <pdal/PointTable.hpp>
+#include <pdal/PointView.hpp>
+#include <CropFilter.hpp>
 #include <FauxReader.hpp>
 #include <MergeFilter.hpp>
+#include <RangeFilter.hpp>
 #include <StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
 
+namespace
+{
+
+// Keeps points with an even X.  Only processOne() is implemented, so
+// streaming goes through the default processBatch().
+class EvenFilter : public Filter
+{
+public:
+    EvenFilter() : m_calls(0)
+    {}
+
+    std::string getName() const
+        { return "filters.even"; }
+
+    int m_calls;
+
+private:
+    virtual bool streamable() const
+        { return true; }
+    virtual bool processOne(PointRef& point)
+    {
+        m_calls++;
+        return point.getFieldAs<int>(Dimension::Id::X) % 2 == 0;
+    }
+};
+
+// Records the chunks that are handed back to be refilled.
+class ChunkTable : public FixedPointTable
+{
+public:
+    ChunkTable(point_count_t chunkSize, point_count_t depth) :
+        FixedPointTable(chunkSize, depth), m_resets(0)
+    {}
+
+    int m_resets;
+    std::vector<PointId> m_chunks;
+
+    virtual void reset()
+        { m_resets++; }
+    virtual void resetChunk(PointId first, point_count_t count)
+    {
+        EXPECT_EQ(count, 64u);
+        m_chunks.push_back(first);
+    }
+};
+
+} // unnamed namespace
+
 // This test depends on stages being executed in the order that they were
 // added to each parent.  If you change order, things will break.
 TEST(Streaming, filter)
@@ -103,6 +154,208 @@ TEST(Streaming, filter)
 
     FixedPointTable t(20);
     f.prepare(t);
-    f.execute(t);
+    EXPECT_EQ(f.execute(t), 400u);
     EXPECT_EQ(cnt, 400);
 }
+
+// Run stages concurrently on separate chunks of the table and make sure
+// that points arrive in order and that skipped points aren't passed on.
+TEST(Streaming, pipelined)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 9999, 9999, 9999));
+    ro.add("mode", "ramp");
+    ro.add("count", 10000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    StreamCallbackFilter f1;
+    auto cb1 = [](PointRef& point)
+    {
+        return point.getFieldAs<int>(Dimension::Id::X) % 2 == 0;
+    };
+    f1.setCallback(cb1);
+    f1.setInput(r);
+
+    StreamCallbackFilter f2;
+    int cnt = 0;
+    auto cb2 = [&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), cnt * 2);
+        cnt++;
+        return true;
+    };
+    f2.setCallback(cb2);
+    f2.setInput(f1);
+
+    ChunkTable t(64, 3);
+    EXPECT_EQ(t.capacity(), 192u);
+    f2.prepare(t);
+    EXPECT_EQ(f2.execute(t), 5000u);
+    EXPECT_EQ(cnt, 5000);
+
+    // Each chunk is handed back as the last stage finishes with it.
+    EXPECT_EQ(t.m_resets, 0);
+    ASSERT_EQ(t.m_chunks.size(), 157u);
+    for (size_t i = 0; i < t.m_chunks.size(); ++i)
+        EXPECT_EQ(t.m_chunks[i], (i % 3) * 64);
+}
+
+// A reader feeding two branches that are merged again should only be read
+// once, and changes made in one branch shouldn't be seen by the other.
+TEST(Streaming, sharedReader)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 99, 99, 99));
+    ro.add("mode", "ramp");
+    ro.add("count", 100);
+    FauxReader r;
+    r.setOptions(ro);
+
+    int readCnt = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&readCnt](PointRef&)
+    {
+        readCnt++;
+        return true;
+    });
+    f.setInput(r);
+
+    StreamCallbackFilter a;
+    a.setCallback([](PointRef& point)
+    {
+        int x = point.getFieldAs<int>(Dimension::Id::X);
+        point.setField(Dimension::Id::X, x + 1000);
+        return true;
+    });
+    a.setInput(f);
+
+    int bCnt = 0;
+    StreamCallbackFilter b;
+    b.setCallback([&bCnt](PointRef& point)
+    {
+        EXPECT_LT(point.getFieldAs<int>(Dimension::Id::X), 100);
+        bCnt++;
+        return true;
+    });
+    b.setInput(f);
+
+    MergeFilter m;
+    m.setInput(a);
+    m.setInput(b);
+
+    int lowCnt = 0;
+    int highCnt = 0;
+    StreamCallbackFilter w;
+    w.setCallback([&lowCnt, &highCnt](PointRef& point)
+    {
+        if (point.getFieldAs<int>(Dimension::Id::X) < 1000)
+            lowCnt++;
+        else
+            highCnt++;
+        return true;
+    });
+    w.setInput(m);
+
+    FixedPointTable t(30);
+    w.prepare(t);
+    w.execute(t);
+    EXPECT_EQ(readCnt, 100);
+    EXPECT_EQ(bCnt, 100);
+    EXPECT_EQ(lowCnt, 100);
+    EXPECT_EQ(highCnt, 100);
+}
+
+// Stages that only implement processOne() are run a point at a time by the
+// default processBatch(), for readers as well as filters, and the last
+// batch may be partly full.
+TEST(Streaming, processOne)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 104, 104, 104));
+    ro.add("mode", "ramp");
+    ro.add("count", 105);
+    FauxReader r;
+    r.setOptions(ro);
+
+    EvenFilter f;
+    f.setInput(r);
+
+    int cnt = 0;
+    StreamCallbackFilter c;
+    c.setCallback([&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), cnt * 2);
+        cnt++;
+        return true;
+    });
+    c.setInput(f);
+
+    FixedPointTable t(20);
+    c.prepare(t);
+    EXPECT_EQ(c.execute(t), 53u);
+    EXPECT_EQ(f.m_calls, 105);
+    EXPECT_EQ(cnt, 53);
+}
+
+// The selection passed from filters.range to filters.crop when streaming
+// should leave the same points as running the stages on a view.
+TEST(Streaming, selection)
+{
+    auto build = [](FauxReader& r, RangeFilter& range, CropFilter& crop)
+    {
+        Options ro;
+        ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+        ro.add("mode", "ramp");
+        ro.add("count", 1000);
+        r.setOptions(ro);
+
+        Options rangeOps;
+        rangeOps.add("limits", "X[100:800],Z[0:200],Z[400:1000]");
+        range.setOptions(rangeOps);
+        range.setInput(r);
+
+        Options cropOps;
+        cropOps.add("bounds", BOX2D(150, 150, 600, 600));
+        crop.setOptions(cropOps);
+        crop.setInput(range);
+    };
+
+    FauxReader r1;
+    RangeFilter range1;
+    CropFilter crop1;
+    build(r1, range1, crop1);
+
+    PointTable table;
+    crop1.prepare(table);
+    PointViewSet viewSet = crop1.execute(table);
+    ASSERT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+    std::vector<int> expected;
+    for (PointId i = 0; i < view->size(); ++i)
+        expected.push_back(view->getFieldAs<int>(Dimension::Id::X, i));
+    EXPECT_FALSE(expected.empty());
+
+    for (point_count_t depth : { 1, 3 })
+    {
+        FauxReader r2;
+        RangeFilter range2;
+        CropFilter crop2;
+        build(r2, range2, crop2);
+
+        std::vector<int> streamed;
+        StreamCallbackFilter c;
+        c.setCallback([&streamed](PointRef& point)
+        {
+            streamed.push_back(point.getFieldAs<int>(Dimension::Id::X));
+            return true;
+        });
+        c.setInput(crop2);
+
+        // A chunk size that doesn't divide the point count.
+        FixedPointTable t(64, depth);
+        c.prepare(t);
+        EXPECT_EQ(c.execute(t), expected.size());
+        EXPECT_EQ(streamed, expected);
+    }
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (hobu@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <CompactFilter.hpp>
+#include <DecimationFilter.hpp>
+#include <FauxReader.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+PointViewSet runCompact(PointTable& table, double threshold)
+{
+    point_count_t count = 100000;
+
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(1, 1, 1, count, count, count));
+    readerOps.add("mode", "ramp");
+    readerOps.add("num_points", count);
+
+    FauxReader r;
+    r.setOptions(readerOps);
+
+    Options decOps;
+    decOps.add("step", 50);
+
+    DecimationFilter d;
+    d.setOptions(decOps);
+    d.setInput(r);
+
+    Options compactOps;
+    compactOps.add("threshold", threshold);
+
+    CompactFilter f;
+    f.setOptions(compactOps);
+    f.setInput(d);
+
+    f.prepare(table);
+    return f.execute(table);
+}
+
+void checkView(PointViewPtr v)
+{
+    EXPECT_EQ(v->size(), 2000u);
+    for (PointId i = 0; i < v->size(); ++i)
+        EXPECT_DOUBLE_EQ(v->getFieldAs<double>(Dimension::Id::X, i),
+            1 + 50 * i);
+}
+
+} // unnamed namespace
+
+TEST(CompactFilterTest, compact)
+{
+    PointTable table;
+    PointViewSet s = runCompact(table, 1.0);
+
+    EXPECT_EQ(s.size(), 1u);
+    checkView(*s.begin());
+
+    // Every remaining point is in use.
+    EXPECT_FALSE(table.compact(1.0));
+}
+
+TEST(CompactFilterTest, threshold)
+{
+    // Two percent of the points are in use, so the table isn't compacted
+    // until asked with a higher threshold.
+    PointTable table;
+    PointViewSet s = runCompact(table, .01);
+
+    EXPECT_EQ(s.size(), 1u);
+    EXPECT_TRUE(table.compact(.05));
+    checkView(*s.begin());
+}
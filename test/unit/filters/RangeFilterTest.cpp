@@ -37,8 +37,11 @@
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
 #include <FauxReader.hpp>
+#include <LasReader.hpp>
 #include <RangeFilter.hpp>
+#include <SplitterFilter.hpp>
 #include <StreamCallbackFilter.hpp>
+#include "Support.hpp"
 
 using namespace pdal;
 
@@ -401,3 +404,120 @@ TEST(RangeFilterTest, stream_logic)
     f.execute(table);
 }
 
+// Run the range filter on many views with and without threads and make sure
+// the output is the same.
+TEST(RangeFilterTest, threads)
+{
+    auto runRange = [](PointTableRef table, uint32_t threads)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+
+        LasReader reader;
+        reader.setOptions(ops);
+
+        Options splitOps;
+        splitOps.add("length", 1000);
+
+        SplitterFilter splitter;
+        splitter.setOptions(splitOps);
+        splitter.setInput(reader);
+
+        Options rangeOps;
+        rangeOps.add("limits", "Z[420:480]");
+        rangeOps.add("threads", threads);
+
+        RangeFilter range;
+        range.setOptions(rangeOps);
+        range.setInput(splitter);
+
+        range.prepare(table);
+        return range.execute(table);
+    };
+
+    PointTable serialTable;
+    PointViewSet serial = runRange(serialTable, 1);
+    PointTable threadTable;
+    PointViewSet threaded = runRange(threadTable, 4);
+
+    EXPECT_GT(serial.size(), 1u);
+    ASSERT_EQ(serial.size(), threaded.size());
+    auto si = serial.begin();
+    auto ti = threaded.begin();
+    for (; si != serial.end(); ++si, ++ti)
+    {
+        PointViewPtr s = *si;
+        PointViewPtr t = *ti;
+        ASSERT_EQ(s->size(), t->size());
+        for (PointId i = 0; i < s->size(); ++i)
+        {
+            EXPECT_EQ(s->getFieldAs<double>(Dimension::Id::X, i),
+                t->getFieldAs<double>(Dimension::Id::X, i));
+            EXPECT_EQ(s->getFieldAs<double>(Dimension::Id::Y, i),
+                t->getFieldAs<double>(Dimension::Id::Y, i));
+            double z = t->getFieldAs<double>(Dimension::Id::Z, i);
+            EXPECT_TRUE(z >= 420 && z <= 480);
+        }
+    }
+}
+
+// Dimensions that no stage reads are dropped from the layout when the
+// pipeline ends in a writer.
+TEST(RangeFilterTest, pruneDims)
+{
+    Options ops;
+    ops.add("bounds", BOX3D(1, 101, 201, 10, 110, 210));
+    ops.add("mode", "ramp");
+    ops.add("num_points", 10);
+    ops.add("number_of_returns", 2);
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options rangeOps;
+    rangeOps.add("limits", "ReturnNumber[1:1]");
+
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(reader);
+
+    StageFactory f;
+    std::unique_ptr<Stage> writer(f.createStage("writers.null"));
+    writer->setInput(range);
+
+    PointTable table;
+    writer->prepare(table);
+    PointLayoutPtr layout = table.layout();
+    EXPECT_TRUE(layout->hasDim(Dimension::Id::X));
+    EXPECT_TRUE(layout->hasDim(Dimension::Id::Y));
+    EXPECT_TRUE(layout->hasDim(Dimension::Id::Z));
+    EXPECT_TRUE(layout->hasDim(Dimension::Id::ReturnNumber));
+    EXPECT_FALSE(layout->hasDim(Dimension::Id::NumberOfReturns));
+    EXPECT_FALSE(layout->hasDim(Dimension::Id::OffsetTime));
+    EXPECT_EQ(layout->pointSize(), 3 * sizeof(double) + 1);
+
+    PointViewSet viewSet = writer->execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+    EXPECT_EQ(view->size(), 5u);
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::ReturnNumber, i), 1);
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::X, i), (int)(2 * i + 1));
+    }
+
+    // A stage that doesn't report the dimensions it uses keeps them all.
+    FauxReader reader2;
+    reader2.setOptions(ops);
+
+    StreamCallbackFilter cb;
+    cb.setInput(reader2);
+
+    std::unique_ptr<Stage> writer2(f.createStage("writers.null"));
+    writer2->setInput(cb);
+
+    PointTable table2;
+    writer2->prepare(table2);
+    EXPECT_TRUE(table2.layout()->hasDim(Dimension::Id::OffsetTime));
+    EXPECT_TRUE(table2.layout()->hasDim(Dimension::Id::NumberOfReturns));
+}
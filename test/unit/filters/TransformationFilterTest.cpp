@@ -171,4 +171,38 @@ TEST_F(TransformationFilterTest, Rotation)
 }
 
 
+
+// Make sure that a view split among threads is transformed completely.
+TEST(TransformationFilterThreadTest, Threads)
+{
+    Options readerOpts;
+    readerOpts.add("mode", "ramp");
+    readerOpts.add("num_points", 100000);
+    readerOpts.add("bounds", BOX3D(0, 0, 0, 99999, 199998, 299997));
+    FauxReader reader;
+    reader.setOptions(readerOpts);
+
+    Options filterOpts;
+    filterOpts.add("matrix", "1 0 0 1\n0 1 0 2\n0 0 1 3\n0 0 0 1");
+    filterOpts.add("threads", 4);
+    TransformationFilter filter;
+    filter.setOptions(filterOpts);
+    filter.setInput(reader);
+
+    PointTable table;
+    filter.prepare(table);
+    PointViewSet viewSet = filter.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    EXPECT_EQ(100000u, view->size());
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(i + 1, view->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_DOUBLE_EQ(2 * i + 2,
+            view->getFieldAs<double>(Dimension::Id::Y, i));
+        EXPECT_DOUBLE_EQ(3 * i + 3,
+            view->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+}
+
 }
@@ -237,3 +237,30 @@ TEST(FauxReaderTest, one_point)
     EXPECT_EQ(2, view->getFieldAs<int>(Dimension::Id::Y, 0));
     EXPECT_EQ(3, view->getFieldAs<int>(Dimension::Id::Z, 0));
 }
+
+
+TEST(FauxReaderTest, seed)
+{
+    auto run = [](uint32_t seed)
+    {
+        Options ops;
+        ops.add("bounds", BOX3D(0, 0, 0, 100, 100, 100));
+        ops.add("count", 100);
+        ops.add("mode", "uniform");
+        ops.add("seed", seed);
+        FauxReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        PointViewPtr view = *viewSet.begin();
+        std::vector<double> xs;
+        for (PointId i = 0; i < view->size(); ++i)
+            xs.push_back(view->getFieldAs<double>(Dimension::Id::X, i));
+        return xs;
+    };
+
+    EXPECT_EQ(run(42), run(42));
+    EXPECT_NE(run(42), run(43));
+}
@@ -0,0 +1,180 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <cstring>
+#include <random>
+
+#include <pdal/util/Utils.hpp>
+#include <LasBatch.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+LasBatch::Format makeFormat(int pointFormat)
+{
+    LasBatch::Format f;
+    f.m_v14 = (pointFormat > 5);
+    f.m_hasTime = (pointFormat == 1 || pointFormat >= 3);
+    f.m_hasColor = (pointFormat == 2 || pointFormat == 3 ||
+        pointFormat == 7 || pointFormat == 8);
+    f.m_hasInfrared = (pointFormat == 8);
+    f.m_x = XForm(.01, 100);
+    f.m_y = XForm(.001, -50);
+    f.m_z = XForm(.1, 0);
+    // Leave a couple of extra bytes at the end of each record.
+    f.m_pointLen = f.extraOffset() + 2;
+    return f;
+}
+
+// Random records, with the bytes the writer can't reproduce exactly
+// (the 1.4 scan angle) set to zero.
+std::vector<char> makeRecords(const LasBatch::Format& f, point_count_t count)
+{
+    std::mt19937 gen(20160315);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    std::vector<char> buf(f.m_pointLen * count);
+    for (char& c : buf)
+        c = (char)dist(gen);
+    if (f.m_v14)
+        for (point_count_t i = 0; i < count; ++i)
+            memset(buf.data() + i * f.m_pointLen + 18, 0, 2);
+    // Random bytes may not make valid doubles, which would make the
+    // comparisons below fail.
+    if (f.m_hasTime)
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            double t = i * 1.5;
+            memcpy(buf.data() + i * f.m_pointLen + f.timeOffset(), &t,
+                sizeof(t));
+        }
+    return buf;
+}
+
+} // unnamed namespace
+
+TEST(LasBatchTest, isa)
+{
+    std::vector<LasBatch::Isa> isas = LasBatch::supportedIsas();
+    EXPECT_EQ(isas.front(), LasBatch::Isa::Scalar);
+    EXPECT_EQ(isas.back(), LasBatch::bestIsa());
+    EXPECT_EQ(LasBatch::isaName(LasBatch::Isa::Avx2), "avx2");
+}
+
+// Every instruction set must decode exactly as the scalar code does, and
+// encoding what was decoded must give back the original records.
+TEST(LasBatchTest, roundTrip)
+{
+    // An odd count leaves some points for the scalar tail of each kernel.
+    const point_count_t count = 1003;
+
+    for (int pointFormat : { 0, 1, 2, 3, 6, 7, 8 })
+    {
+        LasBatch::Format f = makeFormat(pointFormat);
+        std::vector<char> in = makeRecords(f, count);
+
+        LasBatch::Columns ref;
+        LasBatch::decode(f, in.data(), count, ref, true,
+            LasBatch::Isa::Scalar);
+
+        // Spot check the scalar decode.
+        int32_t xi;
+        memcpy(&xi, in.data() + 5 * f.m_pointLen, sizeof(xi));
+        EXPECT_EQ(ref.xi[5], xi);
+        EXPECT_DOUBLE_EQ(ref.x[5], xi * .01 + 100);
+        uint8_t flags = (uint8_t)in[5 * f.m_pointLen + 14];
+        if (f.m_v14)
+            EXPECT_EQ(ref.numReturns[5], flags >> 4);
+        else
+            EXPECT_EQ(ref.numReturns[5], (flags >> 3) & 0x07);
+
+        for (LasBatch::Isa isa : LasBatch::supportedIsas())
+        {
+            LasBatch::Columns c;
+            LasBatch::decode(f, in.data(), count, c, true, isa);
+            EXPECT_EQ(c.x, ref.x) << LasBatch::isaName(isa);
+            EXPECT_EQ(c.y, ref.y) << LasBatch::isaName(isa);
+            EXPECT_EQ(c.z, ref.z) << LasBatch::isaName(isa);
+            EXPECT_EQ(c.returnNum, ref.returnNum);
+            EXPECT_EQ(c.numReturns, ref.numReturns);
+            EXPECT_EQ(c.classFlags, ref.classFlags);
+            EXPECT_EQ(c.scanChannel, ref.scanChannel);
+            EXPECT_EQ(c.scanDirFlag, ref.scanDirFlag);
+            EXPECT_EQ(c.flight, ref.flight);
+            EXPECT_EQ(c.scanAngle, ref.scanAngle);
+            EXPECT_EQ(c.gpsTime, ref.gpsTime);
+            EXPECT_EQ(c.infrared, ref.infrared);
+
+            // Extra bytes aren't written, so start with a copy.
+            std::vector<char> out(in);
+            for (size_t i = 0; i < count; ++i)
+                memset(out.data() + i * f.m_pointLen, 0, f.extraOffset());
+            LasBatch::encode(f, c, count, out.data(), isa);
+            EXPECT_TRUE(out == in) << "Format " << pointFormat << " " <<
+                LasBatch::isaName(isa);
+        }
+    }
+}
+
+// Rounding and range checks must match Utils::numericCast().
+TEST(LasBatchTest, toScaled)
+{
+    XForm xform(.5, 10);
+    std::vector<double> in { 10, 11.25, 8.75, 11.75, 8.25, 9.999, -1e10,
+        10.5, 9.5, 11, 12, 1e6, -1e6, 0, 7.75, 12.25, 13.75 };
+
+    std::vector<int32_t> ref(in.size());
+    for (size_t i = 0; i < in.size(); ++i)
+        Utils::numericCast(xform.toScaled(in[i]), ref[i]);
+
+    for (LasBatch::Isa isa : LasBatch::supportedIsas())
+    {
+        std::vector<int32_t> out(in.size());
+
+        // The out-of-range value isn't checked.
+        EXPECT_FALSE(LasBatch::toScaled(xform, in.data(), in.size(),
+            out.data(), isa)) << LasBatch::isaName(isa);
+
+        in[6] = 0;
+        ref[6] = -20;
+        EXPECT_TRUE(LasBatch::toScaled(xform, in.data(), in.size(),
+            out.data(), isa)) << LasBatch::isaName(isa);
+        EXPECT_EQ(out, ref) << LasBatch::isaName(isa);
+        in[6] = -1e10;
+    }
+}
@@ -0,0 +1,177 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <fstream>
+
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/OStream.hpp>
+#include <LasIndex.hpp>
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+// Points on a 10 x 10 grid over [0, 100) x [0, 100), written row by row.
+LasIndex makeIndex(int level)
+{
+    LasIndex index(BOX2D(0, 0, 100, 100), 100, level);
+    point_count_t i = 0;
+    for (int y = 0; y < 10; ++y)
+        for (int x = 0; x < 10; ++x)
+            index.add(i++, x * 10 + 5, y * 10 + 5);
+    index.finish(0);
+    return index;
+}
+
+} // unnamed namespace
+
+TEST(LasIndexTest, level)
+{
+    EXPECT_EQ(LasIndex(BOX2D(0, 0, 1, 1), 500).level(), 0);
+    EXPECT_EQ(LasIndex(BOX2D(0, 0, 1, 1), 16000).level(), 2);
+    EXPECT_EQ(LasIndex(BOX2D(0, 0, 1, 1), 4000000000u).level(), 10);
+    EXPECT_EQ(LasIndex(BOX2D(0, 0, 1, 1), 100, 3).level(), 3);
+}
+
+TEST(LasIndexTest, query)
+{
+    // Level 1 splits the grid into four cells of 5 x 5 points.
+    LasIndex index = makeIndex(1);
+    EXPECT_EQ(index.numCells(), 4u);
+    EXPECT_EQ(index.numIntervals(), 20u);
+
+    // The lower left cell holds the first five points of the first five
+    // rows.
+    LasIndex::IntervalList list = index.query(BOX2D(0, 0, 10, 10));
+    ASSERT_EQ(list.size(), 5u);
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        EXPECT_EQ(list[i].m_begin, i * 10);
+        EXPECT_EQ(list[i].m_end, i * 10 + 5);
+    }
+
+    // The bottom two cells are the first half of the points.
+    list = index.query(BOX2D(10, 10, 90, 40));
+    ASSERT_EQ(list.size(), 1u);
+    EXPECT_EQ(list[0].m_begin, 0u);
+    EXPECT_EQ(list[0].m_end, 50u);
+
+    // Everything.
+    list = index.query(BOX2D(-1000, -1000, 1000, 1000));
+    ASSERT_EQ(list.size(), 1u);
+    EXPECT_EQ(list[0].m_end, 100u);
+
+    EXPECT_EQ(index.query(BOX2D()).size(), 0u);
+}
+
+TEST(LasIndexTest, gap)
+{
+    // Merging runs separated by five points leaves one run per cell.
+    LasIndex index(BOX2D(0, 0, 100, 100), 100, 1);
+    point_count_t i = 0;
+    for (int y = 0; y < 10; ++y)
+        for (int x = 0; x < 10; ++x)
+            index.add(i++, x * 10 + 5, y * 10 + 5);
+    index.finish(5);
+    EXPECT_EQ(index.numIntervals(), 4u);
+
+    LasIndex::IntervalList list = index.query(BOX2D(0, 0, 10, 10));
+    ASSERT_EQ(list.size(), 1u);
+    EXPECT_EQ(list[0].m_begin, 0u);
+    EXPECT_EQ(list[0].m_end, 45u);
+}
+
+TEST(LasIndexTest, readWrite)
+{
+    std::string filename = Support::temppath("index.pdx");
+    LasIndex index = makeIndex(2);
+    index.setFileSize(12345);
+    index.write(filename);
+
+    LasIndex copy;
+    copy.read(filename);
+    EXPECT_EQ(copy.numPoints(), 100u);
+    EXPECT_EQ(copy.fileSize(), 12345u);
+    EXPECT_EQ(copy.level(), 2);
+    EXPECT_EQ(copy.numCells(), index.numCells());
+    EXPECT_EQ(copy.numIntervals(), index.numIntervals());
+    EXPECT_TRUE(copy.bounds() == index.bounds());
+
+    BOX2D box(30, 30, 60, 60);
+    LasIndex::IntervalList l1 = index.query(box);
+    LasIndex::IntervalList l2 = copy.query(box);
+    ASSERT_EQ(l1.size(), l2.size());
+    for (size_t i = 0; i < l1.size(); ++i)
+    {
+        EXPECT_EQ(l1[i].m_begin, l2[i].m_begin);
+        EXPECT_EQ(l1[i].m_end, l2[i].m_end);
+    }
+    FileUtils::deleteFile(filename);
+
+    // Anything else is rejected.
+    std::ofstream out(filename);
+    out << "This is not an index.";
+    out.close();
+    EXPECT_THROW(copy.read(filename), pdal_error);
+    FileUtils::deleteFile(filename);
+
+    EXPECT_THROW(copy.read(Support::temppath("nonexistent.pdx")), pdal_error);
+}
+
+TEST(LasIndexTest, mismatch)
+{
+    LasIndex index = makeIndex(2);
+    index.setFileSize(12345);
+
+    EXPECT_EQ(index.mismatch(12345, BOX2D(0, 0, 100, 100), 100), "");
+    EXPECT_EQ(index.mismatch(12345, BOX2D(0, 0, 100, 100), 101),
+        "number of points");
+    EXPECT_EQ(index.mismatch(12346, BOX2D(0, 0, 100, 100), 100),
+        "file size");
+    EXPECT_EQ(index.mismatch(12345, BOX2D(0, 0, 100, 101), 100), "bounds");
+
+    // Indexes of other versions aren't read.
+    std::string filename = Support::temppath("index.pdx");
+    OLeStream out(filename);
+    out.put("PDIX");
+    out << (uint32_t)2;
+    out.close();
+    LasIndex other;
+    EXPECT_THROW(other.read(filename), pdal_error);
+    FileUtils::deleteFile(filename);
+}
@@ -37,7 +37,10 @@
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <LasIndex.hpp>
 #include <LasReader.hpp>
+#include <StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
 using namespace pdal;
@@ -188,6 +191,58 @@ TEST(LasReaderTest, test_sequential)
 }
 
 
+TEST(LasReaderTest, start)
+{
+    auto readRange = [](point_count_t start, point_count_t count)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+        ops.add("start", start);
+        ops.add("count", count);
+        LasReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        if (view->size() == 3)
+            Support::check_p100_p101_p102(*view);
+        return view->size();
+    };
+
+    EXPECT_EQ(readRange(100, 3), 3u);
+
+    // Starting near the end only yields what's left.
+    EXPECT_EQ(readRange(1060, 10), 5u);
+    EXPECT_EQ(readRange(5000, 10), 0u);
+}
+
+
+TEST(LasReaderTest, startStream)
+{
+    PointTable table;
+
+    point_count_t count = 0;
+    Options ops;
+    ops.add("filename", Support::datapath("las/simple.las"));
+    ops.add("start", 1000);
+
+    Reader::PointReadFunc cb = [&count](PointView& view, PointId id)
+    {
+        count++;
+    };
+    LasReader reader;
+    reader.setOptions(ops);
+    reader.setReadCb(cb);
+
+    reader.prepare(table);
+    reader.execute(table);
+    EXPECT_EQ(count, (point_count_t)65);
+}
+
+
 static void test_a_format(const std::string& file, uint8_t majorVersion,
     uint8_t minorVersion, int pointFormat,
     double xref, double yref, double zref, double tref,
@@ -437,6 +492,29 @@ TEST(LasReaderTest, lazperf)
        view2->getPackedPoint(dims, i, buf2.get());
        EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0);
     }
+
+    // Starting in the second chunk skips the first without decoding it.
+    Options ops3;
+    ops3.add("filename", Support::datapath("laz/autzen_trim.laz"));
+    ops3.add("compression", "lazperf");
+    ops3.add("start", 60000);
+    ops3.add("count", 10);
+
+    LasReader startReader;
+    startReader.setOptions(ops3);
+
+    PointTable t3;
+    startReader.prepare(t3);
+    pbSet = startReader.execute(t3);
+    EXPECT_EQ(pbSet.size(), 1UL);
+    PointViewPtr view3 = *pbSet.begin();
+    EXPECT_EQ(view3->size(), (point_count_t)10);
+    for (PointId i = 0; i < view3->size(); ++i)
+    {
+       view3->getPackedPoint(dims, i, buf1.get());
+       view2->getPackedPoint(dims, 60000 + i, buf2.get());
+       EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0);
+    }
 }
 #endif
 
@@ -515,6 +593,223 @@ TEST(LasReaderTest, stream)
 }
 
 
+namespace
+{
+
+// Read 'src' with a bounds query and check that just the points of
+// autzen_trim.las within the bounds come back, in order.
+void boundsTest(const std::string& src, const std::string& compression,
+    const std::string& index)
+{
+    BOX2D box(636500, 849000, 636800, 849200);
+
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader allReader;
+    allReader.setOptions(ops1);
+
+    PointTable t1;
+    allReader.prepare(t1);
+    PointViewSet viewSet = allReader.execute(t1);
+    PointViewPtr all = *viewSet.begin();
+
+    std::vector<PointId> ids;
+    for (PointId i = 0; i < all->size(); ++i)
+        if (box.contains(all->getFieldAs<double>(Dimension::Id::X, i),
+                all->getFieldAs<double>(Dimension::Id::Y, i)))
+            ids.push_back(i);
+    EXPECT_GT(ids.size(), 0u);
+    EXPECT_LT(ids.size(), all->size());
+
+    Options ops2;
+    ops2.add("filename", src);
+    ops2.add("compression", compression);
+    ops2.add("bounds", box);
+    if (index.size())
+        ops2.add("index", index);
+
+    LasReader reader;
+    reader.setOptions(ops2);
+
+    PointTable t2;
+    reader.prepare(t2);
+    viewSet = reader.execute(t2);
+    PointViewPtr view = *viewSet.begin();
+    ASSERT_EQ(view->size(), ids.size());
+    for (PointId i = 0; i < view->size(); ++i)
+    {
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::X, i),
+            all->getFieldAs<double>(Dimension::Id::X, ids[i]));
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::Y, i),
+            all->getFieldAs<double>(Dimension::Id::Y, ids[i]));
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::GpsTime, i),
+            all->getFieldAs<double>(Dimension::Id::GpsTime, ids[i]));
+    }
+
+    // Streaming gives the same points.
+    LasReader streamReader;
+    streamReader.setOptions(ops2);
+
+    size_t count = 0;
+    StreamCallbackFilter f;
+    f.setCallback([&](PointRef& point)
+    {
+        if (count < ids.size())
+        {
+            EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::GpsTime),
+                all->getFieldAs<double>(Dimension::Id::GpsTime,
+                    ids[count]));
+        }
+        count++;
+        return true;
+    });
+    f.setInput(streamReader);
+
+    FixedPointTable t3(100);
+    f.prepare(t3);
+    f.execute(t3);
+    EXPECT_EQ(count, ids.size());
+}
+
+} // unnamed namespace
+
+TEST(LasReaderTest, bounds)
+{
+    // Without an index every point is checked.
+    boundsTest(Support::datapath("las/autzen_trim.las"), "laszip", "");
+
+    Options ops;
+    ops.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader reader;
+    reader.setOptions(ops);
+
+    PointTable table;
+    reader.prepare(table);
+    PointViewSet viewSet = reader.execute(table);
+    PointViewPtr view = *viewSet.begin();
+
+    LasIndex index(reader.header().getBounds().to2d(), view->size(), 4);
+    for (PointId i = 0; i < view->size(); ++i)
+        index.add(i, view->getFieldAs<double>(Dimension::Id::X, i),
+            view->getFieldAs<double>(Dimension::Id::Y, i));
+    index.finish();
+    index.setFileSize(
+        FileUtils::fileSize(Support::datapath("las/autzen_trim.las")));
+    std::string indexFile = Support::temppath("autzen_trim.pdx");
+    index.write(indexFile);
+
+    boundsTest(Support::datapath("las/autzen_trim.las"), "laszip", indexFile);
+#ifdef PDAL_HAVE_LASZIP
+    boundsTest(Support::datapath("laz/autzen_trim.laz"), "laszip", indexFile);
+#endif
+#ifdef PDAL_HAVE_LAZPERF
+    boundsTest(Support::datapath("laz/autzen_trim.laz"), "lazperf",
+        indexFile);
+#endif
+
+    // An index made for a different version of the file is rejected.
+    index.setFileSize(index.fileSize() + 1);
+    index.write(indexFile);
+    Options staleOps(ops);
+    staleOps.add("bounds", BOX2D(636500, 849000, 636800, 849200));
+    staleOps.add("index", indexFile);
+
+    LasReader staleReader;
+    staleReader.setOptions(staleOps);
+
+    PointTable staleTable;
+    staleReader.prepare(staleTable);
+    EXPECT_THROW(staleReader.execute(staleTable), pdal_error);
+    FileUtils::deleteFile(indexFile);
+}
+
+
+// A Z range in the bounds excludes points as X and Y ranges do.
+TEST(LasReaderTest, boundsZ)
+{
+    Options ops1;
+    ops1.add("filename", Support::datapath("las/autzen_trim.las"));
+
+    LasReader allReader;
+    allReader.setOptions(ops1);
+
+    PointTable t1;
+    allReader.prepare(t1);
+    PointViewSet viewSet = allReader.execute(t1);
+    PointViewPtr all = *viewSet.begin();
+
+    BOX3D extent = allReader.header().getBounds();
+    double midz = (extent.minz + extent.maxz) / 2;
+    BOX3D box(extent.minx, extent.miny, midz,
+        extent.maxx, extent.maxy, extent.maxz);
+
+    std::vector<PointId> ids;
+    for (PointId i = 0; i < all->size(); ++i)
+        if (all->getFieldAs<double>(Dimension::Id::Z, i) >= midz)
+            ids.push_back(i);
+    EXPECT_GT(ids.size(), 0u);
+    EXPECT_LT(ids.size(), all->size());
+
+    Options ops2(ops1);
+    ops2.add("bounds", box);
+
+    LasReader reader;
+    reader.setOptions(ops2);
+
+    PointTable t2;
+    reader.prepare(t2);
+    viewSet = reader.execute(t2);
+    PointViewPtr view = *viewSet.begin();
+    ASSERT_EQ(view->size(), ids.size());
+    for (PointId i = 0; i < view->size(); ++i)
+        EXPECT_EQ(view->getFieldAs<double>(Dimension::Id::GpsTime, i),
+            all->getFieldAs<double>(Dimension::Id::GpsTime, ids[i]));
+}
+
+
+// A polygon query returns the same points as bounds of the same shape.
+TEST(LasReaderTest, polygon)
+{
+    auto readCount = [](const std::string& name, const std::string& value)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath("las/autzen_trim.las"));
+        ops.add(name, value);
+
+        LasReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet viewSet = reader.execute(table);
+        return (*viewSet.begin())->size();
+    };
+
+    point_count_t count = readCount("polygon", "POLYGON ((636500 849000, "
+        "636800 849000, 636800 849200, 636500 849200, 636500 849000))");
+    EXPECT_GT(count, 0u);
+    EXPECT_EQ(count,
+        readCount("bounds", "([636500, 636800], [849000, 849200])"));
+}
+
+
+TEST(LasReaderTest, missingIndex)
+{
+    Options ops;
+    ops.add("filename", Support::datapath("las/autzen_trim.las"));
+    ops.add("bounds", BOX2D(636500, 849000, 636800, 849200));
+    ops.add("index", Support::temppath("nonexistent.pdx"));
+
+    LasReader reader;
+    reader.setOptions(ops);
+
+    PointTable table;
+    reader.prepare(table);
+    EXPECT_THROW(reader.execute(table), pdal_error);
+}
+
 // The header of 1.2-with-color-clipped says that it has 1065 points,
 // but it really only has 1064.
 TEST(LasReaderTest, LasHeaderIncorrentPointcount)
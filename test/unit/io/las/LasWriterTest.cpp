@@ -658,6 +658,59 @@ TEST(LasWriterTest, stream)
     compareFiles(infile, outfile);
 }
 
+// Stream a file through LasReader::processBatch() and
+// LasWriter::processBatch() with a chunk size that leaves a partial last
+// batch and check that every point is written unchanged.
+TEST(LasWriterTest, streamPartial)
+{
+    std::string infile(Support::datapath("las/1.2-with-color.las"));
+    std::string outfile(Support::temppath("partial.las"));
+
+    for (point_count_t depth : { 1, 3 })
+    {
+        FileUtils::deleteFile(outfile);
+
+        Options ops1;
+        ops1.add("filename", infile);
+
+        LasReader r;
+        r.setOptions(ops1);
+
+        Options ops2;
+        ops2.add("filename", outfile);
+        ops2.add("forward", "all");
+        LasWriter w;
+        w.setOptions(ops2);
+        w.setInput(r);
+
+        FixedPointTable t(100, depth);
+        w.prepare(t);
+        EXPECT_EQ(w.execute(t), 1065u);
+
+        auto read = [](const std::string& filename, PointTableRef table)
+        {
+            LasReader r;
+            r.setOptions(Options(Option("filename", filename)));
+            r.prepare(table);
+            PointViewSet viewSet = r.execute(table);
+            EXPECT_EQ(viewSet.size(), 1u);
+            return *viewSet.begin();
+        };
+
+        PointTable t1;
+        PointViewPtr v1 = read(infile, t1);
+        PointTable t2;
+        PointViewPtr v2 = read(outfile, t2);
+        ASSERT_EQ(v1->size(), v2->size());
+        for (Dimension::Id::Enum dim : v1->dims())
+            for (PointId i = 0; i < v1->size(); ++i)
+                ASSERT_EQ(v1->getFieldAs<double>(dim, i),
+                    v2->getFieldAs<double>(dim, i)) <<
+                    Dimension::name(dim) << " " << i;
+    }
+    FileUtils::deleteFile(outfile);
+}
+
 TEST(LasWriterTest, fix1063_1064_1065)
 {
     std::string outfile = Support::temppath("out.las");
@@ -699,6 +752,196 @@ TEST(LasWriterTest, fix1063_1064_1065)
     EXPECT_EQ(ref.getWKT(), wkt);
 }
 
+// X, Y and Z stored as scaled integers are written without loss.
+TEST(LasWriterTest, scaledXyz)
+{
+    std::string infile(Support::datapath("las/1.2-with-color.las"));
+    std::string outfile(Support::temppath("scaled.las"));
+    FileUtils::deleteFile(outfile);
+
+    Options readerOps;
+    readerOps.add("filename", infile);
+    readerOps.add("scaled_xyz", true);
+
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    Options writerOps;
+    writerOps.add("filename", outfile);
+    writerOps.add("forward", "scale,offset");
+
+    LasWriter writer;
+    writer.setOptions(writerOps);
+    writer.setInput(reader);
+
+    PointTable table;
+    writer.prepare(table);
+    EXPECT_TRUE(table.layout()->dimDetail(Dimension::Id::X)->scaled());
+    EXPECT_EQ(table.layout()->dimType(Dimension::Id::X),
+        Dimension::Type::Double);
+    writer.execute(table);
+
+    auto read = [](const std::string& filename, PointTableRef table)
+    {
+        Options ops;
+        ops.add("filename", filename);
+
+        LasReader r;
+        r.setOptions(ops);
+        r.prepare(table);
+        PointViewSet viewSet = r.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return *viewSet.begin();
+    };
+
+    PointTable t1;
+    PointViewPtr v1 = read(infile, t1);
+    PointTable t2;
+    PointViewPtr v2 = read(outfile, t2);
+    ASSERT_EQ(v1->size(), v2->size());
+    for (PointId i = 0; i < v1->size(); ++i)
+    {
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::X, i),
+            v2->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Y, i),
+            v2->getFieldAs<double>(Dimension::Id::Y, i));
+        EXPECT_EQ(v1->getFieldAs<double>(Dimension::Id::Z, i),
+            v2->getFieldAs<double>(Dimension::Id::Z, i));
+    }
+}
+
+
+// Points written in curve order come back unchanged apart from their order,
+// and the chunk bounds record describes the points in each chunk.
+TEST(LasWriterTest, spatialOrder)
+{
+    std::string infile(Support::datapath("las/autzen_trim.las"));
+    std::string outfile(Support::temppath("ordered.las"));
+
+    auto read = [](const std::string& filename, PointTableRef table,
+        const Options& extra)
+    {
+        Options ops(extra);
+        ops.add("filename", filename);
+
+        LasReader r;
+        r.setOptions(ops);
+        r.prepare(table);
+        PointViewSet viewSet = r.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        return *viewSet.begin();
+    };
+
+    typedef std::tuple<int, int, int, double> Key;
+    auto keys = [](PointView& v)
+    {
+        std::vector<Key> k;
+        for (PointId i = 0; i < v.size(); ++i)
+            k.push_back(Key(
+                (int)std::round(v.getFieldAs<double>(Dimension::Id::X, i) *
+                    100),
+                (int)std::round(v.getFieldAs<double>(Dimension::Id::Y, i) *
+                    100),
+                (int)std::round(v.getFieldAs<double>(Dimension::Id::Z, i) *
+                    100),
+                v.getFieldAs<double>(Dimension::Id::GpsTime, i)));
+        std::sort(k.begin(), k.end());
+        return k;
+    };
+
+    PointTable t1;
+    PointViewPtr v1 = read(infile, t1, Options());
+    std::vector<Key> k1 = keys(*v1);
+
+    for (std::string order : { "hilbert", "morton" })
+    {
+        FileUtils::deleteFile(outfile);
+
+        Options readerOps;
+        readerOps.add("filename", infile);
+
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        Options writerOps;
+        writerOps.add("filename", outfile);
+        writerOps.add("minor_version", 4);
+        writerOps.add("forward", "scale,offset");
+        writerOps.add("spatial_order", order);
+
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable table;
+        writer.prepare(table);
+        writer.execute(table);
+
+        PointTable t2;
+        PointViewPtr v2 = read(outfile, t2, Options());
+        ASSERT_EQ(v1->size(), v2->size());
+        EXPECT_TRUE(k1 == keys(*v2));
+
+        LasReader r;
+        Options ops;
+        ops.add("filename", outfile);
+        r.setOptions(ops);
+        PointTable t3;
+        r.prepare(t3);
+        MetadataNode vlr = r.getMetadata().find(
+            [](const MetadataNode& n)
+            {
+                return n.findChild("user_id").value() == "PDAL" &&
+                    n.findChild("record_id").value<int>() == 100;
+            });
+        ASSERT_TRUE(vlr.valid());
+
+        std::vector<uint8_t> data = Utils::base64_decode(vlr.value());
+        LasChunkBounds bounds;
+        bounds.setData((const char *)data.data(), data.size());
+        ASSERT_EQ(bounds.chunks().size(), 3u);
+        EXPECT_EQ(bounds.numPoints(), v2->size());
+
+        PointId idx = 0;
+        for (const LasChunkBounds::Chunk& c : bounds.chunks())
+        {
+            BOX3D box;
+            for (point_count_t i = 0; i < c.m_count; ++i, ++idx)
+                box.grow(v2->getFieldAs<double>(Dimension::Id::X, idx),
+                    v2->getFieldAs<double>(Dimension::Id::Y, idx),
+                    v2->getFieldAs<double>(Dimension::Id::Z, idx));
+            EXPECT_NEAR(box.minx, c.m_bounds.minx, .005);
+            EXPECT_NEAR(box.miny, c.m_bounds.miny, .005);
+            EXPECT_NEAR(box.maxx, c.m_bounds.maxx, .005);
+            EXPECT_NEAR(box.maxy, c.m_bounds.maxy, .005);
+        }
+
+        // A bounds query answered through the chunk bounds matches a
+        // brute-force count.
+        BOX2D query(636500, 849000, 636800, 849200);
+        point_count_t expected = 0;
+        for (PointId i = 0; i < v2->size(); ++i)
+            if (query.contains(v2->getFieldAs<double>(Dimension::Id::X, i),
+                    v2->getFieldAs<double>(Dimension::Id::Y, i)))
+                expected++;
+        Options boundsOps;
+        boundsOps.add("bounds", query);
+        PointTable t4;
+        PointViewPtr v4 = read(outfile, t4, boundsOps);
+        EXPECT_EQ(v4->size(), expected);
+    }
+    FileUtils::deleteFile(outfile);
+
+    Options badOps;
+    badOps.add("filename", outfile);
+    badOps.add("spatial_order", "zorder");
+
+    LasWriter bad;
+    bad.setOptions(badOps);
+    PointTable t5;
+    EXPECT_THROW(bad.prepare(t5), pdal_error);
+}
+
 /**
 namespace
 {